@@ -0,0 +1,77 @@
+#include "libjsonpath/binary.hpp"
+#include "benchmark/benchmark.h"
+#include "libjsonpath/jsonpath.hpp"
+#include <string>
+#include <vector>
+
+// A corpus of distinct queries, similar in shape to a precompiled rule set.
+static std::vector<std::string> make_corpus(std::size_t size) {
+  const std::vector<std::string> templates{
+      "$.store.book[N].title",
+      "$['store']['book'][?@.price < N && @.category == 'fiction']",
+      "$..book[?@.isbn && length(@.title) > N]",
+      "$.users[?@.age >= N && @.age < 65 || @.admin == true].name",
+      "$.logs[?match(@.level, 'err.*') && @.code != N][0:N:2]",
+      "$.a.b.c[?count(@..x) > N && $.config.limit >= @.y]",
+  };
+
+  std::vector<std::string> rv{};
+  for (std::size_t i = 0; i < size; i++) {
+    auto query{templates[i % templates.size()]};
+    const auto n{std::to_string(i)};
+    for (auto pos{query.find('N')}; pos != std::string::npos;
+         pos = query.find('N', pos)) {
+      query.replace(pos, 1, n);
+    }
+    rv.push_back(query);
+  }
+  return rv;
+}
+
+static void BM_ParseCorpus(benchmark::State& state) {
+  const auto corpus{make_corpus(state.range(0))};
+  libjsonpath::Parser parser{};
+  for (auto _ : state) {
+    for (const auto& query : corpus) {
+      benchmark::DoNotOptimize(parser.parse(query));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+static void BM_LoadCorpus(benchmark::State& state) {
+  std::vector<std::string> images{};
+  for (const auto& query : make_corpus(state.range(0))) {
+    images.push_back(libjsonpath::dump(libjsonpath::parse(query)));
+  }
+
+  for (auto _ : state) {
+    for (const auto& image : images) {
+      benchmark::DoNotOptimize(libjsonpath::load(image));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * images.size());
+}
+
+static void BM_OpenImageCorpus(benchmark::State& state) {
+  std::vector<std::string> images{};
+  for (const auto& query : make_corpus(state.range(0))) {
+    images.push_back(libjsonpath::dump(libjsonpath::parse(query)));
+  }
+
+  // Validate each image and read it in place without building segments.
+  for (auto _ : state) {
+    for (const auto& image : images) {
+      libjsonpath::QueryImage view{image};
+      view.check_functions(libjsonpath::DEFAULT_FUNCTION_EXTENSIONS);
+      benchmark::DoNotOptimize(view.node(0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * images.size());
+}
+
+BENCHMARK(BM_ParseCorpus)->Arg(10000);
+BENCHMARK(BM_LoadCorpus)->Arg(10000);
+BENCHMARK(BM_OpenImageCorpus)->Arg(10000);
+
+BENCHMARK_MAIN();
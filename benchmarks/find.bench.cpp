@@ -0,0 +1,261 @@
+#include "libjsonpath/find.hpp"
+#include "benchmark/benchmark.h"
+#include "libjsonpath/index.hpp"
+#include "libjsonpath/jsonpath.hpp"
+#include "libjsonpath/summary.hpp"
+#include "libjsonpath/value.hpp"
+#include <string>
+#include <string_view>
+
+// An array of _size_ small objects, similar in shape to a page of records.
+static libjsonpath::Value make_document(std::size_t size) {
+  libjsonpath::Value::array_t records{};
+  for (std::size_t i = 0; i < size; i++) {
+    const auto n{static_cast<std::int64_t>(i)};
+    records.push_back(libjsonpath::Value::object_t{
+        {"id", n},
+        {"price", static_cast<double>(i % 100) + 0.5},
+        {"name", "item" + std::to_string(i)},
+        {"tags", libjsonpath::Value::array_t{"a", "b"}},
+    });
+  }
+  return libjsonpath::Value::object_t{{"records", std::move(records)}};
+}
+
+static void run_query(benchmark::State& state, std::string_view query,
+    const libjsonpath::EvaluatorOptions& options = {}) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse(query)};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{path, options};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_FindWildcard(benchmark::State& state) {
+  run_query(state, "$.records[*].id");
+}
+
+static void BM_FindFilter(benchmark::State& state) {
+  run_query(state, "$.records[?@.price < 10 && @.name != 'x'].id");
+}
+
+static void BM_FindDescendant(benchmark::State& state) {
+  run_query(state, "$..tags[0]");
+}
+
+// Filters evaluated by walking expression trees or by running bytecode.
+static constexpr std::string_view FILTER{
+    "$.records[?@.price >= 10 && @.price < 20 || @.id == 7 || "
+    "!(@.name != 'item42')].id"};
+
+static void BM_FilterTreeWalk(benchmark::State& state) {
+  run_query(state, FILTER, {false});
+}
+
+static void BM_FilterBytecode(benchmark::State& state) {
+  run_query(state, FILTER, {true});
+}
+
+// Every record, with and without location tracking.
+static void BM_LocationsOn(benchmark::State& state) {
+  run_query(state, "$.records[*].tags[*]", {true, true});
+}
+
+static void BM_LocationsOff(benchmark::State& state) {
+  run_query(state, "$.records[*].tags[*]", {true, false});
+}
+
+// A chain of descendant segments over _depth_ nested objects, like
+// {"a": {"a": ... {"n": 0} ..., "n": 1}, "n": 2}, that selects nothing.
+static void BM_DescendantChain(benchmark::State& state) {
+  libjsonpath::Value document{libjsonpath::Value::object_t{{"n", 0}}};
+  for (std::int64_t i = 1; i < state.range(0); i++) {
+    document = libjsonpath::Value::object_t{{"a", document}, {"n", i}};
+  }
+
+  const auto path{libjsonpath::parse("$..a..b")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{path};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+// Descendant name queries, walking the document or using a KeyIndex, without
+// locations. Ranges are numbers of records, roughly 8 MB and 80 MB of JSON.
+static void BM_KeyIndexBuild(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  std::size_t memory{0};
+  for (auto _ : state) {
+    libjsonpath::KeyIndex<libjsonpath::ValueAdapter> index{&document};
+    memory = index.memory_usage();
+    benchmark::DoNotOptimize(memory);
+  }
+  state.counters["json_bytes"] =
+      static_cast<double>(libjsonpath::to_json(document).size());
+  state.counters["index_bytes"] = static_cast<double>(memory);
+}
+
+static void BM_DescendantNameWalk(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse("$..price")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document));
+  }
+}
+
+static void BM_DescendantNameIndexed(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const libjsonpath::KeyIndex<libjsonpath::ValueAdapter> index{&document};
+  const auto path{libjsonpath::parse("$..price")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(index));
+  }
+}
+
+// A filter on a rare member name, walking every subtree or skipping those
+// whose SubtreeSummary rules the name out. Documents have 100 sections of
+// _range_ records, with "error_code" in one record of one section.
+static libjsonpath::Value make_sections(std::size_t size) {
+  libjsonpath::Value::array_t sections{};
+  for (std::size_t i = 0; i < 100; i++) {
+    libjsonpath::Value::array_t records{};
+    for (std::size_t j = 0; j < size; j++) {
+      libjsonpath::Value::object_t record{
+          {"id", static_cast<std::int64_t>(j)},
+          {"tags", libjsonpath::Value::array_t{"a", "b"}},
+      };
+      if (i == 42 && j == size / 2) {
+        record.emplace_back("error_code", 1);
+      }
+      records.push_back(std::move(record));
+    }
+    sections.push_back(
+        libjsonpath::Value::object_t{{"records", std::move(records)}});
+  }
+  return libjsonpath::Value::object_t{{"sections", std::move(sections)}};
+}
+
+static void BM_SummaryWalk(benchmark::State& state) {
+  const auto document{make_sections(state.range(0))};
+  const auto path{libjsonpath::parse("$..[?@.error_code]")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document));
+  }
+}
+
+static void BM_SummaryPruned(benchmark::State& state) {
+  const auto document{make_sections(state.range(0))};
+  libjsonpath::SubtreeSummary<libjsonpath::ValueAdapter> summary{&document};
+  const auto path{libjsonpath::parse("$..[?@.error_code]")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  evaluator.find(summary);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(summary));
+  }
+  state.counters["summaries"] = static_cast<double>(summary.size());
+}
+
+// Selecting 50 names from each of _range_ objects of 300 members.
+static void BM_WideSegment(benchmark::State& state) {
+  libjsonpath::Value::array_t records{};
+  for (std::int64_t i = 0; i < state.range(0); i++) {
+    libjsonpath::Value::object_t record{};
+    for (std::int64_t j = 0; j < 300; j++) {
+      record.emplace_back("field" + std::to_string(j), j);
+    }
+    records.push_back(std::move(record));
+  }
+  const libjsonpath::Value document{std::move(records)};
+
+  std::string query{"$[*]["};
+  for (int j = 0; j < 50; j++) {
+    query += (j ? ", 'field" : "'field") + std::to_string(j * 7 % 300) + "'";
+  }
+  query += "]";
+
+  const auto path{libjsonpath::parse(query)};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document));
+  }
+}
+
+// Counting a query's nodes, by collecting them or as they're found, in a
+// filter and for the whole query.
+static void BM_FilterCount(benchmark::State& state) {
+  run_query(state, "$.records[?count(@..*) > 5]");
+}
+
+static void BM_CountFind(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse("$..*")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{
+      path, {true, false}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document).size());
+  }
+}
+
+static void BM_Count(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse("$..*")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{path};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.count(&document));
+  }
+}
+
+// Only the first match, with eager and lazy evaluation.
+static void BM_FirstEager(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse("$.records[?@.price > 50].id")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{path};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.find(&document).front());
+  }
+}
+
+static void BM_FirstLazy(benchmark::State& state) {
+  const auto document{make_document(state.range(0))};
+  const auto path{libjsonpath::parse("$.records[?@.price > 50].id")};
+  libjsonpath::Evaluator<libjsonpath::ValueAdapter> evaluator{path};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(evaluator.first(&document));
+  }
+}
+
+BENCHMARK(BM_FindWildcard)->Range(1000, 100000);
+BENCHMARK(BM_FindFilter)->Range(1000, 100000);
+BENCHMARK(BM_FindDescendant)->Range(1000, 100000);
+BENCHMARK(BM_FilterTreeWalk)->Arg(1000000);
+BENCHMARK(BM_FilterBytecode)->Arg(1000000);
+BENCHMARK(BM_DescendantChain)
+    ->RangeMultiplier(4)
+    ->Range(64, 4096)
+    ->Complexity();
+BENCHMARK(BM_KeyIndexBuild)->Arg(125000)->Arg(1250000);
+BENCHMARK(BM_DescendantNameWalk)->Arg(125000)->Arg(1250000);
+BENCHMARK(BM_DescendantNameIndexed)->Arg(125000)->Arg(1250000);
+BENCHMARK(BM_SummaryWalk)->Arg(1000);
+BENCHMARK(BM_SummaryPruned)->Arg(1000);
+BENCHMARK(BM_LocationsOn)->Arg(100000);
+BENCHMARK(BM_LocationsOff)->Arg(100000);
+BENCHMARK(BM_WideSegment)->Arg(1000);
+BENCHMARK(BM_FilterCount)->Arg(100000);
+BENCHMARK(BM_CountFind)->Arg(100000);
+BENCHMARK(BM_Count)->Arg(100000);
+BENCHMARK(BM_FirstEager)->Arg(100000);
+BENCHMARK(BM_FirstLazy)->Arg(100000);
+
+BENCHMARK_MAIN();
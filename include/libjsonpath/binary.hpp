@@ -0,0 +1,162 @@
+#ifndef LIBJSONPATH_BINARY_H
+#define LIBJSONPATH_BINARY_H
+
+#include "libjsonpath/parse.hpp"     // function_signature_map
+#include "libjsonpath/selectors.hpp" // segments_t
+#include <cstddef>                   // std::size_t
+#include <cstdint> // std::uint8_t std::uint16_t std::uint32_t std::uint64_t
+#include <string>  // std::string
+#include <string_view> // std::string_view
+
+namespace libjsonpath {
+
+// The version of the binary query format written by _dump()_. Images with a
+// different version are rejected by _load()_.
+inline constexpr std::uint16_t BINARY_FORMAT_VERSION{1};
+
+// The deepest nesting of node records accepted by _QueryImage_, so that
+// decoding a crafted image can't overflow the call stack. Queries nested
+// deeper than this can be dumped but not loaded.
+inline constexpr std::uint32_t MAX_BINARY_DEPTH{256};
+
+// A binary encoded query is a flat, position independent image made up of a
+// fixed size header, an array of fixed size node records, a function table
+// and a string pool. All integers are little endian and all references
+// between nodes are record indices rather than pointers, so an image can be
+// memory mapped and read in place.
+//
+// Header (32 bytes)
+//
+//   0  magic "JPQB"          16 u32 function count
+//   4  u16 format version    20 u32 function table offset
+//   6  u16 reserved          24 u32 string pool offset
+//   8  u32 node count        28 u32 string pool size
+//  12  u32 node array offset
+//
+// Node record (16 bytes)
+//
+//   0  u8 kind   1  u8 op   2  u16 function slot   4  u32 a   8  u64 b
+//
+// Nodes with children store the index of their first child in _a_ and the
+// number of children in _b_, with children stored contiguously. Record 0 is
+// the root query, and a node's children start at the next record not yet
+// claimed by a depth first walk from the root, so every other record has
+// exactly one parent and a valid image can't contain cycles or shared
+// subtrees. Strings are stored as an offset into the string pool in
+// _a_ and a length in _b_.
+//
+// Function table entry (16 bytes)
+//
+//   0  u32 name offset   4  u32 name length   8  u32 argument types offset
+//  12  u16 argument count   14  u8 result type   15  u8 reserved
+//
+// Function call nodes refer to a function table entry by slot number, and
+// each entry records the signature that the query was type checked against.
+
+// The kind of node held in a binary node record.
+enum class BinaryNodeKind : std::uint8_t {
+  query = 1,
+  segment,
+  recursive_segment,
+  name_selector,
+  index_selector,
+  wild_selector,
+  slice_selector,
+  filter_selector,
+  null_literal,
+  boolean_literal,
+  integer_literal,
+  float_literal,
+  string_literal,
+  logical_not,
+  infix,
+  relative_query,
+  root_query,
+  function_call,
+  absent,
+};
+
+// A decoded node record.
+struct BinaryNode {
+  BinaryNodeKind kind{};
+  std::uint8_t op{};
+  std::uint16_t slot{};
+  std::uint32_t a{};
+  std::uint64_t b{};
+};
+
+// A decoded function table entry.
+struct BinaryFunction {
+  std::string_view name{};
+  FunctionExtensionTypes types{};
+};
+
+// Return a binary encoding of _path_. Function calls are recorded along with
+// their signature from _function_extensions_, which should be the function
+// extensions the query was parsed with.
+std::string dump(const segments_t& path);
+std::string dump(
+    const segments_t& path, const function_signature_map& function_extensions);
+
+// A read-only view of a binary encoded query. The constructor checks the
+// header and every record for out of range offsets, and the tree for nesting
+// deeper than MAX_BINARY_DEPTH, throwing a FormatError if any are found,
+// after which nodes and strings can be read in place.
+//
+// A QueryImage does not own its data. The underlying bytes must outlive the
+// image and any segments loaded from it.
+class QueryImage {
+public:
+  QueryImage(std::string_view data);
+
+  std::uint32_t node_count() const noexcept { return m_node_count; };
+  std::uint32_t function_count() const noexcept { return m_function_count; };
+
+  // Return the node record at _index_, which must be less than
+  // _node_count()_.
+  BinaryNode node(std::uint32_t index) const noexcept;
+
+  // Return the string referenced by a name selector or string literal node.
+  std::string_view string(const BinaryNode& node) const noexcept;
+
+  // Return the function table entry at _slot_. Throw a FormatError if _slot_
+  // is not less than _function_count()_.
+  BinaryFunction function(std::uint16_t slot) const;
+
+  // Throw a NameError if any function in the function table is missing from
+  // _function_extensions_, or a TypeError if its signature has changed.
+  void check_functions(const function_signature_map& function_extensions) const;
+
+  // Build a sequence of segments from the image. Function names are views
+  // into the image's string pool.
+  segments_t segments() const;
+
+private:
+  std::string_view m_data{};
+  std::uint32_t m_node_count{};
+  std::uint32_t m_nodes_offset{};
+  std::uint32_t m_function_count{};
+  std::uint32_t m_functions_offset{};
+  std::uint32_t m_strings_offset{};
+  std::uint32_t m_strings_size{};
+
+  // Throw a FormatError if the node at _index_ refers to anything outside
+  // the image, or if its children don't start at record _next_.
+  void check_node(std::uint32_t index, std::uint32_t next) const;
+
+  // Return true if nodes of kind _kind_ store a range of child records.
+  static bool has_children(BinaryNodeKind kind) noexcept;
+};
+
+// Return a sequence of segments decoded from the binary query _data_, after
+// checking its functions against _function_extensions_. No lexing or parsing
+// is done, but the decoded segments get the same well-typedness checks as
+// parsed ones, with _Parser::check()_. As with _parse()_, _data_ must outlive
+// the returned segments.
+segments_t load(std::string_view data);
+segments_t load(
+    std::string_view data, const function_signature_map& function_extensions);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_BINARY_H
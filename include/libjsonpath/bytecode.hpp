@@ -0,0 +1,80 @@
+#ifndef LIBJSONPATH_BYTECODE_H
+#define LIBJSONPATH_BYTECODE_H
+
+#include "libjsonpath/document.hpp"  // ValueKind
+#include "libjsonpath/pointer.hpp"   // SingularPath
+#include "libjsonpath/selectors.hpp" // expression_t BinaryOperator
+#include <cstddef>                   // std::size_t
+#include <cstdint>                   // std::int64_t std::uint8_t std::uint32_t
+#include <string>                    // std::string
+#include <string_view>               // std::string_view
+#include <vector>                    // std::vector
+
+namespace libjsonpath {
+
+// Instructions for the filter expression interpreter. Logical results go in
+// a single boolean accumulator, and comparison operands are loaded into
+// registers, already reduced to a scalar, an array or object node, or
+// Nothing.
+enum class Opcode : std::uint8_t {
+  set,             // accumulator = a != 0
+  load_constant,   // r[a] = constants[b]
+  load_singular,   // r[a] = paths[b] applied to the current node
+  load_value,      // r[a] = the value of operands[b]
+  compare,         // accumulator = r[a] op r[b]
+  compare_number,  // accumulator = r[a] op constants[b], a number
+  compare_string,  // accumulator = r[a] op constants[b], a string
+  exists_singular, // accumulator = paths[b] exists from the current node
+  test,            // accumulator = the logical value of operands[b]
+  not_,            // accumulator = !accumulator
+  jump_if_false,   // if !accumulator, continue from instruction b
+  jump_if_true,    // if accumulator, continue from instruction b
+};
+
+struct Instruction {
+  Opcode opcode{Opcode::set};
+  BinaryOperator op{BinaryOperator::none};
+  std::uint32_t a{0};
+  std::uint32_t b{0};
+};
+
+// A literal, converted ahead of time to the form comparisons use. Integer
+// literals carry their value as a double too, for comparison with floats.
+struct Constant {
+  ValueKind kind{ValueKind::null_};
+  bool boolean{false};
+  std::int64_t integer{0};
+  double number{0};
+  std::string_view string{};
+};
+
+// A filter expression compiled to a linear sequence of instructions.
+//
+// Singular relative queries are resolved with a SingularPath and literals
+// are constants. Everything else, like root queries, function calls and
+// non-singular queries, is left to the evaluator as an operand, so its
+// existing caching of invariant and common subexpressions still applies.
+// Invariant comparisons and logical subexpressions are operands for the
+// same reason.
+//
+// Constants, operands and paths refer to the expression a program was
+// compiled from, which must outlive the program.
+struct Program {
+  std::vector<Instruction> code{};
+  std::vector<Constant> constants{};
+  std::vector<SingularPath> paths{};
+  std::vector<const expression_t*> operands{};
+
+  // The number of registers needed to run this program.
+  std::size_t registers{0};
+};
+
+// Compile the logical filter expression _expression_.
+Program compile_filter(const expression_t& expression);
+
+// Return a human readable listing of _program_, one instruction per line.
+std::string to_string(const Program& program);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_BYTECODE_H
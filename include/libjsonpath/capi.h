@@ -0,0 +1,121 @@
+#ifndef LIBJSONPATH_CAPI_H
+#define LIBJSONPATH_CAPI_H
+
+/*
+ * A stable C interface to libjsonpath, for use from other languages.
+ *
+ * Parsed queries are passed around as opaque jsonpath_query handles, which
+ * own a copy of their query string. No function in this interface throws.
+ * Every fallible function returns a jsonpath_status, and functions that parse
+ * queries optionally fill in a jsonpath_error with a message and the index
+ * into the query at which the error occurred.
+ *
+ * Batch variants handle many queries per call, so the cost of crossing a
+ * foreign function interface is paid once per batch rather than once per
+ * query.
+ */
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct jsonpath_query jsonpath_query;
+
+typedef enum jsonpath_status {
+  JSONPATH_OK = 0,
+  JSONPATH_SYNTAX_ERROR = 1,
+  JSONPATH_TYPE_ERROR = 2,
+  JSONPATH_NAME_ERROR = 3,
+  JSONPATH_INDEX_ERROR = 4,
+  JSONPATH_ENCODING_ERROR = 5,
+  JSONPATH_FORMAT_ERROR = 6,
+  JSONPATH_BUFFER_TOO_SMALL = 7,
+  JSONPATH_INVALID_ARGUMENT = 8,
+  JSONPATH_OUT_OF_MEMORY = 9,
+  JSONPATH_UNKNOWN_ERROR = 10
+} jsonpath_status;
+
+#define JSONPATH_ERROR_MESSAGE_SIZE 256
+
+typedef struct jsonpath_error {
+  jsonpath_status status;
+  /* Index into the query string where the error occurred. */
+  size_t index;
+  /* A null terminated, possibly truncated, error message. */
+  char message[JSONPATH_ERROR_MESSAGE_SIZE];
+} jsonpath_error;
+
+/* Return the libjsonpath version as a null terminated string. */
+const char* jsonpath_version(void);
+
+/* Return a static, null terminated description of _status_. */
+const char* jsonpath_status_string(jsonpath_status status);
+
+/*
+ * Parse _length_ bytes of _query_ and store a new handle in _out_. On failure
+ * _out_ is set to NULL and, if _error_ is not NULL, it is filled in with
+ * details of the failure. Handles must be released with jsonpath_free().
+ */
+jsonpath_status jsonpath_parse(const char* query, size_t length,
+    jsonpath_query** out, jsonpath_error* error);
+
+/*
+ * Parse _count_ queries, storing a handle or NULL in each of _out[0..count)_.
+ * If _statuses_ is not NULL, the status of each query is stored in it.
+ * Returns JSONPATH_OK if every query was parsed, otherwise the status of the
+ * first query that failed. Queries after a failure are still parsed.
+ */
+jsonpath_status jsonpath_parse_batch(const char* const* queries,
+    const size_t* lengths, size_t count, jsonpath_query** out,
+    jsonpath_status* statuses);
+
+/* Load a handle from a binary query image written by jsonpath_dump(). */
+jsonpath_status jsonpath_load(const char* data, size_t length,
+    jsonpath_query** out, jsonpath_error* error);
+
+/* Release a handle. Passing NULL is a no-op. */
+void jsonpath_free(jsonpath_query* query);
+
+/* Release _count_ handles, any of which may be NULL. */
+void jsonpath_free_batch(jsonpath_query** queries, size_t count);
+
+/*
+ * Write the canonical string representation of _query_ to _buffer_, writing
+ * at most _size_ bytes and no null terminator, and store its full length in
+ * _length_. Returns JSONPATH_BUFFER_TOO_SMALL if the output was truncated.
+ */
+jsonpath_status jsonpath_to_string(const jsonpath_query* query, char* buffer,
+    size_t size, size_t* length);
+
+/*
+ * Write the canonical string representations of _count_ queries back to back
+ * in _buffer_. _offsets_ must have room for _count + 1_ entries. The string
+ * for query _i_ occupies _buffer[offsets[i]..offsets[i + 1])_ and the total
+ * length is _offsets[count]_, which is filled in even when this function
+ * returns JSONPATH_BUFFER_TOO_SMALL, so callers can retry with a buffer of
+ * the right size.
+ */
+jsonpath_status jsonpath_to_string_batch(const jsonpath_query* const* queries,
+    size_t count, char* buffer, size_t size, size_t* offsets);
+
+/*
+ * Write a binary image of _query_ to _buffer_, like jsonpath_to_string().
+ * Images can be loaded in another process with jsonpath_load().
+ */
+jsonpath_status jsonpath_dump(const jsonpath_query* query, char* buffer,
+    size_t size, size_t* length);
+
+/* Return a stable 64-bit structural hash of _query_. */
+uint64_t jsonpath_hash(const jsonpath_query* query);
+
+/* Return non-zero if _a_ and _b_ are structurally equal. */
+int jsonpath_equal(const jsonpath_query* a, const jsonpath_query* b);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* LIBJSONPATH_CAPI_H */
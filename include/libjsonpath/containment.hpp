@@ -0,0 +1,56 @@
+#ifndef LIBJSONPATH_CONTAINMENT_H
+#define LIBJSONPATH_CONTAINMENT_H
+
+#include "libjsonpath/pointer.hpp"   // path_step_t
+#include "libjsonpath/selectors.hpp" // segments_t
+#include <cstddef>                   // std::size_t
+#include <optional>                  // std::optional
+#include <vector>                    // std::vector
+
+namespace libjsonpath {
+
+// A restriction on the location of a node. The step of the node's normalized
+// path that was added by segment _segment_ must be selected by one of
+// _selectors_, each of which is a name selector, a non-negative index
+// selector or a slice selector with a positive step and non-negative bounds.
+struct LocationRestriction {
+  std::size_t segment{0};
+  std::vector<selector_t> selectors{};
+};
+
+// What's left to do to get a narrower query's results from those of a
+// broader query. A node from the broader query's results is in the narrower
+// query's results if its location passes every restriction and the node
+// itself satisfies _filter_, with `@` being the node. With no restrictions
+// and no filter, the two queries select the same nodes.
+//
+// Location restrictions only need a node's normalized path. Only a filter
+// needs the node's value, and only a filter with a root query needs the
+// document.
+struct Residual {
+  std::vector<LocationRestriction> restrictions{};
+  std::optional<expression_t> filter{};
+
+  // Return true if there's nothing left to do.
+  bool empty() const noexcept { return restrictions.empty() && !filter; }
+
+  // Return true if _location_, the steps of a node's normalized path, passes
+  // every location restriction.
+  bool matches_location(const std::vector<path_step_t>& location) const;
+};
+
+// Decide whether every node selected by _a_ is also selected by _b_, for any
+// document, returning the residual to apply to _b_'s results to get _a_'s
+// results if it is. For example, `$.a.b[0]` is contained in `$.a.b[*]` with
+// a location restriction, and `$.a[?@.x > 5 && @.y]` is contained in
+// `$.a[?@.x > 5]` with the residual filter `@.y`.
+//
+// The procedure is sound but incomplete. When containment can't be shown
+// with a residual that can be applied to _b_'s results alone, nothing is
+// returned. Containment is of sets of nodes: the number of times a node
+// appears in each nodelist is not considered.
+std::optional<Residual> contained_in(const segments_t& a, const segments_t& b);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_CONTAINMENT_H
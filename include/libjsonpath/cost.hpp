@@ -0,0 +1,81 @@
+#ifndef LIBJSONPATH_COST_H
+#define LIBJSONPATH_COST_H
+
+#include "libjsonpath/selectors.hpp"
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+#include <limits>  // std::numeric_limits
+#include <vector>  // std::vector
+
+namespace libjsonpath {
+
+// The largest cost. Cost arithmetic saturates here rather than wrapping.
+inline constexpr std::uint64_t MAX_COST{
+    std::numeric_limits<std::uint64_t>::max()};
+
+// Return _a_ + _b_, saturating at MAX_COST.
+inline std::uint64_t add_cost(std::uint64_t a, std::uint64_t b) {
+  return a > MAX_COST - b ? MAX_COST : a + b;
+}
+
+// Return _a_ * _b_, saturating at MAX_COST.
+inline std::uint64_t mul_cost(std::uint64_t a, std::uint64_t b) {
+  return a != 0 && b > MAX_COST / a ? MAX_COST : a * b;
+}
+
+// The worst case complexity class of a query, from its dominant cost term.
+enum class ComplexityClass {
+  constant,     // O(1), like singular queries
+  linear,       // O(N)
+  linear_depth, // O(N * D^k), from descendant segments
+  polynomial,   // O(N^k * D^j) for k > 1, from nested filter queries
+};
+
+// One term of a cost bound, _coefficient * N^nodes_exponent *
+// D^depth_exponent_, where N is the number of nodes in a document and D is
+// its maximum depth.
+struct CostTerm {
+  std::uint64_t coefficient{0};
+  unsigned nodes_exponent{0};
+  unsigned depth_exponent{0};
+};
+
+// A static estimate of the worst case cost of evaluating a query, counted
+// in node visits and filter expression evaluations.
+//
+// The estimate assumes root queries in filters are evaluated once per
+// evaluation, as _find_invariants()_ allows, and does not include the cost
+// of matching regular expressions, which depends on string lengths rather
+// than document shape. _regex_functions_ counts calls to `match()` and
+// `search()` instead.
+struct CostEstimate {
+  // The terms of the bound, with exponents in descending order.
+  std::vector<CostTerm> terms{};
+
+  ComplexityClass complexity{ComplexityClass::constant};
+
+  // The exponents of the dominant term.
+  unsigned nodes_exponent{0};
+  unsigned depth_exponent{0};
+
+  bool singular{true};
+  std::size_t descendant_segments{0};
+
+  // The deepest nesting of filter selectors, zero if there are none.
+  std::size_t filter_depth{0};
+
+  std::size_t regex_functions{0};
+
+  // Return the bound for a document with _nodes_ nodes and a maximum depth
+  // of _depth_, saturating at the largest std::uint64_t.
+  std::uint64_t bound(std::uint64_t nodes, std::uint64_t depth) const;
+};
+
+// Estimate the worst case cost of evaluating _path_ from its structure
+// alone, so expensive queries like `$..*..*[?@..x]` can be rejected or
+// queued before they run.
+CostEstimate estimate_cost(const segments_t& path);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_COST_H
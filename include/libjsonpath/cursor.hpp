@@ -0,0 +1,66 @@
+#ifndef LIBJSONPATH_CURSOR_H
+#define LIBJSONPATH_CURSOR_H
+
+#include "libjsonpath/pointer.hpp" // path_step_t
+#include <cstdint>                 // std::int64_t std::uint8_t std::uint64_t
+#include <string>                  // std::string
+#include <string_view>             // std::string_view
+#include <vector>                  // std::vector
+
+namespace libjsonpath {
+
+// The version of the token format written by _Cursor::to_token()_. Tokens
+// with a different version are rejected by _Cursor::from_token()_.
+inline constexpr std::uint8_t CURSOR_FORMAT_VERSION{1};
+
+// Progress made applying one segment of a query to one node. See
+// Evaluator::Range.
+struct CursorEntry {
+  std::uint64_t segment{0};
+  std::uint64_t selector{0};
+  bool started{false};
+
+  // The next array index or object member ordinal to visit, or the next
+  // index of a slice.
+  std::int64_t index{0};
+};
+
+// The traversal position of a lazily evaluated query, from
+// _Evaluator::Range::cursor()_. Resuming from a cursor with
+// _Evaluator::resume()_ continues with the node after the last one returned,
+// without revisiting any nodes before it, so page N of a large result set
+// costs about the same as page 1.
+//
+// A cursor records the stack of pending segments, selectors and array
+// indices, along with the location of each pending node, but nothing about
+// node values. It is only meaningful for the query it came from, which is
+// checked, and for an unchanged document, which is not. Each location step
+// is also checked against the selector it was recorded for, so a forged
+// cursor can't resume at a node the query doesn't select.
+struct Cursor {
+  // _hash()_ of the query.
+  std::uint64_t query_hash{0};
+
+  // True if evaluation has finished.
+  bool done{false};
+
+  // True if the last entry is the node last returned.
+  bool returned{false};
+
+  std::vector<CursorEntry> entries{};
+
+  // The location of each entry after the first, relative to its parent.
+  std::vector<path_step_t> location{};
+
+  // Return a compact, URL safe text representation of this cursor.
+  std::string to_token() const;
+
+  // Return the cursor represented by _token_. Throws a CursorError if
+  // _token_ is malformed or was written by a different version of
+  // libjsonpath.
+  static Cursor from_token(std::string_view token);
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_CURSOR_H
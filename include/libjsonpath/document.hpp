@@ -0,0 +1,83 @@
+#ifndef LIBJSONPATH_DOCUMENT_H
+#define LIBJSONPATH_DOCUMENT_H
+
+#include <functional>  // std::hash
+#include <type_traits> // std::void_t
+#include <utility>     // std::declval
+
+namespace libjsonpath {
+
+// The kind of JSON value held by a document node.
+enum class ValueKind {
+  null_,
+  boolean,
+  integer,
+  float_,
+  string,
+  array,
+  object,
+};
+
+// libjsonpath does not depend on any particular JSON library. Instead,
+// functions that read JSON documents are templated on a _document adapter_,
+// a traits type with static member functions describing how to inspect a
+// node of some JSON DOM. Adapters are resolved at compile time, so there's
+// no virtual dispatch. An adapter for a DOM whose nodes are `Value`s might
+// look like this. See libjsonpath/value.hpp for a complete example.
+//
+//   struct ValueAdapter {
+//     // A cheap to copy handle to a node in a document.
+//     using node_type = const Value*;
+//
+//     // A forward iterator over the members of an object.
+//     using member_iterator = ...;
+//
+//     // Return the kind of value held by _node_.
+//     static ValueKind kind(node_type node);
+//
+//     // Return the number of elements in the array _node_, or the number of
+//     // members in the object _node_.
+//     static std::size_t size(node_type node);
+//
+//     // Return the element at _index_ in the array _node_. _index_ is always
+//     // less than _size(node)_.
+//     static node_type element(node_type node, std::size_t index);
+//
+//     // Return the member called _name_ in the object _node_, or an empty
+//     // optional if there is no such member.
+//     static std::optional<node_type> member(
+//         node_type node, std::string_view name);
+//
+//     // Iterate the members of the object _node_, in the order they should
+//     // appear in query results.
+//     static member_iterator members_begin(node_type node);
+//     static member_iterator members_end(node_type node);
+//     static std::string_view member_name(const member_iterator& it);
+//     static node_type member_value(const member_iterator& it);
+//
+//     // Return the scalar value of _node_. Each is only called for nodes of
+//     // the matching kind.
+//     static bool boolean_value(node_type node);
+//     static std::int64_t integer_value(node_type node);
+//     static double float_value(node_type node);
+//     static std::string_view string_value(node_type node);
+//   };
+//
+// _SingularPath::find()_ only needs _kind_, _size_, _element_ and _member_.
+// The query evaluator in libjsonpath/find.hpp needs all of them.
+//
+// Some optimizations remember things about nodes, keyed by their handles.
+// They are only available if handles are hashable with std::hash, and equal
+// handles refer to the same node, as with pointers.
+
+// True if handles of type _T_ can be used as keys of a std::unordered_map.
+template <typename T, typename = void>
+inline constexpr bool is_hashable_v{false};
+
+template <typename T>
+inline constexpr bool is_hashable_v<T,
+    std::void_t<decltype(std::hash<T>{}(std::declval<const T&>()))>>{true};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_DOCUMENT_H
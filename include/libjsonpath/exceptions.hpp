@@ -23,6 +23,10 @@ public:
   Exception(std::string_view message, const Token& token)
       : m_message{format_exception(message, token)}, m_token{token} {};
 
+  // An exception that is not associated with a query string, like those
+  // thrown when loading a binary encoded query.
+  Exception(std::string_view message) : m_message{message} {};
+
   const char* what() const noexcept override { return m_message.c_str(); };
   const Token& token() const noexcept { return m_token; };
 
@@ -60,6 +64,7 @@ class TypeError : public Exception {
 public:
   TypeError(std::string_view message, const Token& token)
       : Exception{message, token} {};
+  TypeError(std::string_view message) : Exception{message} {};
 };
 
 // An exception thrown due to an out of range array index.
@@ -67,6 +72,7 @@ class IndexError : public Exception {
 public:
   IndexError(std::string_view message, const Token& token)
       : Exception{message, token} {};
+  IndexError(std::string_view message) : Exception{message} {};
 };
 
 // An exception thrown due to a call to an unknown function extension.
@@ -74,6 +80,7 @@ class NameError : public Exception {
 public:
   NameError(std::string_view message, const Token& token)
       : Exception{message, token} {};
+  NameError(std::string_view message) : Exception{message} {};
 };
 
 // An exception thrown due to bad query encoding. The query is probably
@@ -84,7 +91,24 @@ public:
       : Exception{message, token} {};
 };
 
-//
+// An exception thrown due to a malformed or incompatible binary encoded query.
+class FormatError : public Exception {
+public:
+  FormatError(std::string_view message) : Exception{message} {};
+};
+
+// An exception thrown due to a malformed cursor token, or a cursor that
+// doesn't belong to the query or document it's used with.
+class CursorError : public Exception {
+public:
+  CursorError(std::string_view message) : Exception{message} {};
+};
+
+// An exception thrown due to malformed JSON text.
+class JSONError : public Exception {
+public:
+  JSONError(std::string_view message) : Exception{message} {};
+};
 
 } // namespace libjsonpath
 
@@ -0,0 +1,1997 @@
+#ifndef LIBJSONPATH_FIND_H
+#define LIBJSONPATH_FIND_H
+
+#include "libjsonpath/bytecode.hpp"   // compile_filter Program
+#include "libjsonpath/cursor.hpp"     // Cursor CursorEntry
+#include "libjsonpath/document.hpp"   // ValueKind is_hashable_v
+#include "libjsonpath/exceptions.hpp" // NameError CursorError
+#include "libjsonpath/hash.hpp"       // libjsonpath::hash
+#include "libjsonpath/index.hpp"      // KeyIndex
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include "libjsonpath/location.hpp"   // Location LocationBuilder
+#include "libjsonpath/optimize.hpp"   // find_invariants required_names
+#include "libjsonpath/pointer.hpp"    // path_step_t
+#include "libjsonpath/selectors.hpp"  // segments_t
+#include "libjsonpath/summary.hpp"    // SubtreeSummary
+#include <algorithm>                  // std::min std::max
+#include <cstddef>                    // std::size_t std::ptrdiff_t
+#include <cstdint>                    // std::int64_t std::uint64_t
+#include <functional>                 // std::function
+#include <iterator>                   // std::input_iterator_tag
+#include <memory>                     // std::unique_ptr std::shared_ptr
+#include <optional>                   // std::optional
+#include <regex>                      // std::wregex
+#include <string>                     // std::string
+#include <string_view>                // std::string_view
+#include <type_traits>                // std::is_same_v std::decay_t
+#include <unordered_map>              // std::unordered_map
+#include <utility>                    // std::move std::pair std::make_pair
+#include <variant>                    // std::variant std::get_if std::visit
+#include <vector>                     // std::vector
+
+namespace libjsonpath {
+
+// A node selected by a query, with its location in the document. Locations
+// are rendered on demand, and are empty if location tracking is turned off.
+template <typename Adapter> struct Node {
+  typename Adapter::node_type value;
+  Location location{};
+
+  // Return the normalized path of this node, like `$['a'][0]`.
+  std::string path() const { return location.path(); }
+};
+
+template <typename Adapter> using nodelist_t = std::vector<Node<Adapter>>;
+
+// Options controlling an Evaluator.
+struct EvaluatorOptions {
+  // Compile filter expressions with _compile_filter()_ and run them on a
+  // bytecode interpreter. Turn this off to walk expression trees instead.
+  bool bytecode{true};
+
+  // Record the location of each selected node. Turn this off if only node
+  // values are needed. Locations are never recorded if libjsonpath was built
+  // without them, see TRACK_LOCATIONS.
+  bool locations{true};
+};
+
+// Compiled I-Regexp patterns for the `match()` and `search()` function
+// extensions, cached by pattern. Patterns that are not valid, or use syntax
+// std::regex doesn't support, never match.
+class RegexCache {
+public:
+  // Return true if _pattern_ matches all of _value_, or part of _value_ if
+  // _full_ is false.
+  bool matches(std::string_view pattern, std::string_view value, bool full);
+
+private:
+  std::unordered_map<std::string, std::unique_ptr<std::wregex>> m_cache{};
+};
+
+// Return the number of Unicode scalar values in the UTF-8 string _value_.
+std::size_t utf8_length(std::string_view value) noexcept;
+
+// Evaluates a parsed query against a document. See libjsonpath/document.hpp
+// for a description of document adapters.
+//
+// Segments are applied depth first, so no intermediate nodelists are built,
+// and existence tests stop at the first match. Query arguments to `count()`
+// are counted rather than collected, and those to `length()` and `value()`
+// stop at the second node. Subexpressions found by _find_invariants()_ are
+// evaluated at most once per evaluation, and those found by
+// _find_common_subexpressions()_ at most once per candidate node.
+//
+// _path_ must outlive the evaluator, and is expected to come from a parser
+// that checked the well-typedness of function calls. The standard function
+// extensions are built in, and others can be added with _add_function()_.
+// Calling any other function throws a NameError.
+//
+// Segments of many name selectors, like `$['a', 'b', 'c', ...]`, select from
+// each object with one pass over its members, then follow them in selector
+// order, rather than looking up each name in turn.
+//
+// Unless disabled by _options_, each filter expression is compiled to
+// bytecode the first time it's used, and run by a loop over a register file
+// that's reused for every candidate node.
+//
+// A chain of descendant segments, like `$..a..b`, applies later segments to
+// nested subtrees over and over. If document adapter handles are hashable,
+// the evaluator remembers which nodes can't lead to any results for each
+// descendant segment after the first, and skips them, so the cost of a chain
+// depends on the number of results rather than the nesting of the document.
+// Results are the same, in the same order, with the same duplicates.
+//
+// Node locations share a tree of steps, see LocationTree. Member names in
+// locations refer to the document and to _path_, so both must outlive any
+// nodes whose locations are used, unless the evaluator was given shared
+// ownership of _path_.
+template <typename Adapter> class Evaluator {
+public:
+  using node_type = typename Adapter::node_type;
+
+  Evaluator(const segments_t& path, const EvaluatorOptions& options = {})
+      : m_path{path}, m_options{options} {
+    for (auto expression : find_invariants(path)) {
+      m_invariants.emplace(expression, std::nullopt);
+    }
+
+    if constexpr (is_hashable_v<node_type>) {
+      bool descendant{false};
+      m_prune.reserve(path.size());
+      for (const auto& segment : path) {
+        const bool recursive{std::holds_alternative<RecursiveSegment>(segment)};
+        m_prune.push_back(recursive && descendant);
+        descendant = descendant || recursive;
+      }
+      m_produces.resize(path.size());
+    }
+
+    m_required.reserve(path.size());
+    for (const auto& segment : path) {
+      m_required.push_back(segment_requirements(segment));
+    }
+
+    if (!path.empty()) {
+      if (auto segment{std::get_if<RecursiveSegment>(&path.front())}) {
+        for (const auto& selector : segment->selectors) {
+          if (auto name{std::get_if<NameSelector>(&selector)}) {
+            m_index_names.push_back(name->name);
+          } else {
+            m_index_names.clear();
+            break;
+          }
+        }
+      }
+    }
+  };
+
+  struct Nothing {};
+  struct NodeValue {
+    node_type node;
+  };
+  struct NodesValue {
+    std::vector<node_type> nodes{};
+  };
+
+  // The result of evaluating a filter expression. Booleans are both JSON
+  // booleans and LogicalType results, and strings refer to the query or the
+  // document.
+  using value_t = std::variant<Nothing, NodeValue, NodesValue, std::nullptr_t,
+      bool, std::int64_t, double, std::string_view>;
+
+  // An implementation of a function extension. Arguments are passed as
+  // evaluated: queries are a NodesValue, logical expressions are a bool, and
+  // literals and other function calls are as they are. Use _resolve()_ to
+  // reduce a ValueType argument to Nothing, a scalar or a NodeValue. The
+  // result must be a bool for LogicalType, a NodesValue for NodesType, or
+  // Nothing, a scalar or a NodeValue for ValueType. Strings in the result
+  // must refer to the query, the document or storage that outlives the
+  // evaluation.
+  using function_t = std::function<value_t(const std::vector<value_t>&)>;
+
+  // An evaluator that keeps _path_ alive for as long as it, or any of the
+  // locations it records, is in use.
+  Evaluator(std::shared_ptr<const segments_t> path,
+      const EvaluatorOptions& options = {})
+      : Evaluator{*path, options} {
+    m_owner = std::move(path);
+  };
+
+  class Range;
+
+  // Return the nodes selected from the document rooted at _root_.
+  nodelist_t<Adapter> find(node_type root) {
+    return evaluate(root, nullptr, nullptr);
+  }
+
+  // Return the nodes selected from the document indexed by _index_. If the
+  // query starts with a descendant segment of name selectors, like
+  // `$..price`, nodes for that segment come from the index instead of a walk
+  // of the document. Other queries are evaluated as usual.
+  nodelist_t<Adapter> find(const KeyIndex<Adapter>& index) {
+    return evaluate(index.root(), &index, nullptr);
+  }
+
+  // Return the nodes selected from the document summarized by _summary_.
+  // Descendant segments whose selectors only select nodes with particular
+  // members, like `..a` or `..[?@.a]`, skip subtrees that _summary_ says
+  // don't have them. Summaries are built when first needed.
+  nodelist_t<Adapter> find(SubtreeSummary<Adapter>& summary) {
+    return evaluate(summary.root(), nullptr, &summary);
+  }
+
+  // Return a range over the nodes selected from the document rooted at
+  // _root_, evaluated lazily as the range is iterated. See Evaluator::Range.
+  Range lazy_find(node_type root) { return Range{*this, root}; }
+
+  // Like _find(SubtreeSummary&)_, but evaluated lazily.
+  Range lazy_find(SubtreeSummary<Adapter>& summary) {
+    Range range{*this, summary.root()};
+    range.m_summary = &summary;
+    return range;
+  }
+
+  // Return a range that continues the evaluation recorded in _cursor_, with
+  // the node after the last one returned before the cursor was taken. The
+  // document rooted at _root_ must not have changed since then. Throws a
+  // CursorError if _cursor_ came from a different query, or if it refers to
+  // nodes that don't exist or that the query doesn't select.
+  Range resume(node_type root, const Cursor& cursor) {
+    Range range{*this, root};
+    range.restore(cursor);
+    return range;
+  }
+
+  // Return the first node selected from the document rooted at _root_, or an
+  // empty optional if there are none, without looking any further.
+  std::optional<Node<Adapter>> first(node_type root) {
+    auto range{lazy_find(root)};
+    auto it{range.begin()};
+    if (it == range.end()) {
+      return std::nullopt;
+    }
+    return *it;
+  }
+
+  // Return the number of nodes selected from the document rooted at _root_,
+  // counting them as they're found rather than collecting them.
+  std::size_t count(node_type root) {
+    start(root);
+    return count_nodes(m_path, root);
+  }
+
+  // Return true if at least one node is selected from the document rooted
+  // at _root_, without looking past the first.
+  bool exists(node_type root) {
+    start(root);
+    return exists(m_path, root);
+  }
+
+  // Evaluate calls to the function extension _name_ with _function_, in
+  // place of the standard implementation if there is one. _name_ and its
+  // signature must also be given to the parser, so that calls to it are
+  // checked for well-typedness.
+  void add_function(std::string name, function_t function) {
+    m_functions.insert_or_assign(std::move(name), std::move(function));
+  }
+
+  // Reduce _value_ to Nothing, a scalar, or an array or object node, for
+  // comparison or as a ValueType function argument.
+  static value_t resolve(const value_t& value) {
+    if (auto nodes{std::get_if<NodesValue>(&value)}) {
+      if (nodes->nodes.size() == 1) {
+        return resolve(NodeValue{nodes->nodes.front()});
+      }
+      return Nothing{};
+    }
+
+    if (auto n{std::get_if<NodeValue>(&value)}) {
+      switch (Adapter::kind(n->node)) {
+      case ValueKind::null_:
+        return nullptr;
+      case ValueKind::boolean:
+        return Adapter::boolean_value(n->node);
+      case ValueKind::integer:
+        return Adapter::integer_value(n->node);
+      case ValueKind::float_:
+        return Adapter::float_value(n->node);
+      case ValueKind::string:
+        return Adapter::string_value(n->node);
+      default:
+        return value;
+      }
+    }
+
+    return value;
+  }
+
+private:
+  // A location step. Names refer to the document or the query.
+  using step_t = location_step_t;
+
+  // Nodes that segments of the query have been found to select something
+  // from, or not, for segments in _m_prune_.
+  using produces_t = std::conditional_t<is_hashable_v<node_type>,
+      std::unordered_map<node_type, bool>, std::nullptr_t>;
+
+  // A segment of name selectors, with a slot for each distinct name and the
+  // slot each selector refers to.
+  struct WideSegment {
+    std::unordered_map<std::string_view, std::size_t> names{};
+    std::vector<std::size_t> slots{};
+  };
+
+  // Segments with this many selectors or more, all of them names, select
+  // from objects with one pass over their members rather than one lookup per
+  // selector.
+  static constexpr std::size_t WIDE_SEGMENT{8};
+
+  // Shared slots for the candidate node currently being tested by a filter.
+  struct Frame {
+    const CommonSubexpressions* common{nullptr};
+    std::vector<std::optional<value_t>> values{};
+  };
+
+  const segments_t& m_path;
+  EvaluatorOptions m_options;
+  std::shared_ptr<const segments_t> m_owner{};
+  node_type m_root{};
+  LocationBuilder* m_location{nullptr};
+  std::unordered_map<const expression_t*, std::optional<value_t>>
+      m_invariants{};
+  std::unordered_map<const expression_t*, CommonSubexpressions> m_common{};
+  Frame* m_frame{nullptr};
+  std::unordered_map<const expression_t*, Program> m_programs{};
+  std::vector<value_t> m_registers{};
+  RegexCache m_regex{};
+  std::unordered_map<std::string, function_t> m_functions{};
+  std::unordered_map<const std::vector<selector_t>*,
+      std::optional<WideSegment>>
+      m_wide{};
+  std::vector<std::optional<node_type>> m_selected{};
+  std::vector<bool> m_prune{};
+  std::vector<produces_t> m_produces{};
+
+  // Names selected by the first segment of the query, if it's a descendant
+  // segment of name selectors that can be answered by a KeyIndex.
+  std::vector<std::string_view> m_index_names{};
+  const KeyIndex<Adapter>* m_index{nullptr};
+
+  // For each descendant segment whose selectors all need nodes with
+  // particular members, the names each selector needs. See _prunable()_.
+  std::vector<std::optional<std::vector<std::vector<std::string_view>>>>
+      m_required{};
+  SubtreeSummary<Adapter>* m_summary{nullptr};
+
+  // Return the nodes selected from the document rooted at _root_, using
+  // _index_ and _summary_ if they aren't null.
+  nodelist_t<Adapter> evaluate(node_type root, const KeyIndex<Adapter>* index,
+      SubtreeSummary<Adapter>* summary) {
+    start(root);
+    m_index = index;
+    m_summary = summary;
+
+    nodelist_t<Adapter> nodes{};
+    if constexpr (TRACK_LOCATIONS) {
+      if (m_options.locations) {
+        LocationBuilder location{};
+        location.retain(m_owner);
+        m_location = &location;
+
+        auto emit{[&nodes, &location](node_type node) {
+          nodes.push_back(Node<Adapter>{node, location.current()});
+          return true;
+        }};
+
+        apply<true>(m_path, 0, root, emit);
+        m_location = nullptr;
+        return nodes;
+      }
+    }
+
+    auto emit{[&nodes](node_type node) {
+      nodes.push_back(Node<Adapter>{node});
+      return true;
+    }};
+
+    apply<false>(m_path, 0, root, emit);
+    return nodes;
+  }
+
+  // Reset per-evaluation state for a new evaluation against _root_.
+  void start(node_type root) {
+    m_root = root;
+    m_index = nullptr;
+    m_summary = nullptr;
+    m_registers.clear();
+    m_selected.clear();
+    for (auto& [_, cached] : m_invariants) {
+      cached.reset();
+    }
+    if constexpr (is_hashable_v<node_type>) {
+      for (auto& produces : m_produces) {
+        produces.clear();
+      }
+    }
+  }
+
+  // Return a copy of _steps_ that doesn't refer to the document or query.
+  static std::vector<path_step_t> to_location(
+      const std::vector<step_t>& steps) {
+    std::vector<path_step_t> location{};
+    location.reserve(steps.size());
+    for (const auto& step : steps) {
+      if (auto name{std::get_if<std::string_view>(&step)}) {
+        location.emplace_back(std::string{*name});
+      } else {
+        location.emplace_back(std::get<std::int64_t>(step));
+      }
+    }
+    return location;
+  }
+
+  // Apply segments of _path_ from _i_ to _node_, calling _emit_ with each
+  // resulting node. Returns false if _emit_ asked to stop, by returning
+  // false, in which case evaluation stops too. Location steps are only
+  // recorded if _Track_ is true.
+  template <bool Track, typename Emit>
+  bool apply(
+      const segments_t& path, std::size_t i, node_type node, Emit& emit) {
+    if (i == path.size()) {
+      return emit(node);
+    }
+
+    if (auto segment{std::get_if<Segment>(&path[i])}) {
+      return select_each<Track>(segment->selectors, path, i, node, emit);
+    }
+
+    return descend<Track>(
+        std::get<RecursiveSegment>(path[i]).selectors, path, i, node, emit);
+  }
+
+  // Apply _selectors_ to _node_ and each of its descendants, in document
+  // order.
+  template <bool Track, typename Emit>
+  bool descend(const std::vector<selector_t>& selectors,
+      const segments_t& path, std::size_t i, node_type node, Emit& emit) {
+    if (prunable(path, i, node)) {
+      return true;
+    }
+
+    // The first segment of the query is only ever applied to the root node.
+    if (m_index && i == 0 && &path == &m_path && !m_index_names.empty()) {
+      return descend_indexed<Track>(path, emit);
+    }
+
+    if (!select_each<Track>(selectors, path, i, node, emit)) {
+      return false;
+    }
+
+    return for_each_child(node, [&](step_t step, node_type child) {
+      return visit<Track>(step, [&]() {
+        return descend<Track>(selectors, path, i, child, emit);
+      });
+    });
+  }
+
+  // Apply the first segment of the query, a descendant segment of name
+  // selectors, to the root node, using postings from _m_index_ rather than
+  // walking the document. Objects are numbered in the order a walk would
+  // visit them, so merging postings by object, then by selector, gives the
+  // same nodes in the same order.
+  template <bool Track, typename Emit>
+  bool descend_indexed(const segments_t& path, Emit& emit) {
+    using Posting = typename KeyIndex<Adapter>::Posting;
+    const auto count{m_index_names.size()};
+    std::vector<const std::vector<Posting>*> postings{};
+    postings.reserve(count);
+    for (const auto& name : m_index_names) {
+      postings.push_back(&m_index->postings(name));
+    }
+    std::vector<std::size_t> heads(count, 0);
+
+    // The root node is numbered LocationTree::ROOT, which wraps to zero.
+    auto order{[](const Posting& posting) { return posting.parent + 1U; }};
+
+    // Steps to the current object, pushed on to the current location.
+    std::uint32_t parent{LocationTree::ROOT};
+    std::size_t depth{0};
+    auto unwind{[&]() {
+      if constexpr (Track) {
+        for (; depth > 0; depth--) {
+          m_location->pop();
+        }
+      }
+    }};
+
+    for (;;) {
+      auto k{count};
+      for (std::size_t n = 0; n < count; n++) {
+        if (heads[n] < postings[n]->size() &&
+            (k == count || order((*postings[n])[heads[n]]) <
+                               order((*postings[k])[heads[k]]))) {
+          k = n;
+        }
+      }
+      if (k == count) {
+        unwind();
+        return true;
+      }
+
+      const auto& posting{(*postings[k])[heads[k]++]};
+      if constexpr (Track) {
+        if (posting.parent != parent) {
+          unwind();
+          parent = posting.parent;
+          for (const auto& step : m_index->location(parent).steps()) {
+            m_location->push(step);
+            depth++;
+          }
+        }
+      }
+
+      const bool more{visit<Track>(m_index_names[k],
+          [&]() { return apply<Track>(path, 1, posting.node, emit); })};
+      if (!more) {
+        unwind();
+        return false;
+      }
+    }
+  }
+
+  // Call _f_ with _step_ pushed on to the current location.
+  template <bool Track, typename F> bool visit(step_t step, F&& f) {
+    if constexpr (Track) {
+      m_location->push(step);
+      const bool more{f()};
+      m_location->pop();
+      return more;
+    } else {
+      return f();
+    }
+  }
+
+  // Call _f_ with the location step and value of each child of _node_, in
+  // order, until _f_ returns false.
+  template <typename F> static bool for_each_child(node_type node, F&& f) {
+    const auto kind{Adapter::kind(node)};
+    if (kind == ValueKind::array) {
+      const auto size{Adapter::size(node)};
+      for (std::size_t j = 0; j < size; j++) {
+        if (!f(step_t{static_cast<std::int64_t>(j)},
+                Adapter::element(node, j))) {
+          return false;
+        }
+      }
+    } else if (kind == ValueKind::object) {
+      const auto end{Adapter::members_end(node)};
+      for (auto it{Adapter::members_begin(node)}; it != end; ++it) {
+        if (!f(step_t{Adapter::member_name(it)}, Adapter::member_value(it))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Apply each of _selectors_ to _node_, in order.
+  template <bool Track, typename Emit>
+  bool select_each(const std::vector<selector_t>& selectors,
+      const segments_t& path, std::size_t i, node_type node, Emit& emit) {
+    if (selectors.size() >= WIDE_SEGMENT &&
+        Adapter::kind(node) == ValueKind::object) {
+      if (const auto wide{wide_segment(selectors)}) {
+        return select_wide<Track>(*wide, selectors, path, i, node, emit);
+      }
+    }
+
+    for (const auto& selector : selectors) {
+      if (!select<Track>(selector, path, i, node, emit)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Return a lookup for _selectors_ if they're all name selectors, or null.
+  const WideSegment* wide_segment(const std::vector<selector_t>& selectors) {
+    auto [it, inserted]{m_wide.try_emplace(&selectors)};
+    if (inserted) {
+      WideSegment wide{};
+      wide.slots.reserve(selectors.size());
+      for (const auto& selector : selectors) {
+        auto name{std::get_if<NameSelector>(&selector)};
+        if (!name) {
+          return nullptr;
+        }
+        const auto [slot, _]{
+            wide.names.try_emplace(name->name, wide.names.size())};
+        wide.slots.push_back(slot->second);
+      }
+      it->second = std::move(wide);
+    }
+    return it->second ? &it->second.value() : nullptr;
+  }
+
+  // Apply the name selectors _selectors_ to the object _node_, with one pass
+  // over its members, then follow the selected members in selector order.
+  template <bool Track, typename Emit>
+  bool select_wide(const WideSegment& wide,
+      const std::vector<selector_t>& selectors, const segments_t& path,
+      std::size_t i, node_type node, Emit& emit) {
+    // Slots for nested evaluations go after this one's.
+    const auto base{m_selected.size()};
+    const auto distinct{wide.names.size()};
+    m_selected.resize(base + distinct);
+
+    std::size_t found{0};
+    const auto end{Adapter::members_end(node)};
+    for (auto it{Adapter::members_begin(node)}; it != end && found < distinct;
+         ++it) {
+      if (auto name{wide.names.find(Adapter::member_name(it))};
+          name != wide.names.end() && !m_selected[base + name->second]) {
+        m_selected[base + name->second] = Adapter::member_value(it);
+        found++;
+      }
+    }
+
+    bool more{true};
+    for (std::size_t s = 0; more && s < selectors.size(); s++) {
+      if (const auto child{m_selected[base + wide.slots[s]]}) {
+        const step_t step{
+            std::string_view{std::get<NameSelector>(selectors[s]).name}};
+        more = visit<Track>(step,
+            [&]() { return apply<Track>(path, i + 1, child.value(), emit); });
+      }
+    }
+
+    m_selected.resize(base);
+    return more;
+  }
+
+  template <bool Track, typename Emit>
+  bool select(const selector_t& selector, const segments_t& path,
+      std::size_t i, node_type node, Emit& emit) {
+    auto next{[&](step_t step, node_type child) {
+      return visit<Track>(
+          step, [&]() { return apply<Track>(path, i + 1, child, emit); });
+    }};
+    return for_each_selected(selector, node, next);
+  }
+
+  // Call _next_ with the location step and value of each node selected from
+  // _node_ by _selector_, in order, until _next_ returns false.
+  template <typename Next>
+  bool for_each_selected(
+      const selector_t& selector, node_type node, Next& next) {
+    if (auto name{std::get_if<NameSelector>(&selector)}) {
+      if (Adapter::kind(node) == ValueKind::object) {
+        if (auto child{Adapter::member(node, name->name)}) {
+          return next(step_t{std::string_view{name->name}}, child.value());
+        }
+      }
+      return true;
+    }
+
+    if (auto index{std::get_if<IndexSelector>(&selector)}) {
+      if (Adapter::kind(node) == ValueKind::array) {
+        const auto size{static_cast<std::int64_t>(Adapter::size(node))};
+        const auto j{index->index < 0 ? index->index + size : index->index};
+        if (j >= 0 && j < size) {
+          return next(
+              step_t{j}, Adapter::element(node, static_cast<std::size_t>(j)));
+        }
+      }
+      return true;
+    }
+
+    if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+      if (Adapter::kind(node) == ValueKind::array) {
+        return select_slice(*slice, node, next);
+      }
+      return true;
+    }
+
+    if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+      auto prepared{prepare((*filter)->expression)};
+      return for_each_child(node, [&](step_t step, node_type child) {
+        return !matches(prepared, child) || next(step, child);
+      });
+    }
+
+    // A wildcard.
+    return for_each_child(node, next);
+  }
+
+  // Return the names each selector of _segment_ needs a node to have, if
+  // it's a descendant segment and every selector needs at least one.
+  static std::optional<std::vector<std::vector<std::string_view>>>
+  segment_requirements(const segments_t::value_type& segment) {
+    auto recursive{std::get_if<RecursiveSegment>(&segment)};
+    if (!recursive) {
+      return std::nullopt;
+    }
+
+    std::vector<std::vector<std::string_view>> required{};
+    for (const auto& selector : recursive->selectors) {
+      std::vector<std::string_view> names{};
+      if (auto name{std::get_if<NameSelector>(&selector)}) {
+        names.push_back(name->name);
+      } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        names = required_names((*filter)->expression);
+      }
+      if (names.empty()) {
+        return std::nullopt;
+      }
+      required.push_back(std::move(names));
+    }
+    return required;
+  }
+
+  // Return true if segment _i_ of _path_ is known to select nothing from
+  // _node_ or its descendants, so neither need visiting. That's the case if
+  // the subtree summary says none of the segment's selectors can find the
+  // names they need, or if the rest of the query produces nothing.
+  bool prunable(const segments_t& path, std::size_t i, node_type node) {
+    if constexpr (is_hashable_v<node_type>) {
+      if (&path != &m_path || i >= m_path.size()) {
+        return false;
+      }
+
+      if (m_summary && m_required[i]) {
+        bool possible{false};
+        for (const auto& names : *m_required[i]) {
+          if (m_summary->may_contain(node, names)) {
+            possible = true;
+            break;
+          }
+        }
+        if (!possible) {
+          return true;
+        }
+      }
+
+      return m_prune[i] && !produces(i, node);
+    } else {
+      return false;
+    }
+  }
+
+  // Return true if applying segments of the query from _i_ to _node_ selects
+  // at least one node. Answers for segments in _m_prune_ are remembered until
+  // the next evaluation, so each node is checked at most once per segment.
+  bool produces(std::size_t i, node_type node) {
+    if (i == m_path.size()) {
+      return true;
+    }
+
+    if constexpr (is_hashable_v<node_type>) {
+      if (m_prune[i]) {
+        if (auto it{m_produces[i].find(node)}; it != m_produces[i].end()) {
+          return it->second;
+        }
+      }
+    }
+
+    bool found{false};
+    auto next{[&](step_t, node_type child) {
+      found = produces(i + 1, child);
+      return !found;
+    }};
+
+    const auto& segment{m_path[i]};
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+    for (const auto& selector : selectors) {
+      if (!for_each_selected(selector, node, next)) {
+        break;
+      }
+    }
+
+    if (!found && std::holds_alternative<RecursiveSegment>(segment)) {
+      for_each_child(node, [&](step_t, node_type child) {
+        found = produces(i, child);
+        return !found;
+      });
+    }
+
+    if constexpr (is_hashable_v<node_type>) {
+      if (m_prune[i]) {
+        m_produces[i].emplace(node, found);
+      }
+    }
+    return found;
+  }
+
+  // A filter expression with its shared subexpressions and, if enabled, its
+  // compiled program, along with slots for testing one candidate at a time.
+  struct Prepared {
+    const expression_t* expression{nullptr};
+    const Program* program{nullptr};
+    Frame frame{};
+  };
+
+  Prepared prepare(const expression_t& expression) {
+    auto [it, inserted]{m_common.try_emplace(&expression)};
+    if (inserted) {
+      it->second = find_common_subexpressions(expression);
+    }
+
+    const Program* program{nullptr};
+    if (m_options.bytecode) {
+      auto [p, compiled]{m_programs.try_emplace(&expression)};
+      if (compiled) {
+        p->second = compile_filter(expression);
+      }
+      program = &p->second;
+    }
+
+    return Prepared{&expression, program, Frame{&it->second, {}}};
+  }
+
+  // Return true if the filter _prepared_ selects _candidate_.
+  bool matches(Prepared& prepared, node_type candidate) {
+    auto& frame{prepared.frame};
+    if (!frame.common->merged.empty()) {
+      frame.values.assign(frame.common->merged.size(), std::nullopt);
+    }
+    Frame* outer{m_frame};
+    m_frame = &frame;
+    const bool selected{prepared.program
+                            ? run(*prepared.program, candidate)
+                            : test(*prepared.expression, candidate)};
+    m_frame = outer;
+    return selected;
+  }
+
+  // The indices selected by a slice, from _start_ towards _stop_, which is
+  // exclusive, in increments of _step_.
+  struct SliceBounds {
+    std::int64_t start{0};
+    std::int64_t stop{0};
+    std::int64_t step{1};
+
+    bool contains(std::int64_t j) const noexcept {
+      return step > 0 ? j < stop : stop < j;
+    }
+  };
+
+  // Return the bounds of _slice_ applied to an array of length _size_,
+  // following section 2.3.4.2.2 of RFC 9535.
+  static SliceBounds slice_bounds(
+      const SliceSelector& slice, std::int64_t size) {
+    const auto step{slice.step.value_or(1)};
+    if (step == 0) {
+      return SliceBounds{};
+    }
+
+    auto normalize{[size](std::int64_t i) { return i >= 0 ? i : size + i; }};
+
+    if (step > 0) {
+      const auto lower{std::min(
+          std::max(normalize(slice.start.value_or(0)), std::int64_t{0}),
+          size)};
+      const auto upper{std::min(
+          std::max(normalize(slice.stop.value_or(size)), std::int64_t{0}),
+          size)};
+      return SliceBounds{lower, upper, step};
+    }
+
+    const auto upper{std::min(
+        std::max(normalize(slice.start.value_or(size - 1)), std::int64_t{-1}),
+        size - 1)};
+    const auto lower{std::min(std::max(slice.stop ? normalize(*slice.stop)
+                                                  : std::int64_t{-1},
+                                  std::int64_t{-1}),
+        size - 1)};
+    return SliceBounds{upper, lower, step};
+  }
+
+  // Select from the array _node_ following section 2.3.4.2.2 of RFC 9535.
+  template <typename Next>
+  bool select_slice(const SliceSelector& slice, node_type node, Next& next) {
+    const auto bounds{
+        slice_bounds(slice, static_cast<std::int64_t>(Adapter::size(node)))};
+    for (auto j = bounds.start; bounds.contains(j); j += bounds.step) {
+      if (!next(step_t{j},
+              Adapter::element(node, static_cast<std::size_t>(j)))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Return true if _path_ selects at least one node from _node_.
+  bool exists(const segments_t& path, node_type node) {
+    bool found{false};
+    auto emit{[&found](node_type) {
+      found = true;
+      return false;
+    }};
+    apply<false>(path, 0, node, emit);
+    return found;
+  }
+
+  std::size_t count_nodes(const segments_t& path, node_type node) {
+    std::size_t count{0};
+    auto emit{[&count](node_type) {
+      count++;
+      return true;
+    }};
+    apply<false>(path, 0, node, emit);
+    return count;
+  }
+
+  // Return the node _path_ selects from _node_, if it selects exactly one,
+  // or Nothing, stopping at the second.
+  value_t only(const segments_t& path, node_type node) {
+    std::optional<node_type> found{};
+    bool more{false};
+    auto emit{[&found, &more](node_type n) {
+      more = found.has_value();
+      found = n;
+      return !more;
+    }};
+    apply<false>(path, 0, node, emit);
+    if (!found || more) {
+      return Nothing{};
+    }
+    return NodeValue{found.value()};
+  }
+
+  NodesValue collect(const segments_t& path, node_type node) {
+    NodesValue result{};
+    auto emit{[&result](node_type n) {
+      result.nodes.push_back(n);
+      return true;
+    }};
+    apply<false>(path, 0, node, emit);
+    return result;
+  }
+
+  // Return a cached value for _expression_ if it's invariant or a shared
+  // subexpression, computing it with _compute_ the first time.
+  template <typename F>
+  value_t memoize(const expression_t& expression, F&& compute) {
+    if (!m_invariants.empty()) {
+      if (auto it{m_invariants.find(&expression)}; it != m_invariants.end()) {
+        if (!it->second) {
+          it->second = compute();
+        }
+        return it->second.value();
+      }
+    }
+
+    if (m_frame && !m_frame->common->merged.empty()) {
+      if (auto slot{m_frame->common->slot(expression)}) {
+        auto& value{m_frame->values[slot.value()]};
+        if (!value) {
+          value = compute();
+        }
+        return value.value();
+      }
+    }
+
+    return compute();
+  }
+
+  // Run the compiled filter _program_ with _current_ as `@`. Registers
+  // for nested filters go after those of enclosing filters, so register
+  // values are accessed by index, not by reference, while operands are
+  // being evaluated.
+  bool run(const Program& program, node_type current) {
+    const auto base{m_registers.size()};
+    m_registers.resize(base + program.registers);
+
+    const auto code{program.code.data()};
+    const auto size{program.code.size()};
+    bool accumulator{false};
+    std::size_t pc{0};
+
+    while (pc < size) {
+      const auto& ins{code[pc++]};
+      switch (ins.opcode) {
+      case Opcode::set:
+        accumulator = ins.a != 0;
+        break;
+      case Opcode::load_constant:
+        m_registers[base + ins.a] = constant(program.constants[ins.b]);
+        break;
+      case Opcode::load_singular: {
+        auto node{program.paths[ins.b].template find<Adapter>(current)};
+        m_registers[base + ins.a] =
+            node ? resolve(NodeValue{node.value()}) : value_t{Nothing{}};
+        break;
+      }
+      case Opcode::load_value: {
+        auto value{resolve(evaluate(*program.operands[ins.b], current))};
+        m_registers[base + ins.a] = std::move(value);
+        break;
+      }
+      case Opcode::compare:
+        accumulator = compare(
+            m_registers[base + ins.a], ins.op, m_registers[base + ins.b]);
+        break;
+      case Opcode::compare_number:
+        accumulator = compare_number(
+            m_registers[base + ins.a], ins.op, program.constants[ins.b]);
+        break;
+      case Opcode::compare_string:
+        accumulator = compare_string(
+            m_registers[base + ins.a], ins.op, program.constants[ins.b]);
+        break;
+      case Opcode::exists_singular:
+        accumulator =
+            program.paths[ins.b].template find<Adapter>(current).has_value();
+        break;
+      case Opcode::test:
+        accumulator = test(*program.operands[ins.b], current);
+        break;
+      case Opcode::not_:
+        accumulator = !accumulator;
+        break;
+      case Opcode::jump_if_false:
+        if (!accumulator) {
+          pc = ins.b;
+        }
+        break;
+      case Opcode::jump_if_true:
+        if (accumulator) {
+          pc = ins.b;
+        }
+        break;
+      }
+    }
+
+    m_registers.resize(base);
+    return accumulator;
+  }
+
+  static value_t constant(const Constant& c) {
+    switch (c.kind) {
+    case ValueKind::boolean:
+      return c.boolean;
+    case ValueKind::integer:
+      return c.integer;
+    case ValueKind::float_:
+      return c.number;
+    case ValueKind::string:
+      return c.string;
+    default:
+      return nullptr;
+    }
+  }
+
+  template <typename T> static bool order(T left, BinaryOperator op, T right) {
+    switch (op) {
+    case BinaryOperator::eq:
+      return left == right;
+    case BinaryOperator::ne:
+      return left != right;
+    case BinaryOperator::lt:
+      return left < right;
+    case BinaryOperator::gt:
+      return right < left;
+    case BinaryOperator::le:
+      return !(right < left);
+    case BinaryOperator::ge:
+      return !(left < right);
+    default:
+      return false;
+    }
+  }
+
+  // Compare the resolved value _left_ with the number constant _right_.
+  // Values of any other type are only ever not equal.
+  static bool compare_number(
+      const value_t& left, BinaryOperator op, const Constant& right) {
+    if (auto i{std::get_if<std::int64_t>(&left)}) {
+      return right.kind == ValueKind::integer
+                 ? order(*i, op, right.integer)
+                 : order(static_cast<double>(*i), op, right.number);
+    }
+    if (auto f{std::get_if<double>(&left)}) {
+      return order(*f, op, right.number);
+    }
+    return op == BinaryOperator::ne;
+  }
+
+  // Compare the resolved value _left_ with the string constant _right_.
+  static bool compare_string(
+      const value_t& left, BinaryOperator op, const Constant& right) {
+    if (auto s{std::get_if<std::string_view>(&left)}) {
+      return order(*s, op, right.string);
+    }
+    return op == BinaryOperator::ne;
+  }
+
+  // Evaluate _expression_ in a logical context, with _current_ as `@`.
+  bool test(const expression_t& expression, node_type current) {
+    if (!m_invariants.empty()) {
+      if (auto it{m_invariants.find(&expression)}; it != m_invariants.end()) {
+        if (!it->second) {
+          it->second = value_t{test_uncached(expression, current)};
+        }
+        return std::get<bool>(it->second.value());
+      }
+    }
+    return test_uncached(expression, current);
+  }
+
+  bool test_uncached(const expression_t& expression, node_type current) {
+    if (auto literal{std::get_if<BooleanLiteral>(&expression)}) {
+      return literal->value;
+    }
+
+    if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+      return !test((*not_)->right, current);
+    }
+
+    if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+      const auto op{(*infix)->op};
+      if (op == BinaryOperator::logical_and) {
+        return test((*infix)->left, current) &&
+               test((*infix)->right, current);
+      }
+      if (op == BinaryOperator::logical_or) {
+        return test((*infix)->left, current) ||
+               test((*infix)->right, current);
+      }
+    }
+
+    // Existence tests, without building a nodelist unless it's shared.
+    if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)};
+        relative && !is_memoized(expression)) {
+      return exists((*relative)->query, current);
+    }
+    if (auto root{std::get_if<Box<RootQuery>>(&expression)};
+        root && !is_memoized(expression)) {
+      return exists((*root)->query, m_root);
+    }
+
+    const auto value{evaluate(expression, current)};
+    if (auto b{std::get_if<bool>(&value)}) {
+      return *b;
+    }
+    if (auto nodes{std::get_if<NodesValue>(&value)}) {
+      return !nodes->nodes.empty();
+    }
+    return false;
+  }
+
+  bool is_memoized(const expression_t& expression) const {
+    return m_invariants.count(&expression) > 0 ||
+           (m_frame && m_frame->common->slot(expression));
+  }
+
+  // Evaluate _expression_ in a value context, with _current_ as `@`.
+  value_t evaluate(const expression_t& expression, node_type current) {
+    if (std::holds_alternative<NullLiteral>(expression)) {
+      return nullptr;
+    }
+    if (auto b{std::get_if<BooleanLiteral>(&expression)}) {
+      return b->value;
+    }
+    if (auto i{std::get_if<IntegerLiteral>(&expression)}) {
+      return i->value;
+    }
+    if (auto f{std::get_if<FloatLiteral>(&expression)}) {
+      return f->value;
+    }
+    if (auto s{std::get_if<StringLiteral>(&expression)}) {
+      return std::string_view{s->value};
+    }
+
+    if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+      return memoize(expression,
+          [&]() { return value_t{collect((*relative)->query, current)}; });
+    }
+    if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+      return memoize(expression,
+          [&]() { return value_t{collect((*root)->query, m_root)}; });
+    }
+    if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+      return memoize(
+          expression, [&]() { return call_function(**call, current); });
+    }
+
+    if (auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+        infix && (*infix)->op != BinaryOperator::logical_and &&
+        (*infix)->op != BinaryOperator::logical_or) {
+      return memoize(expression, [&]() {
+        return value_t{compare(evaluate((*infix)->left, current),
+            (*infix)->op, evaluate((*infix)->right, current))};
+      });
+    }
+
+    return test(expression, current);
+  }
+
+  static std::optional<double> number(const value_t& value) {
+    if (auto i{std::get_if<std::int64_t>(&value)}) {
+      return static_cast<double>(*i);
+    }
+    if (auto f{std::get_if<double>(&value)}) {
+      return *f;
+    }
+    return std::nullopt;
+  }
+
+  static bool equal(const value_t& left, const value_t& right) {
+    auto li{std::get_if<std::int64_t>(&left)};
+    auto ri{std::get_if<std::int64_t>(&right)};
+    if (li && ri) {
+      return *li == *ri;
+    }
+
+    auto ln{number(left)};
+    auto rn{number(right)};
+    if (ln || rn) {
+      return ln && rn && *ln == *rn;
+    }
+
+    if (left.index() != right.index()) {
+      return false;
+    }
+
+    if (std::holds_alternative<Nothing>(left) ||
+        std::holds_alternative<std::nullptr_t>(left)) {
+      return true;
+    }
+    if (auto b{std::get_if<bool>(&left)}) {
+      return *b == std::get<bool>(right);
+    }
+    if (auto s{std::get_if<std::string_view>(&left)}) {
+      return *s == std::get<std::string_view>(right);
+    }
+    if (auto n{std::get_if<NodeValue>(&left)}) {
+      return equal_nodes(n->node, std::get<NodeValue>(right).node);
+    }
+    return false;
+  }
+
+  static bool equal_nodes(node_type left, node_type right) {
+    const auto lk{Adapter::kind(left)};
+    const auto rk{Adapter::kind(right)};
+    if (lk != ValueKind::array && lk != ValueKind::object) {
+      return equal(resolve(NodeValue{left}), resolve(NodeValue{right}));
+    }
+    if (lk != rk || Adapter::size(left) != Adapter::size(right)) {
+      return false;
+    }
+
+    if (lk == ValueKind::array) {
+      for (std::size_t j = 0; j < Adapter::size(left); j++) {
+        if (!equal_nodes(
+                Adapter::element(left, j), Adapter::element(right, j))) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    const auto end{Adapter::members_end(left)};
+    for (auto it{Adapter::members_begin(left)}; it != end; ++it) {
+      auto other{Adapter::member(right, Adapter::member_name(it))};
+      if (!other || !equal_nodes(Adapter::member_value(it), other.value())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool less(const value_t& left, const value_t& right) {
+    auto li{std::get_if<std::int64_t>(&left)};
+    auto ri{std::get_if<std::int64_t>(&right)};
+    if (li && ri) {
+      return *li < *ri;
+    }
+
+    auto ln{number(left)};
+    auto rn{number(right)};
+    if (ln && rn) {
+      return *ln < *rn;
+    }
+
+    // UTF-8 byte order is the same as code point order.
+    auto ls{std::get_if<std::string_view>(&left)};
+    auto rs{std::get_if<std::string_view>(&right)};
+    return ls && rs && *ls < *rs;
+  }
+
+  // Compare two values following section 2.3.5.2.2 of RFC 9535.
+  static bool compare(const value_t& left_value, BinaryOperator op,
+      const value_t& right_value) {
+    const auto left{resolve(left_value)};
+    const auto right{resolve(right_value)};
+    switch (op) {
+    case BinaryOperator::eq:
+      return equal(left, right);
+    case BinaryOperator::ne:
+      return !equal(left, right);
+    case BinaryOperator::lt:
+      return less(left, right);
+    case BinaryOperator::gt:
+      return less(right, left);
+    case BinaryOperator::le:
+      return less(left, right) || equal(left, right);
+    case BinaryOperator::ge:
+      return less(right, left) || equal(left, right);
+    default:
+      return false;
+    }
+  }
+
+  value_t call_function(const FunctionCall& call, node_type current) {
+    if (!m_functions.empty()) {
+      if (auto it{m_functions.find(std::string{call.name})};
+          it != m_functions.end()) {
+        std::vector<value_t> args{};
+        args.reserve(call.args.size());
+        for (const auto& arg : call.args) {
+          args.push_back(evaluate(arg, current));
+        }
+        return it->second(args);
+      }
+    }
+
+    // A query argument whose nodes are only counted, or only used if there's
+    // exactly one of them, is evaluated without collecting its nodes.
+    if (call.args.size() == 1) {
+      if (auto query{streamed_query(call.args.front(), current)}) {
+        const auto& [path, node]{query.value()};
+        if (call.name == "count") {
+          return static_cast<std::int64_t>(count_nodes(*path, node));
+        }
+        if (call.name == "length") {
+          return length(only(*path, node));
+        }
+        if (call.name == "value") {
+          return only(*path, node);
+        }
+      }
+    }
+
+    std::vector<value_t> args{};
+    args.reserve(call.args.size());
+    for (const auto& arg : call.args) {
+      args.push_back(evaluate(arg, current));
+    }
+
+    if (call.name == "length" && args.size() == 1) {
+      return length(args[0]);
+    }
+
+    if (call.name == "count" && args.size() == 1) {
+      if (auto nodes{std::get_if<NodesValue>(&args[0])}) {
+        return static_cast<std::int64_t>(nodes->nodes.size());
+      }
+      return Nothing{};
+    }
+
+    if ((call.name == "match" || call.name == "search") &&
+        args.size() == 2) {
+      const auto value{resolve(args[0])};
+      const auto pattern{resolve(args[1])};
+      auto s{std::get_if<std::string_view>(&value)};
+      auto p{std::get_if<std::string_view>(&pattern)};
+      return s && p && m_regex.matches(*p, *s, call.name == "match");
+    }
+
+    if (call.name == "value" && args.size() == 1) {
+      if (auto nodes{std::get_if<NodesValue>(&args[0])};
+          nodes && nodes->nodes.size() == 1) {
+        return NodeValue{nodes->nodes.front()};
+      }
+      return Nothing{};
+    }
+
+    throw NameError(
+        "unknown function extension '" + std::string{call.name} + "'",
+        call.token);
+  }
+
+  // Return the query in function argument _arg_ and the node it's applied
+  // to, unless _arg_ isn't a query or its nodes are memoized.
+  std::optional<std::pair<const segments_t*, node_type>> streamed_query(
+      const expression_t& arg, node_type current) const {
+    if (is_memoized(arg)) {
+      return std::nullopt;
+    }
+    if (auto relative{std::get_if<Box<RelativeQuery>>(&arg)}) {
+      return std::make_pair(&(*relative)->query, current);
+    }
+    if (auto root{std::get_if<Box<RootQuery>>(&arg)}) {
+      return std::make_pair(&(*root)->query, m_root);
+    }
+    return std::nullopt;
+  }
+
+  static value_t length(const value_t& arg) {
+    const auto value{resolve(arg)};
+    if (auto s{std::get_if<std::string_view>(&value)}) {
+      return static_cast<std::int64_t>(utf8_length(*s));
+    }
+    if (auto n{std::get_if<NodeValue>(&value)}) {
+      return static_cast<std::int64_t>(Adapter::size(n->node));
+    }
+    return Nothing{};
+  }
+};
+
+// A lazily evaluated range over the nodes selected by an Evaluator.
+//
+// Segments are applied as a depth first pipeline, driven by an explicit stack
+// with an entry for each node on the way from the root to the node being
+// visited. No intermediate nodelists are built, so memory use grows with the
+// depth of the document rather than the number of results. _begin()_ returns
+// as soon as the first node is found, and each increment does only as much
+// work as it takes to find the next one. Abandoning iteration early abandons
+// the rest of the traversal.
+//
+// A range can be iterated once, like an input stream. Its evaluator must
+// outlive it, and must not be used for another evaluation while the range is
+// being iterated.
+template <typename Adapter> class Evaluator<Adapter>::Range {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Node<Adapter>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Node<Adapter>*;
+    using reference = const Node<Adapter>&;
+
+    iterator() = default;
+
+    reference operator*() const { return m_range->m_current; }
+    pointer operator->() const { return &m_range->m_current; }
+
+    iterator& operator++() {
+      if (!m_range->next()) {
+        m_range = nullptr;
+      }
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const iterator& lhs, const iterator& rhs) {
+      return lhs.m_range == rhs.m_range;
+    }
+    friend bool operator!=(const iterator& lhs, const iterator& rhs) {
+      return lhs.m_range != rhs.m_range;
+    }
+
+  private:
+    friend class Range;
+    explicit iterator(Range* range) : m_range{range} {};
+    Range* m_range{nullptr};
+  };
+
+  Range(Evaluator& evaluator, node_type root)
+      : m_evaluator{&evaluator}, m_root{root} {
+    m_location.retain(evaluator.m_owner);
+  };
+
+  Range(const Range&) = delete;
+  Range& operator=(const Range&) = delete;
+  Range(Range&&) = default;
+  Range& operator=(Range&&) = default;
+
+  // Start evaluation, if it hasn't started already, and return an iterator
+  // to the current node.
+  iterator begin() {
+    if (!m_started) {
+      m_started = true;
+      m_evaluator->start(m_root);
+      m_evaluator->m_summary = m_summary;
+      if (m_stack.empty()) {
+        m_stack.push_back(Pending{m_root});
+      }
+      m_more = next();
+    }
+    return m_more ? iterator{this} : end();
+  }
+
+  iterator end() { return iterator{}; }
+
+  // Return the current traversal position, for resuming evaluation with
+  // _Evaluator::resume()_ after the current node.
+  Cursor cursor() const {
+    Cursor rv{};
+    rv.query_hash = hash(m_evaluator->m_path);
+    rv.done = m_started && m_stack.empty();
+    rv.returned = m_returned;
+    rv.entries.reserve(m_stack.size());
+    for (const auto& pending : m_stack) {
+      rv.entries.push_back(CursorEntry{
+          pending.segment, pending.selector, pending.started, pending.index});
+    }
+    rv.location = to_location(m_location.steps());
+    return rv;
+  }
+
+private:
+  friend class Evaluator;
+
+  using member_iterator = typename Adapter::member_iterator;
+
+  // A node that segment _segment_ of the path is being applied to, with the
+  // progress made so far. Selectors are applied in order, followed by a
+  // walk of the node's children for descendant segments. _started_,
+  // _index_, _stop_, _step_ and _member_ track progress through the current
+  // selector's children, or through the node's children once the selectors
+  // are done.
+  struct Pending {
+    node_type node;
+    std::size_t segment{0};
+    std::size_t selector{0};
+    bool started{false};
+    ValueKind kind{ValueKind::null_};
+    std::int64_t index{0};
+    std::int64_t stop{0};
+    std::int64_t step{1};
+    member_iterator member{};
+    std::optional<Prepared> filter{};
+  };
+
+  // A node produced by a pending entry, to be pushed on to the stack.
+  struct Child {
+    step_t step;
+    node_type node;
+    std::size_t segment;
+  };
+
+  Evaluator* m_evaluator;
+  node_type m_root;
+  SubtreeSummary<Adapter>* m_summary{nullptr};
+  bool m_started{false};
+  bool m_more{false};
+
+  // True if the top of the stack is the node last returned.
+  bool m_returned{false};
+
+  std::vector<Pending> m_stack{};
+
+  // Location steps of each entry of the stack after the first. Steps are
+  // always recorded, for cursors, but only turned into node locations if
+  // location tracking is on.
+  LocationBuilder m_location{};
+
+  Node<Adapter> m_current{};
+
+  // The cursor this range was restored from, which restored location steps
+  // refer to.
+  std::shared_ptr<const Cursor> m_cursor{};
+
+  void pop() {
+    m_stack.pop_back();
+    if (!m_location.steps().empty()) {
+      m_location.pop();
+    }
+  }
+
+  // Find the next selected node and make it current. Returns false if
+  // there are no more nodes.
+  bool next() {
+    if (m_returned) {
+      m_returned = false;
+      pop();
+    }
+
+    const auto& path{m_evaluator->m_path};
+    while (!m_stack.empty()) {
+      auto& top{m_stack.back()};
+      if (top.segment == path.size()) {
+        // Release the last node's location first, so its tree can be reused.
+        m_current = Node<Adapter>{top.node};
+        if constexpr (TRACK_LOCATIONS) {
+          if (m_evaluator->m_options.locations) {
+            m_current.location = m_location.current();
+          }
+        }
+        m_returned = true;
+        return true;
+      }
+
+      if (auto child{advance(top, path[top.segment])}) {
+        if (m_evaluator->prunable(path, child->segment, child->node)) {
+          continue;
+        }
+        m_location.push(child->step);
+        m_stack.push_back(Pending{child->node, child->segment});
+      } else {
+        pop();
+      }
+    }
+    return false;
+  }
+
+  // Return the next node produced by applying _segment_ to _pending_.
+  std::optional<Child> advance(
+      Pending& pending, const segments_t::value_type& segment) {
+    auto [selectors, descendant]{std::visit(
+        [](const auto& s) {
+          return std::pair{&s.selectors,
+              std::is_same_v<std::decay_t<decltype(s)>, RecursiveSegment>};
+        },
+        segment)};
+
+    while (pending.selector < selectors->size()) {
+      if (auto child{select((*selectors)[pending.selector], pending)}) {
+        return child;
+      }
+      pending.selector++;
+      pending.started = false;
+      pending.filter.reset();
+    }
+
+    if (descendant) {
+      if (auto child{next_child(pending)}) {
+        // The same segment applies to each descendant.
+        child->segment = pending.segment;
+        return child;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Return the next node selected by _selector_ from _pending_.
+  std::optional<Child> select(const selector_t& selector, Pending& pending) {
+    const auto node{pending.node};
+    const auto segment{pending.segment + 1};
+
+    if (auto name{std::get_if<NameSelector>(&selector)}) {
+      if (!pending.started) {
+        pending.started = true;
+        if (Adapter::kind(node) == ValueKind::object) {
+          if (auto child{Adapter::member(node, name->name)}) {
+            return Child{
+                step_t{std::string_view{name->name}}, child.value(), segment};
+          }
+        }
+      }
+      return std::nullopt;
+    }
+
+    if (auto index{std::get_if<IndexSelector>(&selector)}) {
+      if (!pending.started) {
+        pending.started = true;
+        if (Adapter::kind(node) == ValueKind::array) {
+          const auto size{static_cast<std::int64_t>(Adapter::size(node))};
+          const auto j{index->index < 0 ? index->index + size : index->index};
+          if (j >= 0 && j < size) {
+            return Child{step_t{j},
+                Adapter::element(node, static_cast<std::size_t>(j)), segment};
+          }
+        }
+      }
+      return std::nullopt;
+    }
+
+    if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+      if (!pending.started) {
+        pending.started = true;
+        SliceBounds bounds{};
+        if (Adapter::kind(node) == ValueKind::array) {
+          bounds = slice_bounds(
+              *slice, static_cast<std::int64_t>(Adapter::size(node)));
+        }
+        pending.index = bounds.start;
+        pending.stop = bounds.stop;
+        pending.step = bounds.step;
+      }
+      const SliceBounds bounds{pending.index, pending.stop, pending.step};
+      if (bounds.contains(pending.index)) {
+        const auto j{pending.index};
+        pending.index += pending.step;
+        return Child{step_t{j},
+            Adapter::element(node, static_cast<std::size_t>(j)), segment};
+      }
+      return std::nullopt;
+    }
+
+    if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+      if (!pending.filter) {
+        pending.filter = m_evaluator->prepare((*filter)->expression);
+      }
+      while (auto child{next_child(pending)}) {
+        if (m_evaluator->matches(*pending.filter, child->node)) {
+          return child;
+        }
+      }
+      return std::nullopt;
+    }
+
+    // A wildcard.
+    return next_child(pending);
+  }
+
+  // Rebuild the stack recorded by _cursor_.
+  void restore(const Cursor& cursor) {
+    const auto& path{m_evaluator->m_path};
+    if (cursor.query_hash != hash(path)) {
+      throw CursorError("cursor does not belong to this query");
+    }
+    if (cursor.done) {
+      m_started = true;
+      return;
+    }
+    if (cursor.entries.empty()) {
+      return;
+    }
+    if (cursor.location.size() + 1 != cursor.entries.size()) {
+      throw CursorError("malformed cursor");
+    }
+
+    if (cursor.entries.front().segment != 0) {
+      throw CursorError("malformed cursor");
+    }
+
+    // Filters are tested against restored nodes, which may refer to the
+    // root.
+    m_evaluator->start(m_root);
+    m_cursor = std::make_shared<const Cursor>(cursor);
+    m_location.retain(m_cursor);
+    auto node{m_root};
+    for (std::size_t k = 0; k < m_cursor->entries.size(); k++) {
+      if (k > 0) {
+        const auto& step{m_cursor->location[k - 1]};
+        node = child_at(node, step);
+        check_child(m_stack.back(), step, node, m_cursor->entries[k].segment);
+        if (auto name{std::get_if<std::string>(&step)}) {
+          m_location.push(step_t{std::string_view{*name}});
+        } else {
+          m_location.push(step_t{std::get<std::int64_t>(step)});
+        }
+      }
+
+      const auto& entry{m_cursor->entries[k]};
+      if (entry.segment > path.size() ||
+          (entry.segment == path.size() &&
+              (entry.selector != 0 || entry.started))) {
+        throw CursorError("malformed cursor");
+      }
+
+      Pending pending{node, static_cast<std::size_t>(entry.segment),
+          static_cast<std::size_t>(entry.selector), entry.started};
+      if (entry.segment < path.size()) {
+        restore_progress(pending, path[pending.segment], entry.index);
+      }
+      m_stack.push_back(std::move(pending));
+    }
+    m_returned = cursor.returned;
+  }
+
+  // Throw a CursorError unless _child_, at _step_ below _parent_'s node and
+  // pending segment _segment_, is the node _parent_'s progress says it
+  // produced last. Tokens are untrusted, and without this a forged location
+  // would resume evaluation at nodes the query never selects.
+  void check_child(Pending& parent, const path_step_t& step, node_type child,
+      std::uint64_t segment) {
+    const auto& path{m_evaluator->m_path};
+    if (!parent.started || parent.segment == path.size()) {
+      throw CursorError("malformed cursor");
+    }
+
+    const auto& [selectors, descendant]{std::visit(
+        [](const auto& s) {
+          return std::pair{&s.selectors,
+              std::is_same_v<std::decay_t<decltype(s)>, RecursiveSegment>};
+        },
+        path[parent.segment])};
+
+    bool produced{false};
+    if (parent.selector == selectors->size()) {
+      // The walk of a descendant segment's children.
+      produced = descendant && segment == parent.segment &&
+                 last_child(parent, step);
+    } else if (segment == parent.segment + 1) {
+      const auto& selector{(*selectors)[parent.selector]};
+      const auto* j{std::get_if<std::int64_t>(&step)};
+      if (auto name{std::get_if<NameSelector>(&selector)}) {
+        const auto* member{std::get_if<std::string>(&step)};
+        produced = member && *member == name->name;
+      } else if (auto index{std::get_if<IndexSelector>(&selector)}) {
+        const auto size{static_cast<std::int64_t>(Adapter::size(parent.node))};
+        produced =
+            j && *j == (index->index < 0 ? index->index + size : index->index);
+      } else if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+        // _restore_progress()_ has checked that the index before the
+        // restored one can be computed, unless it's the first.
+        const auto bounds{slice_bounds(
+            *slice, static_cast<std::int64_t>(Adapter::size(parent.node)))};
+        produced = j && parent.index != bounds.start &&
+                   *j == parent.index - parent.step;
+      } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        if (!parent.filter) {
+          parent.filter = m_evaluator->prepare((*filter)->expression);
+        }
+        produced = last_child(parent, step) &&
+                   m_evaluator->matches(*parent.filter, child);
+      } else {
+        produced = last_child(parent, step);
+      }
+    }
+
+    if (!produced) {
+      throw CursorError("cursor does not match the query");
+    }
+  }
+
+  // Return true if _step_ is the child of _pending_'s node that was visited
+  // last, before the one at its restored index.
+  static bool last_child(const Pending& pending, const path_step_t& step) {
+    if (pending.index < 1) {
+      return false;
+    }
+    if (auto j{std::get_if<std::int64_t>(&step)}) {
+      return pending.kind == ValueKind::array && *j == pending.index - 1;
+    }
+    if (pending.kind != ValueKind::object) {
+      return false;
+    }
+    auto it{Adapter::members_begin(pending.node)};
+    for (std::int64_t i = 1; i < pending.index; i++) {
+      ++it;
+    }
+    return Adapter::member_name(it) == std::get<std::string>(step);
+  }
+
+  // Return the child of _node_ at _step_, or throw a CursorError if there
+  // isn't one.
+  static node_type child_at(node_type node, const path_step_t& step) {
+    if (auto name{std::get_if<std::string>(&step)}) {
+      if (Adapter::kind(node) == ValueKind::object) {
+        if (auto child{Adapter::member(node, *name)}) {
+          return child.value();
+        }
+      }
+    } else if (Adapter::kind(node) == ValueKind::array) {
+      const auto j{std::get<std::int64_t>(step)};
+      if (j >= 0 && static_cast<std::size_t>(j) < Adapter::size(node)) {
+        return Adapter::element(node, static_cast<std::size_t>(j));
+      }
+    }
+    throw CursorError("cursor does not match the document");
+  }
+
+  // Restore the progress of _pending_ through its current selector, or its
+  // children, to _index_.
+  static void restore_progress(Pending& pending,
+      const segments_t::value_type& segment, std::int64_t index) {
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+    if (pending.selector > selectors.size()) {
+      throw CursorError("malformed cursor");
+    }
+    if (!pending.started) {
+      return;
+    }
+
+    const auto node{pending.node};
+    if (pending.selector < selectors.size()) {
+      const auto& selector{selectors[pending.selector]};
+      if (std::holds_alternative<NameSelector>(selector) ||
+          std::holds_alternative<IndexSelector>(selector)) {
+        return;
+      }
+
+      if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+        SliceBounds bounds{};
+        if (Adapter::kind(node) == ValueKind::array) {
+          bounds = slice_bounds(
+              *slice, static_cast<std::int64_t>(Adapter::size(node)));
+        }
+        // _index_ must be one of the slice's indices, or the one after.
+        // Tokens are untrusted, so _index_ is checked against the slice's
+        // bounds before any arithmetic that could overflow. Distances are
+        // unsigned, and the index before _index_ lies between the start
+        // and _index_, so computing it can't overflow.
+        const auto magnitude{bounds.step < 0
+                                 ? std::uint64_t{0} -
+                                       static_cast<std::uint64_t>(bounds.step)
+                                 : static_cast<std::uint64_t>(bounds.step)};
+        const auto lower{std::min(bounds.start, bounds.stop)};
+        const auto upper{std::max(bounds.start, bounds.stop)};
+        if ((index < lower && static_cast<std::uint64_t>(lower) -
+                                      static_cast<std::uint64_t>(index) >
+                                  magnitude) ||
+            (index > upper && static_cast<std::uint64_t>(index) -
+                                      static_cast<std::uint64_t>(upper) >
+                                  magnitude) ||
+            (bounds.step > 0 ? index < bounds.start : index > bounds.start)) {
+          throw CursorError("cursor does not match the document");
+        }
+
+        const auto distance{bounds.step > 0
+                                ? static_cast<std::uint64_t>(index) -
+                                      static_cast<std::uint64_t>(bounds.start)
+                                : static_cast<std::uint64_t>(bounds.start) -
+                                      static_cast<std::uint64_t>(index)};
+        if (distance % magnitude != 0 ||
+            (distance != 0 && !bounds.contains(index - bounds.step))) {
+          throw CursorError("cursor does not match the document");
+        }
+        pending.index = index;
+        pending.stop = bounds.stop;
+        pending.step = bounds.step;
+        return;
+      }
+    }
+
+    // Children of a wildcard, a filter or a descendant segment.
+    pending.kind = Adapter::kind(node);
+    const auto size{pending.kind == ValueKind::array ||
+                            pending.kind == ValueKind::object
+                        ? static_cast<std::int64_t>(Adapter::size(node))
+                        : std::int64_t{0}};
+    if (index < 0 || index > size) {
+      throw CursorError("cursor does not match the document");
+    }
+    pending.index = index;
+    if (pending.kind == ValueKind::array) {
+      pending.stop = size;
+    } else if (pending.kind == ValueKind::object) {
+      pending.member = Adapter::members_begin(node);
+      for (std::int64_t i = 0; i < index; i++) {
+        ++pending.member;
+      }
+    }
+  }
+
+  // Return the next child of _pending_'s node, in document order, for the
+  // next segment.
+  static std::optional<Child> next_child(Pending& pending) {
+    const auto node{pending.node};
+    if (!pending.started) {
+      pending.started = true;
+      pending.kind = Adapter::kind(node);
+      pending.index = 0;
+      if (pending.kind == ValueKind::array) {
+        pending.stop = static_cast<std::int64_t>(Adapter::size(node));
+      } else if (pending.kind == ValueKind::object) {
+        pending.member = Adapter::members_begin(node);
+      }
+    }
+
+    if (pending.kind == ValueKind::array && pending.index < pending.stop) {
+      const auto j{pending.index++};
+      return Child{step_t{j},
+          Adapter::element(node, static_cast<std::size_t>(j)),
+          pending.segment + 1};
+    }
+
+    if (pending.kind == ValueKind::object &&
+        pending.member != Adapter::members_end(node)) {
+      pending.index++;
+      const auto it{pending.member++};
+      return Child{step_t{Adapter::member_name(it)}, Adapter::member_value(it),
+          pending.segment + 1};
+    }
+
+    return std::nullopt;
+  }
+};
+
+// Return the nodes selected by _path_ from the document rooted at _root_.
+template <typename Adapter>
+nodelist_t<Adapter> find(
+    const segments_t& path, typename Adapter::node_type root) {
+  return Evaluator<Adapter>{path}.find(root);
+}
+
+// Return the number of nodes selected by _path_ from the document rooted at
+// _root_, without collecting them.
+template <typename Adapter>
+std::size_t count(const segments_t& path, typename Adapter::node_type root) {
+  return Evaluator<Adapter>{path, {true, false}}.count(root);
+}
+
+// Return true if _path_ selects at least one node from the document rooted
+// at _root_.
+template <typename Adapter>
+bool exists(const segments_t& path, typename Adapter::node_type root) {
+  return Evaluator<Adapter>{path, {true, false}}.exists(root);
+}
+
+// Parse _query_ and return the nodes it selects from the document rooted at
+// _root_.
+template <typename Adapter>
+nodelist_t<Adapter> find(
+    std::string_view query, typename Adapter::node_type root) {
+  // Locations refer to names in the query, so it must outlive the nodes.
+  return Evaluator<Adapter>{std::make_shared<const segments_t>(parse(query))}
+      .find(root);
+}
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_FIND_H
@@ -0,0 +1,83 @@
+#ifndef LIBJSONPATH_FOOTPRINT_H
+#define LIBJSONPATH_FOOTPRINT_H
+
+#include "libjsonpath/selectors.hpp" // segments_t
+#include <cstddef>                   // std::size_t
+#include <map>                       // std::map
+#include <optional>                  // std::optional
+#include <set>                       // std::set
+#include <string>                    // std::string
+#include <vector>                    // std::vector
+
+namespace libjsonpath {
+
+// The parts of a document a query can touch, as a prefix tree of member
+// names. Each node of the tree stands for a set of document nodes, starting
+// with the document root.
+//
+// Nodes are stored in a flat array and refer to their children by index.
+// The root of the tree is node 0.
+class KeyFootprint {
+public:
+  struct Node {
+    // Children reached by a specific member name.
+    std::map<std::string, std::size_t> names{};
+
+    // The child reached by any member name or array index, from a wildcard,
+    // index, slice or filter selector.
+    std::optional<std::size_t> any_key{};
+
+    // A footprint that applies to this node and every one of its
+    // descendants, at any depth, from a descendant segment.
+    std::optional<std::size_t> any_depth{};
+
+    // True if the whole value at this node is needed, because it's selected
+    // by the query or its value is used in a filter.
+    bool whole{false};
+  };
+
+  KeyFootprint() : m_nodes(1){};
+
+  const Node& root() const noexcept { return m_nodes.front(); }
+  const Node& node(std::size_t index) const { return m_nodes.at(index); }
+  std::size_t size() const noexcept { return m_nodes.size(); }
+
+  // True if any node has an _any_key_ or _any_depth_ child, in which case
+  // member names that are not in the tree may be accessed.
+  bool has_any_key() const noexcept;
+  bool has_any_depth() const noexcept;
+
+  // Return every member name in the tree.
+  std::set<std::string> names() const;
+
+  // Return a compact representation of the tree, like
+  // `{'items': {*: {'price': !}}}`, where `*` is any key, `..` is any depth
+  // and `!` marks a node whose whole value is needed.
+  std::string to_string() const;
+
+  // Return the index of the child of _parent_ for _name_, adding it if it
+  // doesn't exist. Likewise for _any_key_ and _any_depth_ children.
+  std::size_t add_name(std::size_t parent, const std::string& name);
+  std::size_t add_any_key(std::size_t parent);
+  std::size_t add_any_depth(std::size_t parent);
+
+  void set_whole(std::size_t index) { m_nodes.at(index).whole = true; }
+
+private:
+  std::vector<Node> m_nodes;
+
+  std::size_t add_node();
+  void write(std::size_t index, std::string& out) const;
+};
+
+// Return the footprint of _path_, including member names used by filters,
+// nested filter queries and function arguments.
+KeyFootprint key_footprint(const segments_t& path);
+
+// Add the footprint of _path_ to _footprint_, so one footprint can cover
+// many queries.
+void add_footprint(KeyFootprint& footprint, const segments_t& path);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_FOOTPRINT_H
@@ -0,0 +1,32 @@
+#ifndef LIBJSONPATH_HASH_H
+#define LIBJSONPATH_HASH_H
+
+#include "libjsonpath/selectors.hpp"
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t std::uint32_t
+
+namespace libjsonpath {
+
+// The version of the structural hash algorithm. Hashes are stable across
+// processes and platforms, and will only change if this number changes, so
+// it is safe to persist them alongside HASH_VERSION.
+inline constexpr std::uint32_t HASH_VERSION{2};
+
+// Return a 64-bit hash of a sequence of JSONPath segments, computed by walking
+// the parse tree rather than serializing it. Token positions and shorthand
+// flags are ignored, so `$.a` and `$['a']` hash the same.
+std::uint64_t hash(const segments_t& path);
+std::uint64_t hash(const selector_t& selector);
+std::uint64_t hash(const expression_t& expression);
+
+// A hash function object for using parsed queries as keys in unordered
+// containers.
+struct SegmentsHash {
+  std::size_t operator()(const segments_t& path) const {
+    return static_cast<std::size_t>(hash(path));
+  }
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_HASH_H
@@ -0,0 +1,145 @@
+#ifndef LIBJSONPATH_INDEX_H
+#define LIBJSONPATH_INDEX_H
+
+#include "libjsonpath/document.hpp" // ValueKind
+#include "libjsonpath/location.hpp" // LocationTree Location
+#include <cstddef>                  // std::size_t
+#include <cstdint>                  // std::int64_t std::uint32_t
+#include <memory>                   // std::shared_ptr std::make_shared
+#include <string_view>              // std::string_view
+#include <unordered_map>            // std::unordered_map
+#include <vector>                   // std::vector
+
+namespace libjsonpath {
+
+// An index of the member names in a document, for answering queries that
+// start with a descendant segment of name selectors, like `$..price` or
+// `$..['a', 'b']`, without walking the whole document. See
+// _Evaluator::find(const KeyIndex&)_.
+//
+// For each member name, the index holds a posting for every object with a
+// member of that name, in the order a walk of the document would visit
+// those objects. Objects and arrays are numbered in that order, and their
+// locations are kept in a LocationTree so the locations of selected nodes
+// can be rebuilt.
+//
+// Build an index once per document and reuse it for any number of queries.
+// Names and nodes refer to the document, which must outlive the index and
+// must not change while it's in use.
+template <typename Adapter> class KeyIndex {
+public:
+  using node_type = typename Adapter::node_type;
+
+  // A member of an object. _parent_ is the object's number, which is also
+  // its entry in _locations()_, or LocationTree::ROOT for the root node.
+  struct Posting {
+    std::uint32_t parent;
+    node_type node;
+  };
+
+  explicit KeyIndex(node_type root)
+      : m_root{root}, m_locations{std::make_shared<LocationTree>()} {
+    build();
+  };
+
+  node_type root() const noexcept { return m_root; }
+
+  // Return postings for members called _name_, or an empty list if there
+  // are none. Where an object has more than one member called _name_, only
+  // the first is included, as selected by a name selector.
+  const std::vector<Posting>& postings(std::string_view name) const {
+    static const std::vector<Posting> empty{};
+    auto it{m_postings.find(name)};
+    return it == m_postings.end() ? empty : it->second;
+  }
+
+  // Return the location of object or array number _container_.
+  Location location(std::uint32_t container) const {
+    return Location{m_locations, container};
+  }
+
+  // The number of objects and arrays below the root node.
+  std::size_t containers() const noexcept { return m_locations->size(); }
+
+  // Return an estimate of the memory used by this index, in bytes.
+  std::size_t memory_usage() const noexcept {
+    // Each node of an unordered_map holds a key, a value and a next pointer,
+    // and each bucket a pointer.
+    std::size_t rv{sizeof(*this) + sizeof(LocationTree) +
+                   m_locations->size() * sizeof(LocationTree::Entry) +
+                   m_postings.bucket_count() * sizeof(void*)};
+    for (const auto& [_, postings] : m_postings) {
+      rv += sizeof(std::string_view) + sizeof(postings) + sizeof(void*) +
+            postings.capacity() * sizeof(Posting);
+    }
+    return rv;
+  }
+
+private:
+  node_type m_root;
+  std::shared_ptr<LocationTree> m_locations;
+  std::unordered_map<std::string_view, std::vector<Posting>> m_postings{};
+
+  // Walk the document in the same order as the query evaluator, with an
+  // explicit stack so deeply nested documents don't overflow the call stack.
+  void build() {
+    struct Pending {
+      node_type node;
+      std::uint32_t parent;
+      location_step_t step;
+    };
+
+    std::vector<Pending> stack{{m_root, LocationTree::ROOT, {}}};
+    std::vector<Pending> children{};
+    bool root{true};
+
+    while (!stack.empty()) {
+      const auto pending{stack.back()};
+      stack.pop_back();
+
+      const auto number{root ? LocationTree::ROOT
+                             : m_locations->add(pending.parent, pending.step)};
+      root = false;
+
+      const auto node{pending.node};
+      const auto kind{Adapter::kind(node)};
+      children.clear();
+
+      if (kind == ValueKind::object) {
+        const auto end{Adapter::members_end(node)};
+        for (auto it{Adapter::members_begin(node)}; it != end; ++it) {
+          const auto name{Adapter::member_name(it)};
+          const auto child{Adapter::member_value(it)};
+          auto& postings{m_postings[name]};
+          if (postings.empty() || postings.back().parent != number) {
+            postings.push_back(Posting{number, child});
+          }
+          if (is_container(child)) {
+            children.push_back(Pending{child, number, name});
+          }
+        }
+      } else if (kind == ValueKind::array) {
+        const auto size{Adapter::size(node)};
+        for (std::size_t j = 0; j < size; j++) {
+          const auto child{Adapter::element(node, j)};
+          if (is_container(child)) {
+            children.push_back(
+                Pending{child, number, static_cast<std::int64_t>(j)});
+          }
+        }
+      }
+
+      // Children are visited in document order.
+      stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+  }
+
+  static bool is_container(node_type node) {
+    const auto kind{Adapter::kind(node)};
+    return kind == ValueKind::object || kind == ValueKind::array;
+  }
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_INDEX_H
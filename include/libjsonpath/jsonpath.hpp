@@ -4,6 +4,7 @@
 #include "libjsonpath/config.hpp"
 #include "libjsonpath/parse.hpp"
 #include "libjsonpath/selectors.hpp"
+#include <cstddef> // std::size_t
 #include <string>
 #include <string_view>
 
@@ -25,6 +26,76 @@ segments_t parse(std::string_view s,
 // Return a canonical string representation of a sequence of JSONPath segments.
 std::string to_string(const segments_t& path);
 
+// Write the canonical string representation of _path_ to _buffer_, replacing
+// its contents. The length of the output is computed before anything is
+// written, so _buffer_ is resized at most once, and a buffer that is reused
+// between calls stops allocating once it has grown large enough.
+void to_string(const segments_t& path, std::string& buffer);
+
+// Write the canonical string representation of _path_ to the character array
+// starting at _buffer_, writing at most _size_ characters and no null
+// terminator. Returns the length of the canonical representation, which will
+// be greater than _size_ if the output was truncated. Pass a _size_ of zero
+// to compute the length without writing anything.
+std::size_t to_string(const segments_t& path, char* buffer, std::size_t size);
+
+// Return the length of the canonical string representation of _path_.
+std::size_t to_string_length(const segments_t& path);
+
+// A character sink for the canonical serializer. Output is written to a
+// caller-provided character array, discarding anything that does not fit,
+// while _length()_ keeps counting every character, so the same code path is
+// used to both size and fill a buffer.
+class CanonicalWriter {
+public:
+  CanonicalWriter() = default;
+  CanonicalWriter(char* buffer, std::size_t size)
+      : m_buffer{buffer}, m_size{size} {};
+
+  // The number of characters written so far, including those that did not
+  // fit in the buffer.
+  std::size_t length() const noexcept { return m_length; };
+
+  void put(char ch) noexcept;
+  void write(std::string_view sv) noexcept;
+
+  void write(const segments_t& path);
+  void write(const selector_t& selector);
+  void write(const expression_t& expression);
+
+  // Write _name_ as a single quoted, escaped name selector.
+  void write_name(std::string_view name);
+
+  // Write _value_ as a double quoted, escaped string literal.
+  void write_string(std::string_view value);
+
+  void write_int(std::int64_t value);
+
+  // Write the shortest representation of _value_ that round trips.
+  void write_float(double value);
+
+private:
+  char* m_buffer{nullptr};
+  std::size_t m_size{0};
+  std::size_t m_length{0};
+
+  // Write _value_ surrounded by _quote_, escaping _quote_, backslashes and
+  // control characters as per RFC 9535 normalized paths.
+  void write_quoted(std::string_view value, char quote);
+};
+
+// Return the output of _write_, a callable taking a CanonicalWriter&. It is
+// called twice, once to measure the output and again to fill a string of
+// exactly that length.
+template <typename F> std::string write_to_string(F write) {
+  CanonicalWriter sizer{};
+  write(sizer);
+  std::string rv(sizer.length(), '\0');
+  CanonicalWriter writer{rv.data(), rv.size()};
+  write(writer);
+  return rv;
+}
+
 // A _selector_t_ visitor returning a string representation of the the selector
 // held by the variant. Each _operator()_ overload returns the canonical
 // representation of the selector, replacing shorthand selectors with their
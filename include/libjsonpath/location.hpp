@@ -0,0 +1,143 @@
+#ifndef LIBJSONPATH_LOCATION_H
+#define LIBJSONPATH_LOCATION_H
+
+#include "libjsonpath/pointer.hpp" // path_step_t
+#include <cstddef>                 // std::size_t
+#include <cstdint>                 // std::int64_t std::uint32_t
+#include <memory>                  // std::shared_ptr
+#include <string>                  // std::string
+#include <string_view>             // std::string_view
+#include <variant>                 // std::variant
+#include <vector>                  // std::vector
+
+namespace libjsonpath {
+
+// Define LIBJSONPATH_NO_LOCATIONS, or configure with
+// -DLIBJSONPATH_LOCATIONS=OFF, to compile location tracking out of the
+// evaluator entirely.
+#ifdef LIBJSONPATH_NO_LOCATIONS
+inline constexpr bool TRACK_LOCATIONS{false};
+#else
+inline constexpr bool TRACK_LOCATIONS{true};
+#endif
+
+// One step of a node's location, a member name or an array index. Names are
+// views of member names in the document, or of names in the query.
+using location_step_t = std::variant<std::string_view, std::int64_t>;
+
+// The locations of nodes selected by an evaluation, stored as a tree of
+// steps where each entry refers to its parent. Nodes with a common ancestor
+// share the entries leading to it, so recording a location costs at most
+// one entry per step that isn't already shared, and nothing is rendered
+// until it's asked for.
+class LocationTree {
+public:
+  // The parent of entries for children of the root node.
+  static constexpr std::uint32_t ROOT{0xFFFFFFFF};
+
+  struct Entry {
+    std::uint32_t parent{ROOT};
+    location_step_t step{};
+  };
+
+  // Add an entry for _step_ below _parent_ and return its index.
+  std::uint32_t add(std::uint32_t parent, location_step_t step) {
+    m_entries.push_back(Entry{parent, step});
+    return static_cast<std::uint32_t>(m_entries.size() - 1);
+  }
+
+  const Entry& operator[](std::uint32_t index) const {
+    return m_entries[index];
+  }
+
+  std::size_t size() const noexcept { return m_entries.size(); }
+  void clear() noexcept { m_entries.clear(); }
+
+  // Objects that names in this tree refer to, kept alive for as long as the
+  // tree is.
+  std::vector<std::shared_ptr<const void>> owners{};
+
+private:
+  std::vector<Entry> m_entries{};
+};
+
+// The location of a node, as an entry in a shared LocationTree. Locations
+// are cheap to copy, and keep their tree alive.
+//
+// A default constructed location is not tracked. It's what nodes get when
+// location tracking is turned off, and it renders as an empty string.
+class Location {
+public:
+  Location() = default;
+  Location(std::shared_ptr<const LocationTree> tree, std::uint32_t index)
+      : m_tree{std::move(tree)}, m_index{index} {};
+
+  bool tracked() const noexcept { return m_tree != nullptr; }
+
+  // The number of steps from the root node to this location.
+  std::size_t depth() const;
+
+  // Return the steps of this location, from the root node down.
+  std::vector<location_step_t> steps() const;
+
+  // Return this location as an RFC 9535 normalized path, like `$['a'][0]`.
+  // Names are escaped just like name selectors are by
+  // SelectorToStringVisitor.
+  std::string path() const;
+
+  // Return this location as an RFC 6901 JSON Pointer, like `/a/0`.
+  std::string to_json_pointer() const;
+
+  // Return a copy of this location's steps that doesn't refer to the
+  // document or query.
+  std::vector<path_step_t> to_path_steps() const;
+
+private:
+  std::shared_ptr<const LocationTree> m_tree{};
+  std::uint32_t m_index{LocationTree::ROOT};
+};
+
+// Records the location of the node an evaluation is visiting, as steps are
+// pushed and popped, and turns it into a Location when a node is selected.
+// Only the steps of selected nodes are added to the tree.
+class LocationBuilder {
+public:
+  void push(location_step_t step) { m_steps.push_back(step); }
+
+  void pop() {
+    m_steps.pop_back();
+    if (m_shared > m_steps.size()) {
+      m_shared = m_steps.size();
+    }
+  }
+
+  const std::vector<location_step_t>& steps() const noexcept {
+    return m_steps;
+  }
+
+  // Return the location of the current node. Entries are added to the tree
+  // for steps that don't have one yet. If nothing else refers to the tree,
+  // because the caller dropped earlier locations, it's cleared first, so a
+  // long lazy evaluation doesn't accumulate entries.
+  Location current();
+
+  // Keep _owner_ alive for as long as any location from this builder. Null
+  // owners are ignored.
+  void retain(std::shared_ptr<const void> owner);
+
+  // Start again at the root node, with a new tree.
+  void reset();
+
+private:
+  std::shared_ptr<LocationTree> m_tree{};
+  std::vector<std::shared_ptr<const void>> m_owners{};
+  std::vector<location_step_t> m_steps{};
+
+  // Tree entries for the first _m_shared_ steps.
+  std::vector<std::uint32_t> m_entries{};
+  std::size_t m_shared{0};
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_LOCATION_H
@@ -0,0 +1,100 @@
+#ifndef LIBJSONPATH_NLOHMANN_H
+#define LIBJSONPATH_NLOHMANN_H
+
+#include "libjsonpath/document.hpp" // ValueKind
+#include <cstddef>                  // std::size_t
+#include <cstdint>                  // std::int64_t
+#include <limits>                   // std::numeric_limits
+#include <nlohmann/json.hpp>        // nlohmann::json
+#include <optional>                 // std::optional
+#include <string_view>              // std::string_view
+
+namespace libjsonpath {
+
+// A document adapter for nlohmann/json, or any other instantiation of
+// nlohmann::basic_json. See libjsonpath/document.hpp.
+//
+// This header is only usable if nlohmann/json is available. libjsonpath does
+// not depend on it otherwise.
+template <typename Json = nlohmann::json> struct BasicNlohmannAdapter {
+  using node_type = const Json*;
+  using member_iterator = typename Json::const_iterator;
+
+  static ValueKind kind(node_type node) noexcept {
+    switch (node->type()) {
+    case nlohmann::json::value_t::null:
+    case nlohmann::json::value_t::discarded:
+      return ValueKind::null_;
+    case nlohmann::json::value_t::boolean:
+      return ValueKind::boolean;
+    case nlohmann::json::value_t::number_integer:
+      return ValueKind::integer;
+    case nlohmann::json::value_t::number_unsigned:
+      // Unsigned integers that don't fit in a std::int64_t are floats.
+      return node->template get<std::uint64_t>() >
+                     static_cast<std::uint64_t>(
+                         std::numeric_limits<std::int64_t>::max())
+                 ? ValueKind::float_
+                 : ValueKind::integer;
+    case nlohmann::json::value_t::number_float:
+      return ValueKind::float_;
+    case nlohmann::json::value_t::string:
+      return ValueKind::string;
+    case nlohmann::json::value_t::array:
+      return ValueKind::array;
+    default:
+      return ValueKind::object;
+    }
+  }
+
+  static std::size_t size(node_type node) { return node->size(); }
+
+  static node_type element(node_type node, std::size_t index) {
+    return &(*node)[index];
+  }
+
+  static std::optional<node_type> member(
+      node_type node, std::string_view name) {
+    auto it{node->find(name)};
+    if (it == node->end()) {
+      return std::nullopt;
+    }
+    return &*it;
+  }
+
+  static member_iterator members_begin(node_type node) {
+    return node->cbegin();
+  }
+
+  static member_iterator members_end(node_type node) { return node->cend(); }
+
+  static std::string_view member_name(const member_iterator& it) {
+    return it.key();
+  }
+
+  static node_type member_value(const member_iterator& it) {
+    return &it.value();
+  }
+
+  static bool boolean_value(node_type node) {
+    return node->template get<bool>();
+  }
+
+  static std::int64_t integer_value(node_type node) {
+    return node->template get<std::int64_t>();
+  }
+
+  static double float_value(node_type node) {
+    return node->template get<double>();
+  }
+
+  static std::string_view string_value(node_type node) {
+    return node->template get_ref<const typename Json::string_t&>();
+  }
+};
+
+using NlohmannAdapter = BasicNlohmannAdapter<>;
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_NLOHMANN_H
@@ -0,0 +1,141 @@
+#ifndef LIBJSONPATH_OPTIMIZE_H
+#define LIBJSONPATH_OPTIMIZE_H
+
+#include "libjsonpath/selectors.hpp"
+#include <cstddef> // std::size_t
+#include <cstdint>       // std::uint64_t
+#include <optional>      // std::optional
+#include <string_view>   // std::string_view
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
+
+namespace libjsonpath {
+
+// The result of simplifying a filter expression.
+struct Simplified {
+  expression_t expression;
+  std::size_t nodes_removed{0};
+};
+
+// Return a simplified copy of the logical filter expression _expression_,
+// along with the number of expression nodes removed. Simplification
+// preserves RFC 9535 semantics, including those of existence tests.
+//
+//  - Comparisons between literals are folded to `true` or `false`.
+//  - Comparisons between structurally identical operands are folded, as two
+//    identical singular queries or function calls always produce the same
+//    value, or Nothing.
+//  - `true && x`, `false || x`, `x && x` and `x || x` become `x`.
+//  - `false && x` becomes `false` and `true || x` becomes `true`, pruning the
+//    dead branch.
+//  - `!true`, `!false` and `!!x` are folded.
+//  - Chains of `&&` with contradictory comparisons against literals, like
+//    `@.a > 5 && @.a < 3`, become `false`. See _find_ranges()_.
+//
+// Filter expressions of nested filter queries are simplified too. Function
+// arguments are left alone, except for filters in queries they contain, as
+// an argument's type must not change.
+Simplified simplify(const expression_t& expression);
+
+// Simplify every filter expression in _path_, in place, returning the total
+// number of expression nodes removed.
+std::size_t simplify(segments_t& path);
+
+// Return the number of filter expression nodes in _expression_, including
+// those in nested filter queries.
+std::size_t count_nodes(const expression_t& expression);
+
+// Return the estimated relative cost of evaluating _expression_ once, for a
+// single candidate node. Literals are cheapest, followed by singular queries,
+// non-singular queries and descendant queries, with regular expression
+// functions, `match()` and `search()`, costing more again. Costs only mean
+// something relative to one another.
+std::uint64_t evaluation_cost(const expression_t& expression);
+
+// Reorder the operands of every chain of `&&` or `||` in _path_'s filters,
+// cheapest first according to _evaluation_cost()_, so cheap operands get the
+// chance to short-circuit expensive ones. Logical operators have no side
+// effects, so this doesn't change which nodes are selected. Operands of equal
+// cost keep their relative order. Returns the number of chains that changed.
+std::size_t reorder(segments_t& path);
+
+// Options controlling _optimize()_.
+struct OptimizeOptions {
+  // Simplify filter expressions with _simplify()_.
+  bool simplify{true};
+
+  // Allow operands of `&&` and `||` to be reordered with _reorder()_. Turn
+  // this off to keep operands in source order, for example when a custom
+  // function extension relies on evaluation order.
+  bool reorder{true};
+};
+
+// Counts of the changes made by _optimize()_.
+struct OptimizeStats {
+  std::size_t nodes_removed{0};
+  std::size_t chains_reordered{0};
+};
+
+// Optimize every filter expression in _path_, in place, according to
+// _options_.
+OptimizeStats optimize(segments_t& path, const OptimizeOptions& options = {});
+
+// Return true if the value of _expression_ does not depend on the current
+// node, so it's the same for every candidate node of a filter. Literals and
+// root queries are invariant, as are logical expressions, comparisons and
+// function calls whose operands or arguments are all invariant. Function
+// extensions are assumed to be pure.
+bool is_invariant(const expression_t& expression);
+
+// Return pointers to the outermost non-literal invariant subexpressions of
+// every filter in _path_, including filters nested in relative queries, in
+// the order they appear in the query. An evaluator can compute each of these
+// once per evaluation, rather than once per candidate node, and look them up
+// by address.
+//
+// The returned pointers refer to nodes in _path_, so they are invalidated by
+// anything that changes or moves _path_.
+std::vector<const expression_t*> find_invariants(const segments_t& path);
+
+// Return the names of members that every node selected by a filter with the
+// logical expression _expression_ must have, in the order they appear, so
+// any subtree without objects that have them can be skipped. Existence
+// tests like `@.a` and `@.a.b`, and comparisons between singular queries
+// like `@.a` and literals, other than with `!=`, require _a_. Both operands
+// of `&&` contribute names. Anything else, including `||` and `!`, requires
+// nothing.
+//
+// The returned names refer to _expression_.
+std::vector<std::string_view> required_names(const expression_t& expression);
+
+// A query or function call that appears more than once in a filter.
+struct CommonSubexpression {
+  // Every occurrence of the subexpression, in the order they appear.
+  std::vector<const expression_t*> occurrences{};
+};
+
+// Shared slots for repeated subexpressions of a filter expression. Each
+// merged subexpression gets a slot, numbered from zero in order of first
+// appearance, and each occurrence maps to its slot, so an evaluator can
+// compute a subexpression once per candidate node and reuse the result.
+struct CommonSubexpressions {
+  // Merged subexpressions, indexed by slot.
+  std::vector<CommonSubexpression> merged{};
+
+  // The slot of each occurrence of a merged subexpression.
+  std::unordered_map<const expression_t*, std::size_t> slots{};
+
+  // Return the slot for _expression_, or nothing if it was not merged.
+  std::optional<std::size_t> slot(const expression_t& expression) const;
+};
+
+// Find structurally identical relative queries, root queries and function
+// calls in the filter expression _expression_ and assign them shared slots.
+// Filters nested in queries are not searched, as their current node differs
+// from that of _expression_. As with _find_invariants()_, the result refers
+// to nodes in _expression_ by address.
+CommonSubexpressions find_common_subexpressions(const expression_t& expression);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_OPTIMIZE_H
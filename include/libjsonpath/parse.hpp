@@ -94,6 +94,11 @@ public:
   segments_t parse(const Tokens& tokens) const;
   segments_t parse(std::string_view s) const;
 
+  // Throw a TypeError, NameError or SyntaxError if _path_ fails any of the
+  // checks done while parsing. This is for segments that were built some
+  // other way, like those loaded from a binary encoded query.
+  void check(const segments_t& path) const;
+
 protected:
   function_signature_map m_function_extensions;
   segments_t parse_path(TokenIterator& tokens) const;
@@ -146,6 +151,12 @@ protected:
   // if _expr_ is a function returning a non ValueType result.
   void throw_for_non_comparable(const expression_t& expr) const;
 
+  // Throw a TypeError if _expr_ can't be used where a LogicalType is
+  // expected, like a filter or an operand of `&&`, `||` or `!`. That is,
+  // if it's a literal other than `true` or `false`, or a function returning
+  // a ValueType result.
+  void throw_for_non_logical(const expression_t& expr) const;
+
 private:
   // Convert a Token's value to an int. It is assumed that the view is
   // composed of digits with the possibility of a leading minus sign, as
@@ -169,6 +180,9 @@ private:
   // Return the unicode code point _code_point_ encoded in UTF-8.
   std::string encode_utf8(std::int32_t code_point, const Token& token) const;
 
+  // The checks done by _check()_ for a filter expression and its children.
+  void check_expression(const expression_t& expr) const;
+
   // Return the result type for the function extension named _name_.
   // Throws a TypeError if _name_ does not exist in function_extensions.
   ExpressionType function_result_type(std::string name, const Token& t) const;
@@ -0,0 +1,93 @@
+#ifndef LIBJSONPATH_POINTER_H
+#define LIBJSONPATH_POINTER_H
+
+#include "libjsonpath/document.hpp"  // ValueKind
+#include "libjsonpath/selectors.hpp" // segments_t
+#include <cstddef>                   // std::size_t
+#include <cstdint>                   // std::int64_t
+#include <optional>                  // std::optional
+#include <string>                    // std::string
+#include <string_view>               // std::string_view
+#include <utility>                   // std::move
+#include <variant>                   // std::variant std::get_if
+#include <vector>                    // std::vector
+
+namespace libjsonpath {
+
+// One step of a singular query, either a member name or an array index.
+using path_step_t = std::variant<std::string, std::int64_t>;
+
+// A singular query compiled to a plain sequence of member names and array
+// indices. Resolving a singular path against a document takes one member
+// lookup or element access per step, without any of the general query
+// machinery.
+class SingularPath {
+public:
+  SingularPath() = default;
+  SingularPath(std::vector<path_step_t> steps) : m_steps{std::move(steps)} {};
+
+  const std::vector<path_step_t>& steps() const noexcept { return m_steps; };
+
+  // Return an RFC 6901 JSON Pointer equivalent to this path. Throws an
+  // IndexError if the path contains a negative array index, which can't be
+  // represented as a JSON Pointer.
+  std::string to_json_pointer() const;
+
+  // Return the node at this path in the document rooted at _root_, or an
+  // empty optional if there is no such node. See libjsonpath/document.hpp for
+  // a description of document adapters.
+  template <typename Adapter>
+  std::optional<typename Adapter::node_type> find(
+      typename Adapter::node_type root) const {
+    auto node{root};
+    for (const auto& step : m_steps) {
+      if (const auto* name = std::get_if<std::string>(&step)) {
+        if (Adapter::kind(node) != ValueKind::object) {
+          return std::nullopt;
+        }
+        auto child{Adapter::member(node, *name)};
+        if (!child) {
+          return std::nullopt;
+        }
+        node = *child;
+      } else {
+        if (Adapter::kind(node) != ValueKind::array) {
+          return std::nullopt;
+        }
+        const auto size{static_cast<std::int64_t>(Adapter::size(node))};
+        auto index{std::get<std::int64_t>(step)};
+        if (index < 0) {
+          index += size;
+        }
+        if (index < 0 || index >= size) {
+          return std::nullopt;
+        }
+        node = Adapter::element(node, static_cast<std::size_t>(index));
+      }
+    }
+    return node;
+  }
+
+private:
+  std::vector<path_step_t> m_steps{};
+};
+
+// Return the SingularPath equivalent of _segments_, or an empty optional if
+// _segments_ is not a singular query.
+std::optional<SingularPath> compile_singular_query(const segments_t& segments);
+
+// Return an RFC 6901 JSON Pointer equivalent to the singular query
+// _segments_. Throws a TypeError if _segments_ is not a singular query, or an
+// IndexError if it contains a negative array index.
+std::string to_json_pointer(const segments_t& segments);
+
+// Return the RFC 9535 normalized path for a node at _location_, like
+// `$['a'][0]`. Indices in _location_ must not be negative. Names can also be
+// views, as they are in a node's Location.
+std::string to_normalized_path(const std::vector<path_step_t>& location);
+std::string to_normalized_path(
+    const std::vector<std::variant<std::string_view, std::int64_t>>& location);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_POINTER_H
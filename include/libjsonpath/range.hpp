@@ -0,0 +1,70 @@
+#ifndef LIBJSONPATH_RANGE_H
+#define LIBJSONPATH_RANGE_H
+
+#include "libjsonpath/selectors.hpp"
+#include <optional> // std::optional
+#include <vector>   // std::vector
+
+namespace libjsonpath {
+
+// Return true if _expression_ is a null, boolean, number or string literal.
+bool is_literal(const expression_t& expression);
+
+// Compare two literals with the comparison operator _op_, following section
+// 2.3.5.2.2 of RFC 9535. Returns nothing if either operand is not a literal
+// or _op_ is not a comparison operator.
+std::optional<bool> compare_literals(
+    const expression_t& left, BinaryOperator op, const expression_t& right);
+
+// One end of a range. _value_ is an integer, float or string literal.
+struct RangeBound {
+  expression_t value{};
+  bool inclusive{};
+};
+
+// The set of values a singular query can take for a conjunction of
+// comparisons between that query and literals to be true, expressed as one
+// equality, interval or exclusion set check. For example,
+// `@.ts >= 1000 && @.ts < 2000 && @.ts != 1500` is the interval [1000, 2000)
+// excluding 1500.
+//
+// A range is normalized: an equality replaces any bounds and exclusions,
+// bounds are both numbers or both strings, and exclusions outside the bounds
+// are dropped.
+struct RangePredicate {
+  // The first occurrence of the singular query being compared.
+  const expression_t* query{nullptr};
+
+  // The comparisons making up this predicate, in the order they appear.
+  std::vector<const expression_t*> comparisons{};
+
+  std::optional<expression_t> equal{};
+  std::optional<RangeBound> lower{};
+  std::optional<RangeBound> upper{};
+  std::vector<expression_t> excluded{};
+
+  // True if the comparisons contradict one another, so the conjunction is
+  // always false.
+  bool empty{false};
+
+  // Return true if the query's value being the literal _value_ satisfies
+  // every comparison.
+  bool contains(const expression_t& value) const;
+
+  // Return true if the query selecting nothing satisfies every comparison.
+  // Arrays and objects are never equal to or ordered against a literal, so
+  // this applies to them too.
+  bool contains_nothing() const;
+};
+
+// Group comparisons between singular queries and literals in each chain of
+// `&&` in the filter expression _expression_, returning one predicate per
+// query per chain. A comparison that isn't part of a chain gets a predicate
+// of its own. Filters nested in queries and function arguments are not
+// searched, as a function extension can map a false argument to anything.
+// Predicates refer to nodes in _expression_ by address.
+std::vector<RangePredicate> find_ranges(const expression_t& expression);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_RANGE_H
@@ -0,0 +1,63 @@
+#ifndef LIBJSONPATH_SCHEMA_H
+#define LIBJSONPATH_SCHEMA_H
+
+#include "libjsonpath/document.hpp"  // ValueKind
+#include "libjsonpath/selectors.hpp" // segments_t Box
+#include <map>                       // std::map
+#include <optional>                  // std::optional
+#include <set>                       // std::set
+#include <string>                    // std::string
+
+namespace libjsonpath {
+
+// The subset of JSON Schema used to specialize queries with
+// _specialize()_. Schemas are trees, there are no references.
+struct Schema {
+  // The `type` keyword, the kinds of value allowed at this node, or nothing
+  // if any kind of value is allowed. JSON Schema's `number` is both
+  // ValueKind::integer and ValueKind::float_.
+  std::optional<std::set<ValueKind>> types{};
+
+  // The `properties` keyword.
+  std::map<std::string, Box<Schema>> properties{};
+
+  // The `items` keyword, the schema of every array element, or nothing if
+  // array elements can be any value.
+  std::optional<Box<Schema>> items{};
+
+  // The `required` keyword.
+  std::set<std::string> required{};
+
+  // The `additionalProperties` keyword, where only `false` is supported.
+  // Member names that are not in _properties_ are only ruled out when this is
+  // false, so wildcard and descendant segments can only be rewritten for
+  // closed objects.
+  bool additional_properties{true};
+};
+
+// Return a copy of _path_ specialized for documents that are valid against
+// _schema_. The result selects the same nodes as _path_ from any valid
+// document, and is usually much cheaper to evaluate.
+//
+//  - Wildcard selectors on closed objects become the member names that can
+//    lead to a match for the rest of the query, followed by `[:]` if the
+//    node can be an array.
+//  - A descendant segment becomes a chain of child segments when the schema
+//    allows its selectors to match at one depth only, so `$..price` becomes
+//    `$['items'][*]['price']` when `price` only appears under items.
+//  - Name, index and slice selectors that can't lead to a match are dropped.
+//  - Comparisons that can never be true because of the types the schema
+//    allows are folded, as are existence tests for queries that can never
+//    match or, using `required`, always match. Filters are then simplified
+//    with _simplify()_, dropping dead branches.
+//
+// If the schema rules out every node, the result is `$[?false]`.
+//
+// Rewriting a descendant segment into child segments keeps the order of
+// nodes from arrays, but the order of members from different objects can
+// change, which RFC 9535 allows.
+segments_t specialize(const segments_t& path, const Schema& schema);
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_SCHEMA_H
@@ -44,6 +44,15 @@ public:
   const T* operator->() const { return m_ptr.get(); }
 };
 
+// Boxes compare equal if the values they point to compare equal.
+template <typename T> bool operator==(const Box<T>& lhs, const Box<T>& rhs) {
+  return *lhs == *rhs;
+}
+
+template <typename T> bool operator!=(const Box<T>& lhs, const Box<T>& rhs) {
+  return !(*lhs == *rhs);
+}
+
 enum class BinaryOperator {
   none,
   logical_and,
@@ -135,6 +144,10 @@ struct NameSelector {
   bool shorthand{false};
 };
 
+// The largest magnitude of an array index or slice bound, the I-JSON range
+// of exactly representable integers that RFC 9535 requires.
+inline constexpr std::int64_t MAX_INDEX{9007199254740991};
+
 struct IndexSelector {
   Token token{};
   std::int64_t index{};
@@ -172,6 +185,51 @@ struct RecursiveSegment {
 
 using segment_t = std::variant<std::monostate, Segment, RecursiveSegment>;
 
+// Semantic equality for segments, selectors and filter expression nodes.
+//
+// Tokens are ignored, as are shorthand flags, so `$.a` and `$['a']` compare
+// equal, and comparison stops at the first difference. Equality is consistent
+// with libjsonpath::hash(), so parsed queries can be used as keys in hashed
+// containers. Given these operators, _segments_t_, _selector_t_ and
+// _expression_t_ can be compared with `==` too.
+bool operator==(const NullLiteral& lhs, const NullLiteral& rhs);
+bool operator==(const BooleanLiteral& lhs, const BooleanLiteral& rhs);
+bool operator==(const IntegerLiteral& lhs, const IntegerLiteral& rhs);
+bool operator==(const FloatLiteral& lhs, const FloatLiteral& rhs);
+bool operator==(const StringLiteral& lhs, const StringLiteral& rhs);
+bool operator==(
+    const LogicalNotExpression& lhs, const LogicalNotExpression& rhs);
+bool operator==(const InfixExpression& lhs, const InfixExpression& rhs);
+bool operator==(const RelativeQuery& lhs, const RelativeQuery& rhs);
+bool operator==(const RootQuery& lhs, const RootQuery& rhs);
+bool operator==(const FunctionCall& lhs, const FunctionCall& rhs);
+bool operator==(const NameSelector& lhs, const NameSelector& rhs);
+bool operator==(const IndexSelector& lhs, const IndexSelector& rhs);
+bool operator==(const WildSelector& lhs, const WildSelector& rhs);
+bool operator==(const SliceSelector& lhs, const SliceSelector& rhs);
+bool operator==(const FilterSelector& lhs, const FilterSelector& rhs);
+bool operator==(const Segment& lhs, const Segment& rhs);
+bool operator==(const RecursiveSegment& lhs, const RecursiveSegment& rhs);
+
+bool operator!=(const NullLiteral& lhs, const NullLiteral& rhs);
+bool operator!=(const BooleanLiteral& lhs, const BooleanLiteral& rhs);
+bool operator!=(const IntegerLiteral& lhs, const IntegerLiteral& rhs);
+bool operator!=(const FloatLiteral& lhs, const FloatLiteral& rhs);
+bool operator!=(const StringLiteral& lhs, const StringLiteral& rhs);
+bool operator!=(
+    const LogicalNotExpression& lhs, const LogicalNotExpression& rhs);
+bool operator!=(const InfixExpression& lhs, const InfixExpression& rhs);
+bool operator!=(const RelativeQuery& lhs, const RelativeQuery& rhs);
+bool operator!=(const RootQuery& lhs, const RootQuery& rhs);
+bool operator!=(const FunctionCall& lhs, const FunctionCall& rhs);
+bool operator!=(const NameSelector& lhs, const NameSelector& rhs);
+bool operator!=(const IndexSelector& lhs, const IndexSelector& rhs);
+bool operator!=(const WildSelector& lhs, const WildSelector& rhs);
+bool operator!=(const SliceSelector& lhs, const SliceSelector& rhs);
+bool operator!=(const FilterSelector& lhs, const FilterSelector& rhs);
+bool operator!=(const Segment& lhs, const Segment& rhs);
+bool operator!=(const RecursiveSegment& lhs, const RecursiveSegment& rhs);
+
 } // namespace libjsonpath
 
 #endif // LIBJSONPATH_SELECTORS_H
\ No newline at end of file
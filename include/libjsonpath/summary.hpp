@@ -0,0 +1,167 @@
+#ifndef LIBJSONPATH_SUMMARY_H
+#define LIBJSONPATH_SUMMARY_H
+
+#include "libjsonpath/document.hpp" // ValueKind is_hashable_v
+#include <array>                    // std::array
+#include <cstddef>                  // std::size_t
+#include <cstdint>                  // std::uint64_t
+#include <functional>               // std::hash
+#include <string_view>              // std::string_view
+#include <unordered_map>            // std::unordered_map
+#include <vector>                   // std::vector
+
+namespace libjsonpath {
+
+// Summaries of the member names found in large subtrees of a document, for
+// skipping subtrees that can't contain the names a query needs. See
+// _Evaluator::find(SubtreeSummary&)_.
+//
+// Each summary is a small Bloom filter of the names of every member of every
+// object in a subtree, including its root. A Bloom filter can say a name
+// might be present when it isn't, in which case a subtree is visited for
+// nothing, but never the other way round.
+//
+// Summaries are built the first time they're needed, with one walk of the
+// document, and only kept for subtrees of at least _threshold_ nodes, as
+// smaller subtrees are cheap enough to visit. Names and nodes refer to the
+// document, which must outlive the summary and must not change while it's
+// in use. Document adapter handles must be hashable.
+template <typename Adapter> class SubtreeSummary {
+public:
+  using node_type = typename Adapter::node_type;
+
+  static_assert(is_hashable_v<node_type>,
+      "subtree summaries need hashable document adapter handles");
+
+  static constexpr std::size_t DEFAULT_THRESHOLD{256};
+
+  explicit SubtreeSummary(
+      node_type root, std::size_t threshold = DEFAULT_THRESHOLD)
+      : m_root{root}, m_threshold{threshold} {};
+
+  node_type root() const noexcept { return m_root; }
+
+  // Return false if _node_ is the root of a summarized subtree that doesn't
+  // contain every one of _names_, or true if it might.
+  bool may_contain(
+      node_type node, const std::vector<std::string_view>& names) {
+    if (!m_built) {
+      build();
+    }
+
+    auto it{m_summaries.find(node)};
+    if (it == m_summaries.end()) {
+      return true;
+    }
+    for (const auto& name : names) {
+      if (!it->second.contains(name)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The number of summarized subtrees, once summaries have been built.
+  std::size_t size() const noexcept { return m_summaries.size(); }
+
+private:
+  // 256 bits, with three bits set per name.
+  class Bloom {
+  public:
+    void add(std::string_view name) noexcept {
+      const auto h{hash(name)};
+      for (int i = 0; i < 3; i++) {
+        const auto bit{(h >> (i * 8)) & 0xFF};
+        m_words[bit >> 6] |= std::uint64_t{1} << (bit & 0x3F);
+      }
+    }
+
+    bool contains(std::string_view name) const noexcept {
+      const auto h{hash(name)};
+      for (int i = 0; i < 3; i++) {
+        const auto bit{(h >> (i * 8)) & 0xFF};
+        if (!(m_words[bit >> 6] & (std::uint64_t{1} << (bit & 0x3F)))) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void merge(const Bloom& other) noexcept {
+      for (std::size_t i = 0; i < m_words.size(); i++) {
+        m_words[i] |= other.m_words[i];
+      }
+    }
+
+  private:
+    std::array<std::uint64_t, 4> m_words{};
+
+    static std::size_t hash(std::string_view name) noexcept {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  node_type m_root;
+  std::size_t m_threshold;
+  bool m_built{false};
+  std::unordered_map<node_type, Bloom> m_summaries{};
+
+  // Collect the names in each subtree, and its number of nodes, after those
+  // of its children, keeping summaries of large enough subtrees. This uses an
+  // explicit stack so deeply nested documents don't overflow the call stack.
+  void build() {
+    m_built = true;
+
+    struct Pending {
+      node_type node;
+      std::size_t parent;
+      Bloom bloom;
+      std::size_t count;
+      bool expanded;
+    };
+
+    constexpr std::size_t no_parent{static_cast<std::size_t>(-1)};
+    std::vector<Pending> stack{{m_root, no_parent, {}, 1, false}};
+
+    while (!stack.empty()) {
+      const auto top{stack.size() - 1};
+
+      if (!stack[top].expanded) {
+        // Parents stay below their children on the stack, so _top_ is still
+        // valid when the children are done.
+        stack[top].expanded = true;
+        const auto node{stack[top].node};
+        const auto kind{Adapter::kind(node)};
+
+        if (kind == ValueKind::object) {
+          const auto end{Adapter::members_end(node)};
+          for (auto it{Adapter::members_begin(node)}; it != end; ++it) {
+            stack[top].bloom.add(Adapter::member_name(it));
+            stack.push_back({Adapter::member_value(it), top, {}, 1, false});
+          }
+        } else if (kind == ValueKind::array) {
+          const auto size{Adapter::size(node)};
+          for (std::size_t j = 0; j < size; j++) {
+            stack.push_back({Adapter::element(node, j), top, {}, 1, false});
+          }
+        }
+        continue;
+      }
+
+      const auto done{stack.back()};
+      stack.pop_back();
+
+      if (done.count >= m_threshold) {
+        m_summaries.emplace(done.node, done.bloom);
+      }
+      if (done.parent != no_parent) {
+        stack[done.parent].bloom.merge(done.bloom);
+        stack[done.parent].count += done.count;
+      }
+    }
+  }
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_SUMMARY_H
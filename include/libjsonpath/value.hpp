@@ -0,0 +1,128 @@
+#ifndef LIBJSONPATH_VALUE_H
+#define LIBJSONPATH_VALUE_H
+
+#include "libjsonpath/document.hpp" // ValueKind
+#include <cstddef>                  // std::size_t std::nullptr_t
+#include <cstdint>                  // std::int64_t
+#include <optional>                 // std::optional
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <utility>                  // std::pair std::move
+#include <variant>                  // std::variant std::get
+#include <vector>                   // std::vector
+
+namespace libjsonpath {
+
+// A minimal JSON DOM, for applications that don't already have one.
+//
+// Objects keep their members in insertion order, which is the order they
+// appear in query results.
+class Value {
+public:
+  using array_t = std::vector<Value>;
+  using object_t = std::vector<std::pair<std::string, Value>>;
+
+  Value() = default;
+  Value(std::nullptr_t) {};
+  Value(bool value) : m_value{value} {};
+  Value(int value) : m_value{std::int64_t{value}} {};
+  Value(std::int64_t value) : m_value{value} {};
+  Value(double value) : m_value{value} {};
+  Value(const char* value) : m_value{std::string{value}} {};
+  Value(std::string value) : m_value{std::move(value)} {};
+  Value(array_t value) : m_value{std::move(value)} {};
+  Value(object_t value) : m_value{std::move(value)} {};
+
+  ValueKind kind() const noexcept {
+    return static_cast<ValueKind>(m_value.index());
+  }
+
+  bool as_bool() const { return std::get<bool>(m_value); }
+  std::int64_t as_integer() const { return std::get<std::int64_t>(m_value); }
+  double as_float() const { return std::get<double>(m_value); }
+  const std::string& as_string() const {
+    return std::get<std::string>(m_value);
+  }
+  const array_t& as_array() const { return std::get<array_t>(m_value); }
+  const object_t& as_object() const { return std::get<object_t>(m_value); }
+
+  // Return the first member of this object called _name_, or a null pointer
+  // if this is not an object or there's no such member.
+  const Value* find(std::string_view name) const noexcept;
+
+  // Values are equal if they are the same kind, or both numbers, and hold
+  // equal values. Objects are equal if they have the same members, in any
+  // order.
+  friend bool operator==(const Value& lhs, const Value& rhs);
+  friend bool operator!=(const Value& lhs, const Value& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  // Alternatives are in the same order as ValueKind.
+  std::variant<std::nullptr_t, bool, std::int64_t, double, std::string,
+      array_t, object_t>
+      m_value{nullptr};
+};
+
+// Parse the JSON text _text_ into a Value. Throws a JSONError if _text_ is
+// not valid JSON. Integers that don't fit in a std::int64_t become floats.
+// Duplicate member names are kept, and member lookup finds the first.
+Value parse_json(std::string_view text);
+
+// Return a compact JSON representation of _value_.
+std::string to_json(const Value& value);
+
+// A document adapter for Value. See libjsonpath/document.hpp.
+struct ValueAdapter {
+  using node_type = const Value*;
+  using member_iterator = Value::object_t::const_iterator;
+
+  static ValueKind kind(node_type node) noexcept { return node->kind(); }
+
+  static std::size_t size(node_type node) {
+    return node->kind() == ValueKind::array ? node->as_array().size()
+                                            : node->as_object().size();
+  }
+
+  static node_type element(node_type node, std::size_t index) {
+    return &node->as_array()[index];
+  }
+
+  static std::optional<node_type> member(
+      node_type node, std::string_view name) {
+    if (auto child{node->find(name)}) {
+      return child;
+    }
+    return std::nullopt;
+  }
+
+  static member_iterator members_begin(node_type node) {
+    return node->as_object().cbegin();
+  }
+
+  static member_iterator members_end(node_type node) {
+    return node->as_object().cend();
+  }
+
+  static std::string_view member_name(const member_iterator& it) {
+    return it->first;
+  }
+
+  static node_type member_value(const member_iterator& it) {
+    return &it->second;
+  }
+
+  static bool boolean_value(node_type node) { return node->as_bool(); }
+  static std::int64_t integer_value(node_type node) {
+    return node->as_integer();
+  }
+  static double float_value(node_type node) { return node->as_float(); }
+  static std::string_view string_value(node_type node) {
+    return node->as_string();
+  }
+};
+
+} // namespace libjsonpath
+
+#endif // LIBJSONPATH_VALUE_H
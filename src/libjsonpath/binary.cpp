@@ -0,0 +1,660 @@
+#include "libjsonpath/binary.hpp"
+#include "libjsonpath/exceptions.hpp" // libjsonpath::FormatError
+#include <cstring>                    // std::memcpy
+#include <unordered_map>              // std::unordered_map
+#include <utility>                    // std::move std::pair
+#include <variant>                    // std::visit
+#include <vector>                     // std::vector
+
+namespace libjsonpath {
+
+using namespace std::string_literals;
+
+static constexpr char MAGIC[4]{'J', 'P', 'Q', 'B'};
+static constexpr std::uint32_t HEADER_SIZE{32};
+static constexpr std::uint32_t NODE_SIZE{16};
+static constexpr std::uint32_t FUNCTION_SIZE{16};
+
+// Slice selector presence flags, stored in a slice node's _op_ field.
+static constexpr std::uint8_t SLICE_START{1};
+static constexpr std::uint8_t SLICE_STOP{2};
+static constexpr std::uint8_t SLICE_STEP{4};
+
+static void put_u16(std::string& out, std::uint16_t value) {
+  out.push_back(static_cast<char>(value & 0xFF));
+  out.push_back(static_cast<char>(value >> 8));
+}
+
+static void put_u32(std::string& out, std::uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+static void put_u64(std::string& out, std::uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+static std::uint16_t get_u16(const char* p) {
+  const auto* b{reinterpret_cast<const unsigned char*>(p)};
+  return static_cast<std::uint16_t>(b[0] | (b[1] << 8));
+}
+
+static std::uint32_t get_u32(const char* p) {
+  const auto* b{reinterpret_cast<const unsigned char*>(p)};
+  return static_cast<std::uint32_t>(b[0]) |
+         (static_cast<std::uint32_t>(b[1]) << 8) |
+         (static_cast<std::uint32_t>(b[2]) << 16) |
+         (static_cast<std::uint32_t>(b[3]) << 24);
+}
+
+static std::uint64_t get_u64(const char* p) {
+  return static_cast<std::uint64_t>(get_u32(p)) |
+         (static_cast<std::uint64_t>(get_u32(p + 4)) << 32);
+}
+
+// A _segments_t_, _selector_t_ and _expression_t_ visitor building the node
+// array, function table and string pool for a binary encoded query.
+//
+// Space for a node's children is reserved before any child is encoded, so
+// that siblings are contiguous and always follow their parent.
+class Encoder {
+public:
+  Encoder(const function_signature_map& function_extensions)
+      : m_function_extensions{function_extensions} {};
+
+  std::string encode(const segments_t& path) {
+    m_nodes.resize(1);
+    set(0, segments(BinaryNodeKind::query, path));
+
+    std::string rv{};
+    const auto node_count{static_cast<std::uint32_t>(m_nodes.size())};
+    const auto function_count{static_cast<std::uint32_t>(m_functions.size())};
+    const std::uint32_t nodes_offset{HEADER_SIZE};
+    const std::uint32_t functions_offset{
+        nodes_offset + node_count * NODE_SIZE};
+    const std::uint32_t strings_offset{
+        functions_offset + function_count * FUNCTION_SIZE};
+
+    rv.reserve(strings_offset + m_strings.size());
+    rv.append(MAGIC, sizeof(MAGIC));
+    put_u16(rv, BINARY_FORMAT_VERSION);
+    put_u16(rv, 0);
+    put_u32(rv, node_count);
+    put_u32(rv, nodes_offset);
+    put_u32(rv, function_count);
+    put_u32(rv, functions_offset);
+    put_u32(rv, strings_offset);
+    put_u32(rv, static_cast<std::uint32_t>(m_strings.size()));
+
+    for (const auto& node : m_nodes) {
+      rv.push_back(static_cast<char>(node.kind));
+      rv.push_back(static_cast<char>(node.op));
+      put_u16(rv, node.slot);
+      put_u32(rv, node.a);
+      put_u64(rv, node.b);
+    }
+
+    for (const auto& entry : m_functions) {
+      put_u32(rv, entry.name_offset);
+      put_u32(rv, entry.name_length);
+      put_u32(rv, entry.args_offset);
+      put_u16(rv, entry.arg_count);
+      rv.push_back(static_cast<char>(entry.result));
+      rv.push_back('\0');
+    }
+
+    rv.append(m_strings);
+    return rv;
+  }
+
+  BinaryNode operator()(const Segment& segment) {
+    return selectors(BinaryNodeKind::segment, segment.selectors);
+  }
+
+  BinaryNode operator()(const RecursiveSegment& segment) {
+    return selectors(BinaryNodeKind::recursive_segment, segment.selectors);
+  }
+
+  BinaryNode operator()(const NameSelector& selector) {
+    return string(BinaryNodeKind::name_selector, selector.name);
+  }
+
+  BinaryNode operator()(const IndexSelector& selector) {
+    return BinaryNode{BinaryNodeKind::index_selector, 0, 0, 0,
+        static_cast<std::uint64_t>(selector.index)};
+  }
+
+  BinaryNode operator()(const WildSelector&) {
+    return BinaryNode{BinaryNodeKind::wild_selector};
+  }
+
+  BinaryNode operator()(const SliceSelector& selector) {
+    std::uint8_t flags{0};
+    flags |= selector.start ? SLICE_START : 0;
+    flags |= selector.stop ? SLICE_STOP : 0;
+    flags |= selector.step ? SLICE_STEP : 0;
+    const auto first{reserve(3)};
+    m_nodes[first] = integer(selector.start.value_or(0));
+    m_nodes[first + 1] = integer(selector.stop.value_or(0));
+    m_nodes[first + 2] = integer(selector.step.value_or(1));
+    return BinaryNode{BinaryNodeKind::slice_selector, flags, 0, first, 3};
+  }
+
+  BinaryNode operator()(const Box<FilterSelector>& selector) {
+    const auto first{reserve(1)};
+    set(first, std::visit(*this, selector->expression));
+    return BinaryNode{BinaryNodeKind::filter_selector, 0, 0, first, 1};
+  }
+
+  BinaryNode operator()(const NullLiteral&) {
+    return BinaryNode{BinaryNodeKind::null_literal};
+  }
+
+  BinaryNode operator()(const BooleanLiteral& expression) {
+    return BinaryNode{BinaryNodeKind::boolean_literal,
+        static_cast<std::uint8_t>(expression.value ? 1 : 0)};
+  }
+
+  BinaryNode operator()(const IntegerLiteral& expression) {
+    return integer(expression.value);
+  }
+
+  BinaryNode operator()(const FloatLiteral& expression) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &expression.value, sizeof(bits));
+    return BinaryNode{BinaryNodeKind::float_literal, 0, 0, 0, bits};
+  }
+
+  BinaryNode operator()(const StringLiteral& expression) {
+    return string(BinaryNodeKind::string_literal, expression.value);
+  }
+
+  BinaryNode operator()(const Box<LogicalNotExpression>& expression) {
+    const auto first{reserve(1)};
+    set(first, std::visit(*this, expression->right));
+    return BinaryNode{BinaryNodeKind::logical_not, 0, 0, first, 1};
+  }
+
+  BinaryNode operator()(const Box<InfixExpression>& expression) {
+    const auto first{reserve(2)};
+    set(first, std::visit(*this, expression->left));
+    set(first + 1, std::visit(*this, expression->right));
+    return BinaryNode{BinaryNodeKind::infix,
+        static_cast<std::uint8_t>(expression->op), 0, first, 2};
+  }
+
+  BinaryNode operator()(const Box<RelativeQuery>& expression) {
+    return segments(BinaryNodeKind::relative_query, expression->query);
+  }
+
+  BinaryNode operator()(const Box<RootQuery>& expression) {
+    return segments(BinaryNodeKind::root_query, expression->query);
+  }
+
+  BinaryNode operator()(const Box<FunctionCall>& expression) {
+    const auto slot{function_slot(expression->name, expression->token)};
+    const auto first{reserve(expression->args.size())};
+    for (std::size_t i = 0; i < expression->args.size(); i++) {
+      set(first + i, std::visit(*this, expression->args[i]));
+    }
+    return BinaryNode{BinaryNodeKind::function_call, 0, slot, first,
+        expression->args.size()};
+  }
+
+private:
+  struct FunctionEntry {
+    std::uint32_t name_offset{};
+    std::uint32_t name_length{};
+    std::uint32_t args_offset{};
+    std::uint16_t arg_count{};
+    std::uint8_t result{};
+  };
+
+  const function_signature_map& m_function_extensions;
+  std::vector<BinaryNode> m_nodes{};
+  std::vector<FunctionEntry> m_functions{};
+  std::unordered_map<std::string_view, std::uint16_t> m_function_slots{};
+  std::string m_strings{};
+  std::unordered_map<std::string, std::uint32_t> m_string_offsets{};
+
+  // Reserve _count_ contiguous node records, returning the index of the first.
+  std::uint32_t reserve(std::size_t count) {
+    const auto first{static_cast<std::uint32_t>(m_nodes.size())};
+    m_nodes.resize(m_nodes.size() + count);
+    return first;
+  }
+
+  // Store _node_ at _index_. Encoding _node_ may have grown the node array,
+  // so this must happen after the node is encoded.
+  void set(std::uint32_t index, const BinaryNode& node) {
+    m_nodes[index] = node;
+  }
+
+  // Return the offset of _value_ in the string pool, adding it if needed.
+  std::uint32_t intern(std::string_view value) {
+    auto [it, inserted]{m_string_offsets.try_emplace(
+        std::string{value}, static_cast<std::uint32_t>(m_strings.size()))};
+    if (inserted) {
+      m_strings.append(value);
+    }
+    return it->second;
+  }
+
+  BinaryNode string(BinaryNodeKind kind, std::string_view value) {
+    return BinaryNode{kind, 0, 0, intern(value), value.size()};
+  }
+
+  BinaryNode integer(std::int64_t value) {
+    return BinaryNode{BinaryNodeKind::integer_literal, 0, 0, 0,
+        static_cast<std::uint64_t>(value)};
+  }
+
+  BinaryNode segments(BinaryNodeKind kind, const segments_t& path) {
+    const auto first{reserve(path.size())};
+    for (std::size_t i = 0; i < path.size(); i++) {
+      set(first + i, std::visit(*this, path[i]));
+    }
+    return BinaryNode{kind, 0, 0, first, path.size()};
+  }
+
+  BinaryNode selectors(
+      BinaryNodeKind kind, const std::vector<selector_t>& items) {
+    const auto first{reserve(items.size())};
+    for (std::size_t i = 0; i < items.size(); i++) {
+      set(first + i, std::visit(*this, items[i]));
+    }
+    return BinaryNode{kind, 0, 0, first, items.size()};
+  }
+
+  // Return the function table slot for the function named _name_, adding
+  // an entry with its current signature if needed.
+  std::uint16_t function_slot(std::string_view name, const Token& token) {
+    auto slot_it{m_function_slots.find(name)};
+    if (slot_it != m_function_slots.end()) {
+      return slot_it->second;
+    }
+
+    auto it{m_function_extensions.find(std::string{name})};
+    if (it == m_function_extensions.end()) {
+      throw NameError("no such function '"s + std::string{name} + "'"s, token);
+    }
+
+    std::string arg_types{};
+    for (const auto arg : it->second.args) {
+      arg_types.push_back(static_cast<char>(arg));
+    }
+
+    const auto slot{static_cast<std::uint16_t>(m_functions.size())};
+    m_functions.push_back(FunctionEntry{intern(name),
+        static_cast<std::uint32_t>(name.size()), intern(arg_types),
+        static_cast<std::uint16_t>(arg_types.size()),
+        static_cast<std::uint8_t>(it->second.res)});
+    m_function_slots.emplace(name, slot);
+    return slot;
+  }
+};
+
+std::string dump(const segments_t& path) {
+  return dump(path, DEFAULT_FUNCTION_EXTENSIONS);
+}
+
+std::string dump(
+    const segments_t& path, const function_signature_map& function_extensions) {
+  Encoder encoder{function_extensions};
+  return encoder.encode(path);
+}
+
+QueryImage::QueryImage(std::string_view data) : m_data{data} {
+  if (m_data.size() < HEADER_SIZE ||
+      std::memcmp(m_data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    throw FormatError("not a binary JSONPath query");
+  }
+
+  const auto version{get_u16(m_data.data() + 4)};
+  if (version != BINARY_FORMAT_VERSION) {
+    throw FormatError("unsupported binary query version "s +
+                      std::to_string(version) + ", expected "s +
+                      std::to_string(BINARY_FORMAT_VERSION));
+  }
+
+  m_node_count = get_u32(m_data.data() + 8);
+  m_nodes_offset = get_u32(m_data.data() + 12);
+  m_function_count = get_u32(m_data.data() + 16);
+  m_functions_offset = get_u32(m_data.data() + 20);
+  m_strings_offset = get_u32(m_data.data() + 24);
+  m_strings_size = get_u32(m_data.data() + 28);
+
+  const auto size{static_cast<std::uint64_t>(m_data.size())};
+  if (m_node_count == 0 ||
+      m_nodes_offset + std::uint64_t{m_node_count} * NODE_SIZE > size ||
+      m_functions_offset + std::uint64_t{m_function_count} * FUNCTION_SIZE >
+          size ||
+      std::uint64_t{m_strings_offset} + m_strings_size > size) {
+    throw FormatError("truncated binary query");
+  }
+
+  // Function table entries are checked first, so that checking a function
+  // call node can read its entry.
+  for (std::uint32_t i = 0; i < m_function_count; i++) {
+    const char* p{m_data.data() + m_functions_offset + i * FUNCTION_SIZE};
+    if (std::uint64_t{get_u32(p)} + get_u32(p + 4) > m_strings_size ||
+        std::uint64_t{get_u32(p + 8)} + get_u16(p + 12) > m_strings_size) {
+      throw FormatError("function table entry out of range");
+    }
+  }
+
+  if (node(0).kind != BinaryNodeKind::query) {
+    throw FormatError("binary query does not start with a query node");
+  }
+
+  // Walk the tree depth first, in the order _dump()_ reserves records. Each
+  // node's children must start at the next unclaimed record, so every record
+  // other than the root has exactly one parent and the image is a tree.
+  // Entries on the stack are record indices and their depth.
+  std::uint32_t next{1};
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> stack{{0, 1}};
+  while (!stack.empty()) {
+    const auto [index, depth]{stack.back()};
+    stack.pop_back();
+    check_node(index, next);
+
+    const auto n{node(index)};
+    if (has_children(n.kind) && n.b > 0) {
+      if (depth == MAX_BINARY_DEPTH) {
+        throw FormatError("binary query is nested deeper than "s +
+                          std::to_string(MAX_BINARY_DEPTH) + " nodes");
+      }
+      next += static_cast<std::uint32_t>(n.b);
+      for (auto i = n.b; i > 0; i--) {
+        stack.emplace_back(n.a + static_cast<std::uint32_t>(i - 1), depth + 1);
+      }
+    }
+  }
+
+  if (next != m_node_count) {
+    throw FormatError("binary query has unreachable nodes");
+  }
+}
+
+BinaryNode QueryImage::node(std::uint32_t index) const noexcept {
+  const char* p{m_data.data() + m_nodes_offset + index * NODE_SIZE};
+  return BinaryNode{static_cast<BinaryNodeKind>(p[0]),
+      static_cast<std::uint8_t>(p[1]), get_u16(p + 2), get_u32(p + 4),
+      get_u64(p + 8)};
+}
+
+std::string_view QueryImage::string(const BinaryNode& node) const noexcept {
+  return m_data.substr(m_strings_offset + node.a, node.b);
+}
+
+BinaryFunction QueryImage::function(std::uint16_t slot) const {
+  if (slot >= m_function_count) {
+    throw FormatError("function slot "s + std::to_string(slot) +
+                      " out of range");
+  }
+
+  const char* p{m_data.data() + m_functions_offset + slot * FUNCTION_SIZE};
+  const auto name_offset{get_u32(p)};
+  const auto name_length{get_u32(p + 4)};
+  const auto args_offset{get_u32(p + 8)};
+  const auto arg_count{get_u16(p + 12)};
+  if (std::uint64_t{name_offset} + name_length > m_strings_size ||
+      std::uint64_t{args_offset} + arg_count > m_strings_size) {
+    throw FormatError("function table entry out of range");
+  }
+
+  BinaryFunction rv{};
+  rv.name = m_data.substr(m_strings_offset + name_offset, name_length);
+  const char* args{m_data.data() + m_strings_offset + args_offset};
+  for (std::uint16_t i = 0; i < arg_count; i++) {
+    rv.types.args.push_back(static_cast<ExpressionType>(args[i]));
+  }
+  rv.types.res = static_cast<ExpressionType>(p[14]);
+  return rv;
+}
+
+bool QueryImage::has_children(BinaryNodeKind kind) noexcept {
+  switch (kind) {
+  case BinaryNodeKind::query:
+  case BinaryNodeKind::segment:
+  case BinaryNodeKind::recursive_segment:
+  case BinaryNodeKind::relative_query:
+  case BinaryNodeKind::root_query:
+  case BinaryNodeKind::function_call:
+  case BinaryNodeKind::slice_selector:
+  case BinaryNodeKind::filter_selector:
+  case BinaryNodeKind::logical_not:
+  case BinaryNodeKind::infix:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void QueryImage::check_node(std::uint32_t index, std::uint32_t next) const {
+  const auto n{node(index)};
+
+  // Nodes with exactly _count_ children, or any number of children if
+  // _count_ is negative. Children must start at the next unclaimed record.
+  auto check_children = [&](int count) {
+    if ((count >= 0 && n.b != static_cast<std::uint64_t>(count)) ||
+        (n.b > 0 && (n.a != next || n.b > m_node_count - next))) {
+      throw FormatError("node "s + std::to_string(index) +
+                        " has children out of range");
+    }
+  };
+
+  switch (n.kind) {
+  case BinaryNodeKind::query:
+  case BinaryNodeKind::segment:
+  case BinaryNodeKind::recursive_segment:
+  case BinaryNodeKind::relative_query:
+  case BinaryNodeKind::root_query:
+    check_children(-1);
+    break;
+  case BinaryNodeKind::function_call:
+    check_children(-1);
+    if (n.slot >= m_function_count) {
+      throw FormatError("node "s + std::to_string(index) +
+                        " refers to a missing function");
+    }
+    if (function(n.slot).types.args.size() != n.b) {
+      throw FormatError("node "s + std::to_string(index) +
+                        " has the wrong number of arguments");
+    }
+    break;
+  case BinaryNodeKind::slice_selector:
+    check_children(3);
+    break;
+  case BinaryNodeKind::filter_selector:
+  case BinaryNodeKind::logical_not:
+    check_children(1);
+    break;
+  case BinaryNodeKind::infix:
+    check_children(2);
+    if (n.op <= static_cast<std::uint8_t>(BinaryOperator::none) ||
+        n.op > static_cast<std::uint8_t>(BinaryOperator::ne)) {
+      throw FormatError("node "s + std::to_string(index) +
+                        " has unknown operator "s + std::to_string(n.op));
+    }
+    break;
+  case BinaryNodeKind::name_selector:
+  case BinaryNodeKind::string_literal:
+    if (std::uint64_t{n.a} + n.b > m_strings_size) {
+      throw FormatError(
+          "node "s + std::to_string(index) + " has a string out of range");
+    }
+    break;
+  case BinaryNodeKind::index_selector:
+  case BinaryNodeKind::wild_selector:
+  case BinaryNodeKind::null_literal:
+  case BinaryNodeKind::boolean_literal:
+  case BinaryNodeKind::integer_literal:
+  case BinaryNodeKind::float_literal:
+  case BinaryNodeKind::absent:
+    break;
+  default:
+    throw FormatError("node "s + std::to_string(index) + " has unknown kind "s +
+                      std::to_string(static_cast<int>(n.kind)));
+  }
+}
+
+void QueryImage::check_functions(
+    const function_signature_map& function_extensions) const {
+  for (std::uint32_t slot = 0; slot < m_function_count; slot++) {
+    const auto func{function(static_cast<std::uint16_t>(slot))};
+    const auto name{std::string{func.name}};
+    auto it{function_extensions.find(name)};
+    if (it == function_extensions.end()) {
+      throw NameError("no such function '"s + name + "'"s);
+    }
+
+    if (it->second.args != func.types.args ||
+        it->second.res != func.types.res) {
+      throw TypeError("signature of function '"s + name +
+                      "' does not match the binary query");
+    }
+  }
+}
+
+// Builds segments, selectors and filter expressions from a QueryImage that
+// has already been checked, so child indices are known to be in range.
+class Decoder {
+public:
+  Decoder(const QueryImage& image) : m_image{image} {
+    for (std::uint32_t slot = 0; slot < image.function_count(); slot++) {
+      m_function_names.push_back(
+          image.function(static_cast<std::uint16_t>(slot)).name);
+    }
+  };
+
+  segments_t segments(const BinaryNode& node) const {
+    segments_t rv{};
+    rv.reserve(node.b);
+    for (std::uint32_t i = 0; i < node.b; i++) {
+      const auto child{m_image.node(node.a + i)};
+      if (child.kind == BinaryNodeKind::segment) {
+        rv.push_back(Segment{Token{TokenType::lbracket}, selectors(child)});
+      } else if (child.kind == BinaryNodeKind::recursive_segment) {
+        rv.push_back(
+            RecursiveSegment{Token{TokenType::ddot}, selectors(child)});
+      } else {
+        throw FormatError("expected a segment at node "s +
+                          std::to_string(node.a + i));
+      }
+    }
+    return rv;
+  }
+
+private:
+  const QueryImage& m_image;
+  std::vector<std::string_view> m_function_names{};
+
+  std::vector<selector_t> selectors(const BinaryNode& node) const {
+    std::vector<selector_t> rv{};
+    rv.reserve(node.b);
+    for (std::uint32_t i = 0; i < node.b; i++) {
+      rv.push_back(selector(node.a + i));
+    }
+    return rv;
+  }
+
+  selector_t selector(std::uint32_t index) const {
+    const auto node{m_image.node(index)};
+    switch (node.kind) {
+    case BinaryNodeKind::name_selector:
+      return NameSelector{Token{TokenType::name_},
+          std::string{m_image.string(node)}, false};
+    case BinaryNodeKind::index_selector:
+      return IndexSelector{
+          Token{TokenType::index}, static_cast<std::int64_t>(node.b)};
+    case BinaryNodeKind::wild_selector:
+      return WildSelector{Token{TokenType::wild}, false};
+    case BinaryNodeKind::slice_selector: {
+      SliceSelector rv{Token{TokenType::colon}};
+      if (node.op & SLICE_START) {
+        rv.start = static_cast<std::int64_t>(m_image.node(node.a).b);
+      }
+      if (node.op & SLICE_STOP) {
+        rv.stop = static_cast<std::int64_t>(m_image.node(node.a + 1).b);
+      }
+      if (node.op & SLICE_STEP) {
+        rv.step = static_cast<std::int64_t>(m_image.node(node.a + 2).b);
+      }
+      return rv;
+    }
+    case BinaryNodeKind::filter_selector:
+      return Box(FilterSelector{Token{TokenType::filter_}, expression(node.a)});
+    default:
+      throw FormatError(
+          "expected a selector at node "s + std::to_string(index));
+    }
+  }
+
+  expression_t expression(std::uint32_t index) const {
+    const auto node{m_image.node(index)};
+    switch (node.kind) {
+    case BinaryNodeKind::null_literal:
+      return NullLiteral{Token{TokenType::null_}};
+    case BinaryNodeKind::boolean_literal:
+      return BooleanLiteral{
+          Token{node.op ? TokenType::true_ : TokenType::false_}, node.op != 0};
+    case BinaryNodeKind::integer_literal:
+      return IntegerLiteral{
+          Token{TokenType::int_}, static_cast<std::int64_t>(node.b)};
+    case BinaryNodeKind::float_literal: {
+      double value;
+      std::memcpy(&value, &node.b, sizeof(value));
+      return FloatLiteral{Token{TokenType::float_}, value};
+    }
+    case BinaryNodeKind::string_literal:
+      return StringLiteral{
+          Token{TokenType::dq_string}, std::string{m_image.string(node)}};
+    case BinaryNodeKind::logical_not:
+      return Box(
+          LogicalNotExpression{Token{TokenType::not_}, expression(node.a)});
+    case BinaryNodeKind::infix:
+      return Box(InfixExpression{Token{}, expression(node.a),
+          static_cast<BinaryOperator>(node.op), expression(node.a + 1)});
+    case BinaryNodeKind::relative_query:
+      return Box(RelativeQuery{Token{TokenType::current}, segments(node)});
+    case BinaryNodeKind::root_query:
+      return Box(RootQuery{Token{TokenType::root}, segments(node)});
+    case BinaryNodeKind::function_call: {
+      const auto name{m_function_names[node.slot]};
+      std::vector<expression_t> args{};
+      args.reserve(node.b);
+      for (std::uint32_t i = 0; i < node.b; i++) {
+        args.push_back(expression(node.a + i));
+      }
+      return Box(FunctionCall{Token{TokenType::func_, name}, name,
+          std::move(args)});
+    }
+    default:
+      throw FormatError(
+          "expected a filter expression at node "s + std::to_string(index));
+    }
+  }
+};
+
+segments_t QueryImage::segments() const {
+  return Decoder{*this}.segments(node(0));
+}
+
+segments_t load(std::string_view data) {
+  return load(data, DEFAULT_FUNCTION_EXTENSIONS);
+}
+
+segments_t load(
+    std::string_view data, const function_signature_map& function_extensions) {
+  QueryImage image{data};
+  image.check_functions(function_extensions);
+  auto path{image.segments()};
+  Parser{function_extensions}.check(path);
+  return path;
+}
+
+} // namespace libjsonpath
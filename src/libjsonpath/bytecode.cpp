@@ -0,0 +1,355 @@
+#include "libjsonpath/bytecode.hpp"
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::write_to_string
+#include "libjsonpath/optimize.hpp" // libjsonpath::is_invariant
+#include "libjsonpath/range.hpp"    // libjsonpath::is_literal
+#include <string_view>              // std::string_view
+#include <utility>                  // std::move
+#include <variant>                  // std::get_if std::holds_alternative
+
+namespace libjsonpath {
+
+namespace {
+
+bool is_number(const expression_t& expression) {
+  return std::holds_alternative<IntegerLiteral>(expression) ||
+         std::holds_alternative<FloatLiteral>(expression);
+}
+
+bool is_logical(BinaryOperator op) {
+  return op == BinaryOperator::logical_and || op == BinaryOperator::logical_or;
+}
+
+// Return the operator that gives the same result with its operands swapped.
+BinaryOperator flip(BinaryOperator op) {
+  switch (op) {
+  case BinaryOperator::lt:
+    return BinaryOperator::gt;
+  case BinaryOperator::gt:
+    return BinaryOperator::lt;
+  case BinaryOperator::le:
+    return BinaryOperator::ge;
+  case BinaryOperator::ge:
+    return BinaryOperator::le;
+  default:
+    return op;
+  }
+}
+
+class Compiler {
+public:
+  Program compile(const expression_t& expression) {
+    compile_logical(expression);
+    return std::move(m_program);
+  }
+
+private:
+  Program m_program{};
+
+  std::uint32_t emit(Instruction instruction) {
+    m_program.code.push_back(instruction);
+    return static_cast<std::uint32_t>(m_program.code.size() - 1);
+  }
+
+  // Point the jump at _offset_ to the next instruction to be emitted.
+  void patch(std::uint32_t offset) {
+    const auto target{m_program.code.size()};
+    m_program.code[offset].b = static_cast<std::uint32_t>(target);
+  }
+
+  std::uint32_t add_constant(const expression_t& expression) {
+    Constant constant{};
+    if (auto b{std::get_if<BooleanLiteral>(&expression)}) {
+      constant.kind = ValueKind::boolean;
+      constant.boolean = b->value;
+    } else if (auto i{std::get_if<IntegerLiteral>(&expression)}) {
+      constant.kind = ValueKind::integer;
+      constant.integer = i->value;
+      constant.number = static_cast<double>(i->value);
+    } else if (auto f{std::get_if<FloatLiteral>(&expression)}) {
+      constant.kind = ValueKind::float_;
+      constant.number = f->value;
+    } else if (auto s{std::get_if<StringLiteral>(&expression)}) {
+      constant.kind = ValueKind::string;
+      constant.string = s->value;
+    }
+    m_program.constants.push_back(constant);
+    return static_cast<std::uint32_t>(m_program.constants.size() - 1);
+  }
+
+  std::uint32_t add_operand(const expression_t& expression) {
+    m_program.operands.push_back(&expression);
+    return static_cast<std::uint32_t>(m_program.operands.size() - 1);
+  }
+
+  std::uint32_t add_path(SingularPath path) {
+    m_program.paths.push_back(std::move(path));
+    return static_cast<std::uint32_t>(m_program.paths.size() - 1);
+  }
+
+  void use_registers(std::size_t count) {
+    if (count > m_program.registers) {
+      m_program.registers = count;
+    }
+  }
+
+  void compile_logical(const expression_t& expression) {
+    if (auto b{std::get_if<BooleanLiteral>(&expression)}) {
+      emit({Opcode::set, BinaryOperator::none, b->value ? 1u : 0u, 0});
+      return;
+    }
+
+    // Invariant subexpressions are computed once per evaluation by the
+    // evaluator, so the bytecode defers to it.
+    if (!is_literal(expression) && is_invariant(expression)) {
+      emit({Opcode::test, BinaryOperator::none, 0, add_operand(expression)});
+      return;
+    }
+
+    if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+      compile_logical((*not_)->right);
+      emit({Opcode::not_});
+      return;
+    }
+
+    if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+      const auto op{(*infix)->op};
+      if (is_logical(op)) {
+        compile_logical((*infix)->left);
+        const auto jump{emit({op == BinaryOperator::logical_and
+                                  ? Opcode::jump_if_false
+                                  : Opcode::jump_if_true})};
+        compile_logical((*infix)->right);
+        patch(jump);
+      } else {
+        compile_comparison((*infix)->left, op, (*infix)->right);
+      }
+      return;
+    }
+
+    if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+      if (auto path{compile_singular_query((*relative)->query)}) {
+        emit({Opcode::exists_singular, BinaryOperator::none, 0,
+            add_path(std::move(path.value()))});
+        return;
+      }
+    }
+
+    // Non-singular existence tests and functions returning LogicalType.
+    emit({Opcode::test, BinaryOperator::none, 0, add_operand(expression)});
+  }
+
+  void compile_comparison(const expression_t& left, BinaryOperator op,
+      const expression_t& right) {
+    // Comparisons against a number or string literal get typed opcodes,
+    // with the literal on the right.
+    auto typed{[&](const expression_t& operand, BinaryOperator operand_op,
+                   const expression_t& literal) {
+      const bool number{is_number(literal)};
+      if (!number && !std::holds_alternative<StringLiteral>(literal)) {
+        return false;
+      }
+      use_registers(1);
+      compile_operand(operand, 0);
+      emit({number ? Opcode::compare_number : Opcode::compare_string,
+          operand_op, 0, add_constant(literal)});
+      return true;
+    }};
+
+    if (!is_literal(left) && is_literal(right) && typed(left, op, right)) {
+      return;
+    }
+    if (is_literal(left) && !is_literal(right) &&
+        typed(right, flip(op), left)) {
+      return;
+    }
+
+    use_registers(2);
+    compile_operand(left, 0);
+    compile_operand(right, 1);
+    emit({Opcode::compare, op, 0, 1});
+  }
+
+  void compile_operand(const expression_t& expression, std::uint32_t r) {
+    if (is_literal(expression)) {
+      emit({Opcode::load_constant, BinaryOperator::none, r,
+          add_constant(expression)});
+      return;
+    }
+
+    if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+      if (auto path{compile_singular_query((*relative)->query)}) {
+        emit({Opcode::load_singular, BinaryOperator::none, r,
+            add_path(std::move(path.value()))});
+        return;
+      }
+    }
+
+    emit({Opcode::load_value, BinaryOperator::none, r,
+        add_operand(expression)});
+  }
+};
+
+std::string_view opcode_name(Opcode opcode) {
+  switch (opcode) {
+  case Opcode::set:
+    return "set";
+  case Opcode::load_constant:
+    return "load_constant";
+  case Opcode::load_singular:
+    return "load_singular";
+  case Opcode::load_value:
+    return "load_value";
+  case Opcode::compare:
+    return "compare";
+  case Opcode::compare_number:
+    return "compare_number";
+  case Opcode::compare_string:
+    return "compare_string";
+  case Opcode::exists_singular:
+    return "exists_singular";
+  case Opcode::test:
+    return "test";
+  case Opcode::not_:
+    return "not";
+  case Opcode::jump_if_false:
+    return "jump_if_false";
+  case Opcode::jump_if_true:
+    return "jump_if_true";
+  }
+  return "";
+}
+
+std::string_view operator_symbol(BinaryOperator op) {
+  switch (op) {
+  case BinaryOperator::eq:
+    return "==";
+  case BinaryOperator::ne:
+    return "!=";
+  case BinaryOperator::lt:
+    return "<";
+  case BinaryOperator::le:
+    return "<=";
+  case BinaryOperator::gt:
+    return ">";
+  case BinaryOperator::ge:
+    return ">=";
+  default:
+    return "?";
+  }
+}
+
+void write_constant(CanonicalWriter& writer, const Constant& constant) {
+  switch (constant.kind) {
+  case ValueKind::boolean:
+    writer.write(constant.boolean ? "true" : "false");
+    break;
+  case ValueKind::integer:
+    writer.write_int(constant.integer);
+    break;
+  case ValueKind::float_:
+    writer.write_float(constant.number);
+    break;
+  case ValueKind::string:
+    writer.write_string(constant.string);
+    break;
+  default:
+    writer.write("null");
+  }
+}
+
+void write_path(CanonicalWriter& writer, const SingularPath& path) {
+  writer.put('@');
+  for (const auto& step : path.steps()) {
+    writer.put('[');
+    if (auto name{std::get_if<std::string>(&step)}) {
+      writer.write_name(*name);
+    } else {
+      writer.write_int(std::get<std::int64_t>(step));
+    }
+    writer.put(']');
+  }
+}
+
+void write_register(CanonicalWriter& writer, std::uint32_t r) {
+  writer.put('r');
+  writer.write_int(r);
+}
+
+void write_program(CanonicalWriter& writer, const Program& program) {
+  for (std::size_t pc = 0; pc < program.code.size(); pc++) {
+    const auto& ins{program.code[pc]};
+    writer.write_int(static_cast<std::int64_t>(pc));
+    writer.write(": ");
+    writer.write(opcode_name(ins.opcode));
+
+    switch (ins.opcode) {
+    case Opcode::set:
+      writer.write(ins.a ? " true" : " false");
+      break;
+    case Opcode::load_constant:
+      writer.put(' ');
+      write_register(writer, ins.a);
+      writer.write(", ");
+      write_constant(writer, program.constants[ins.b]);
+      break;
+    case Opcode::load_singular:
+      writer.put(' ');
+      write_register(writer, ins.a);
+      writer.write(", ");
+      write_path(writer, program.paths[ins.b]);
+      break;
+    case Opcode::load_value:
+      writer.put(' ');
+      write_register(writer, ins.a);
+      writer.write(", ");
+      writer.write(*program.operands[ins.b]);
+      break;
+    case Opcode::compare:
+      writer.put(' ');
+      write_register(writer, ins.a);
+      writer.put(' ');
+      writer.write(operator_symbol(ins.op));
+      writer.put(' ');
+      write_register(writer, ins.b);
+      break;
+    case Opcode::compare_number:
+    case Opcode::compare_string:
+      writer.put(' ');
+      write_register(writer, ins.a);
+      writer.put(' ');
+      writer.write(operator_symbol(ins.op));
+      writer.put(' ');
+      write_constant(writer, program.constants[ins.b]);
+      break;
+    case Opcode::exists_singular:
+      writer.put(' ');
+      write_path(writer, program.paths[ins.b]);
+      break;
+    case Opcode::test:
+      writer.put(' ');
+      writer.write(*program.operands[ins.b]);
+      break;
+    case Opcode::not_:
+      break;
+    case Opcode::jump_if_false:
+    case Opcode::jump_if_true:
+      writer.put(' ');
+      writer.write_int(ins.b);
+      break;
+    }
+    writer.put('\n');
+  }
+}
+
+} // namespace
+
+Program compile_filter(const expression_t& expression) {
+  return Compiler{}.compile(expression);
+}
+
+std::string to_string(const Program& program) {
+  return write_to_string(
+      [&](CanonicalWriter& writer) { write_program(writer, program); });
+}
+
+} // namespace libjsonpath
@@ -0,0 +1,266 @@
+#include "libjsonpath/capi.h"
+#include "libjsonpath/binary.hpp"     // libjsonpath::dump libjsonpath::load
+#include "libjsonpath/config.hpp"     // LIBJSONPATH_VERSION
+#include "libjsonpath/exceptions.hpp" // libjsonpath::Exception
+#include "libjsonpath/hash.hpp"       // libjsonpath::hash
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::to_string
+#include "libjsonpath/parse.hpp"      // libjsonpath::Parser
+#include <algorithm>                  // std::min
+#include <cstring>                    // std::memcpy
+#include <new>                        // std::bad_alloc
+#include <string>                     // std::string
+#include <string_view>                // std::string_view
+
+// An opaque handle to a parsed query. Tokens and function names in
+// _segments_ are views into _source_, so a handle is never copied or moved
+// once it has been populated.
+struct jsonpath_query {
+  std::string source{};
+  libjsonpath::segments_t segments{};
+};
+
+namespace {
+
+// Parsers hold no state, so one instance is shared by all calls.
+const libjsonpath::Parser& parser() {
+  static const libjsonpath::Parser instance{};
+  return instance;
+}
+
+void set_error(jsonpath_error* error, jsonpath_status status,
+    std::string_view message, std::size_t index) {
+  if (error == nullptr) {
+    return;
+  }
+  error->status = status;
+  error->index = index;
+  const auto size{std::min(message.size(), sizeof(error->message) - 1)};
+  std::memcpy(error->message, message.data(), size);
+  error->message[size] = '\0';
+}
+
+// Call _func_, translating any exception it throws to a status code.
+template <typename F>
+jsonpath_status guard(jsonpath_error* error, F func) noexcept {
+  try {
+    func();
+    set_error(error, JSONPATH_OK, "", 0);
+    return JSONPATH_OK;
+  } catch (const libjsonpath::SyntaxError& e) {
+    set_error(error, JSONPATH_SYNTAX_ERROR, e.what(), e.token().index);
+    return JSONPATH_SYNTAX_ERROR;
+  } catch (const libjsonpath::TypeError& e) {
+    set_error(error, JSONPATH_TYPE_ERROR, e.what(), e.token().index);
+    return JSONPATH_TYPE_ERROR;
+  } catch (const libjsonpath::NameError& e) {
+    set_error(error, JSONPATH_NAME_ERROR, e.what(), e.token().index);
+    return JSONPATH_NAME_ERROR;
+  } catch (const libjsonpath::IndexError& e) {
+    set_error(error, JSONPATH_INDEX_ERROR, e.what(), e.token().index);
+    return JSONPATH_INDEX_ERROR;
+  } catch (const libjsonpath::EncodingError& e) {
+    set_error(error, JSONPATH_ENCODING_ERROR, e.what(), e.token().index);
+    return JSONPATH_ENCODING_ERROR;
+  } catch (const libjsonpath::FormatError& e) {
+    set_error(error, JSONPATH_FORMAT_ERROR, e.what(), 0);
+    return JSONPATH_FORMAT_ERROR;
+  } catch (const libjsonpath::Exception& e) {
+    set_error(error, JSONPATH_UNKNOWN_ERROR, e.what(), e.token().index);
+    return JSONPATH_UNKNOWN_ERROR;
+  } catch (const std::bad_alloc&) {
+    set_error(error, JSONPATH_OUT_OF_MEMORY, "out of memory", 0);
+    return JSONPATH_OUT_OF_MEMORY;
+  } catch (const std::exception& e) {
+    set_error(error, JSONPATH_UNKNOWN_ERROR, e.what(), 0);
+    return JSONPATH_UNKNOWN_ERROR;
+  } catch (...) {
+    set_error(error, JSONPATH_UNKNOWN_ERROR, "unknown error", 0);
+    return JSONPATH_UNKNOWN_ERROR;
+  }
+}
+
+// Copy _data_ to _buffer_, truncating to _size_, and report its full length.
+jsonpath_status copy_out(
+    std::string_view data, char* buffer, size_t size, size_t* length) {
+  if (length != nullptr) {
+    *length = data.size();
+  }
+  if (buffer != nullptr) {
+    std::memcpy(buffer, data.data(), std::min(size, data.size()));
+  }
+  return data.size() > size ? JSONPATH_BUFFER_TOO_SMALL : JSONPATH_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+const char* jsonpath_version(void) { return LIBJSONPATH_VERSION; }
+
+const char* jsonpath_status_string(jsonpath_status status) {
+  switch (status) {
+  case JSONPATH_OK:
+    return "ok";
+  case JSONPATH_SYNTAX_ERROR:
+    return "syntax error";
+  case JSONPATH_TYPE_ERROR:
+    return "type error";
+  case JSONPATH_NAME_ERROR:
+    return "name error";
+  case JSONPATH_INDEX_ERROR:
+    return "index error";
+  case JSONPATH_ENCODING_ERROR:
+    return "encoding error";
+  case JSONPATH_FORMAT_ERROR:
+    return "format error";
+  case JSONPATH_BUFFER_TOO_SMALL:
+    return "buffer too small";
+  case JSONPATH_INVALID_ARGUMENT:
+    return "invalid argument";
+  case JSONPATH_OUT_OF_MEMORY:
+    return "out of memory";
+  default:
+    return "unknown error";
+  }
+}
+
+jsonpath_status jsonpath_parse(const char* query, size_t length,
+    jsonpath_query** out, jsonpath_error* error) {
+  if (out == nullptr || (query == nullptr && length > 0)) {
+    set_error(error, JSONPATH_INVALID_ARGUMENT, "invalid argument", 0);
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  *out = nullptr;
+  jsonpath_query* handle{nullptr};
+  auto status{guard(error, [&]() {
+    handle = new jsonpath_query{};
+    handle->source.assign(query == nullptr ? "" : query, length);
+    handle->segments = parser().parse(handle->source);
+  })};
+
+  if (status == JSONPATH_OK) {
+    *out = handle;
+  } else {
+    delete handle;
+  }
+  return status;
+}
+
+jsonpath_status jsonpath_parse_batch(const char* const* queries,
+    const size_t* lengths, size_t count, jsonpath_query** out,
+    jsonpath_status* statuses) {
+  if (out == nullptr ||
+      (count > 0 && (queries == nullptr || lengths == nullptr))) {
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  jsonpath_status rv{JSONPATH_OK};
+  for (size_t i = 0; i < count; i++) {
+    auto status{jsonpath_parse(queries[i], lengths[i], &out[i], nullptr)};
+    if (statuses != nullptr) {
+      statuses[i] = status;
+    }
+    if (rv == JSONPATH_OK) {
+      rv = status;
+    }
+  }
+  return rv;
+}
+
+jsonpath_status jsonpath_load(const char* data, size_t length,
+    jsonpath_query** out, jsonpath_error* error) {
+  if (out == nullptr || data == nullptr) {
+    set_error(error, JSONPATH_INVALID_ARGUMENT, "invalid argument", 0);
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  *out = nullptr;
+  jsonpath_query* handle{nullptr};
+  auto status{guard(error, [&]() {
+    handle = new jsonpath_query{};
+    handle->source.assign(data, length);
+    handle->segments = libjsonpath::load(handle->source);
+  })};
+
+  if (status == JSONPATH_OK) {
+    *out = handle;
+  } else {
+    delete handle;
+  }
+  return status;
+}
+
+void jsonpath_free(jsonpath_query* query) { delete query; }
+
+void jsonpath_free_batch(jsonpath_query** queries, size_t count) {
+  if (queries == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    delete queries[i];
+    queries[i] = nullptr;
+  }
+}
+
+jsonpath_status jsonpath_to_string(const jsonpath_query* query, char* buffer,
+    size_t size, size_t* length) {
+  if (query == nullptr || (buffer == nullptr && size > 0)) {
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  const auto n{libjsonpath::to_string(query->segments, buffer, size)};
+  if (length != nullptr) {
+    *length = n;
+  }
+  return n > size ? JSONPATH_BUFFER_TOO_SMALL : JSONPATH_OK;
+}
+
+jsonpath_status jsonpath_to_string_batch(const jsonpath_query* const* queries,
+    size_t count, char* buffer, size_t size, size_t* offsets) {
+  if (offsets == nullptr || (count > 0 && queries == nullptr) ||
+      (buffer == nullptr && size > 0)) {
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  size_t offset{0};
+  for (size_t i = 0; i < count; i++) {
+    if (queries[i] == nullptr) {
+      return JSONPATH_INVALID_ARGUMENT;
+    }
+    offsets[i] = offset;
+    const auto available{offset < size ? size - offset : 0};
+    offset += libjsonpath::to_string(queries[i]->segments,
+        available ? buffer + offset : nullptr, available);
+  }
+  offsets[count] = offset;
+  return offset > size ? JSONPATH_BUFFER_TOO_SMALL : JSONPATH_OK;
+}
+
+jsonpath_status jsonpath_dump(const jsonpath_query* query, char* buffer,
+    size_t size, size_t* length) {
+  if (query == nullptr || (buffer == nullptr && size > 0)) {
+    return JSONPATH_INVALID_ARGUMENT;
+  }
+
+  std::string data{};
+  auto status{guard(
+      nullptr, [&]() { data = libjsonpath::dump(query->segments); })};
+  if (status != JSONPATH_OK) {
+    return status;
+  }
+  return copy_out(data, buffer, size, length);
+}
+
+uint64_t jsonpath_hash(const jsonpath_query* query) {
+  return query == nullptr ? 0 : libjsonpath::hash(query->segments);
+}
+
+int jsonpath_equal(const jsonpath_query* a, const jsonpath_query* b) {
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  return a->segments == b->segments ? 1 : 0;
+}
+
+} // extern "C"
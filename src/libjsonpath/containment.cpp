@@ -0,0 +1,255 @@
+#include "libjsonpath/containment.hpp"
+#include <algorithm> // std::all_of std::any_of
+#include <cstdint>   // std::int64_t
+#include <utility>   // std::move
+#include <variant>   // std::visit std::holds_alternative std::get_if
+
+namespace libjsonpath {
+
+namespace {
+
+const std::vector<selector_t>& selectors_of(
+    const std::variant<Segment, RecursiveSegment>& segment) {
+  return std::visit(
+      [](const auto& s) -> const std::vector<selector_t>& {
+        return s.selectors;
+      },
+      segment);
+}
+
+// Append the operands of a chain of `&&` to _conjuncts_.
+void collect_conjuncts(const expression_t& expression,
+    std::vector<const expression_t*>& conjuncts) {
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+      infix && (*infix)->op == BinaryOperator::logical_and) {
+    collect_conjuncts((*infix)->left, conjuncts);
+    collect_conjuncts((*infix)->right, conjuncts);
+  } else {
+    conjuncts.push_back(&expression);
+  }
+}
+
+// Return the conjuncts of _a_ that are not conjuncts of _b_, or nothing if
+// some conjunct of _b_ is missing from _a_, in which case _a_ can't be shown
+// to imply _b_.
+std::optional<std::vector<const expression_t*>> extra_conjuncts(
+    const expression_t& a, const expression_t& b) {
+  std::vector<const expression_t*> a_conjuncts{};
+  std::vector<const expression_t*> b_conjuncts{};
+  collect_conjuncts(a, a_conjuncts);
+  collect_conjuncts(b, b_conjuncts);
+
+  auto in{[](const expression_t* x, const auto& conjuncts) {
+    return std::any_of(conjuncts.begin(), conjuncts.end(),
+        [x](const expression_t* y) { return *x == *y; });
+  }};
+
+  for (auto conjunct : b_conjuncts) {
+    if (!in(conjunct, a_conjuncts)) {
+      return std::nullopt;
+    }
+  }
+
+  std::vector<const expression_t*> extra{};
+  for (auto conjunct : a_conjuncts) {
+    if (!in(conjunct, b_conjuncts)) {
+      extra.push_back(conjunct);
+    }
+  }
+  return extra;
+}
+
+// Build a chain of `&&` from _conjuncts_, which must not be empty.
+expression_t conjunction(const std::vector<const expression_t*>& conjuncts) {
+  expression_t chain{*conjuncts.back()};
+  for (auto it = conjuncts.rbegin() + 1; it != conjuncts.rend(); it++) {
+    chain = Box<InfixExpression>(InfixExpression{
+        Token{}, **it, BinaryOperator::logical_and, std::move(chain)});
+  }
+  return chain;
+}
+
+// A slice with a positive step and non-negative bounds, as a half open
+// interval of indices.
+struct IndexRange {
+  std::int64_t start{0};
+  std::optional<std::int64_t> stop{};
+  std::int64_t step{1};
+};
+
+std::optional<IndexRange> index_range(const SliceSelector& slice) {
+  const auto step{slice.step.value_or(1)};
+  if (step < 1 || slice.start.value_or(0) < 0 ||
+      slice.stop.value_or(0) < 0) {
+    return std::nullopt;
+  }
+  return IndexRange{slice.start.value_or(0), slice.stop, step};
+}
+
+// Return true if every node selected by _a_ from any node is also selected
+// by _b_, ignoring filters.
+bool selector_covered(const selector_t& a, const selector_t& b) {
+  if (std::holds_alternative<WildSelector>(b)) {
+    return true;
+  }
+
+  if (auto an{std::get_if<NameSelector>(&a)}) {
+    auto bn{std::get_if<NameSelector>(&b)};
+    return bn && an->name == bn->name;
+  }
+
+  if (auto ai{std::get_if<IndexSelector>(&a)}) {
+    if (auto bi{std::get_if<IndexSelector>(&b)}) {
+      return ai->index == bi->index;
+    }
+    if (auto bs{std::get_if<SliceSelector>(&b)}; bs && ai->index >= 0) {
+      auto range{index_range(*bs)};
+      return range && ai->index >= range->start &&
+             (!range->stop || ai->index < range->stop.value()) &&
+             (ai->index - range->start) % range->step == 0;
+    }
+    return false;
+  }
+
+  if (auto as{std::get_if<SliceSelector>(&a)}) {
+    auto bs{std::get_if<SliceSelector>(&b)};
+    if (!bs) {
+      return false;
+    }
+    if (*as == *bs) {
+      return true;
+    }
+    auto ar{index_range(*as)};
+    auto br{index_range(*bs)};
+    return ar && br && br->step == 1 && ar->start >= br->start &&
+           (!br->stop || (ar->stop && ar->stop.value() <= br->stop.value()));
+  }
+
+  return a == b;
+}
+
+// Return true if _selector_ can be checked against a path step alone, without
+// knowing the length of the array the step came from.
+bool is_location_selector(const selector_t& selector) {
+  if (auto index{std::get_if<IndexSelector>(&selector)}) {
+    return index->index >= 0;
+  }
+  if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+    return index_range(*slice).has_value();
+  }
+  return std::holds_alternative<NameSelector>(selector);
+}
+
+bool selects_step(const selector_t& selector, const path_step_t& step) {
+  if (auto name{std::get_if<NameSelector>(&selector)}) {
+    auto s{std::get_if<std::string>(&step)};
+    return s && *s == name->name;
+  }
+
+  auto i{std::get_if<std::int64_t>(&step)};
+  if (!i) {
+    return false;
+  }
+
+  if (auto index{std::get_if<IndexSelector>(&selector)}) {
+    return *i == index->index;
+  }
+
+  auto range{index_range(std::get<SliceSelector>(selector))};
+  return *i >= range->start && (!range->stop || *i < range->stop.value()) &&
+         (*i - range->start) % range->step == 0;
+}
+
+} // namespace
+
+bool Residual::matches_location(
+    const std::vector<path_step_t>& location) const {
+  for (const auto& restriction : restrictions) {
+    if (restriction.segment >= location.size()) {
+      return false;
+    }
+
+    const auto& step{location[restriction.segment]};
+    if (!std::any_of(restriction.selectors.begin(),
+            restriction.selectors.end(),
+            [&step](const auto& s) { return selects_step(s, step); })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<Residual> contained_in(
+    const segments_t& a, const segments_t& b) {
+  if (a.size() != b.size()) {
+    return std::nullopt;
+  }
+
+  Residual residual{};
+  bool child_segments_only{true};
+
+  for (std::size_t i = 0; i < a.size(); i++) {
+    if (a[i].index() != b[i].index()) {
+      return std::nullopt;
+    }
+
+    const bool descendant{std::holds_alternative<RecursiveSegment>(b[i])};
+    child_segments_only = child_segments_only && !descendant;
+
+    const auto& a_selectors{selectors_of(a[i])};
+    const auto& b_selectors{selectors_of(b[i])};
+    if (a_selectors == b_selectors) {
+      continue;
+    }
+
+    const bool last{i + 1 == a.size()};
+
+    // A single filter, narrowed by extra conjuncts or in place of a
+    // wildcard. The filter applies to nodes selected by this segment, so it
+    // can only be checked against the results if this is the last segment.
+    if (a_selectors.size() == 1 && b_selectors.size() == 1 && last) {
+      auto af{std::get_if<Box<FilterSelector>>(&a_selectors.front())};
+      if (af && std::holds_alternative<WildSelector>(b_selectors.front())) {
+        residual.filter = (*af)->expression;
+        continue;
+      }
+
+      auto bf{std::get_if<Box<FilterSelector>>(&b_selectors.front())};
+      if (af && bf) {
+        auto extra{extra_conjuncts((*af)->expression, (*bf)->expression)};
+        if (!extra) {
+          return std::nullopt;
+        }
+        if (!extra->empty()) {
+          residual.filter = conjunction(extra.value());
+        }
+        continue;
+      }
+    }
+
+    // Narrower names, indices and slices. Each path step added by a child
+    // segment corresponds to one segment, but only while there are no
+    // descendant segments.
+    const bool covered{std::all_of(
+        a_selectors.begin(), a_selectors.end(), [&](const selector_t& s) {
+          return std::any_of(b_selectors.begin(), b_selectors.end(),
+              [&](const selector_t& t) { return selector_covered(s, t); });
+        })};
+
+    if (!covered) {
+      return std::nullopt;
+    }
+
+    if (!child_segments_only ||
+        !std::all_of(a_selectors.begin(), a_selectors.end(),
+            is_location_selector)) {
+      return std::nullopt;
+    }
+
+    residual.restrictions.push_back(LocationRestriction{i, a_selectors});
+  }
+
+  return residual;
+}
+
+} // namespace libjsonpath
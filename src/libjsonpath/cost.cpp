@@ -0,0 +1,204 @@
+#include "libjsonpath/cost.hpp"
+#include "libjsonpath/utils.hpp" // libjsonpath::singular_query
+#include <algorithm>             // std::max std::sort
+#include <tuple>                 // std::tie
+#include <variant>               // std::visit std::holds_alternative
+
+namespace libjsonpath {
+
+namespace {
+
+// A sum of cost terms, kept sorted with one term per pair of exponents.
+class Polynomial {
+public:
+  Polynomial() = default;
+  Polynomial(CostTerm term) { add(term); }
+
+  const std::vector<CostTerm>& terms() const noexcept { return m_terms; }
+
+  void add(const CostTerm& term) {
+    if (term.coefficient == 0) {
+      return;
+    }
+    for (auto& t : m_terms) {
+      if (t.nodes_exponent == term.nodes_exponent &&
+          t.depth_exponent == term.depth_exponent) {
+        t.coefficient = add_cost(t.coefficient, term.coefficient);
+        return;
+      }
+    }
+    m_terms.push_back(term);
+    std::sort(m_terms.begin(), m_terms.end(), [](const auto& a, const auto& b) {
+      return std::tie(a.nodes_exponent, a.depth_exponent) >
+             std::tie(b.nodes_exponent, b.depth_exponent);
+    });
+  }
+
+  void add(const Polynomial& other) {
+    for (const auto& term : other.m_terms) {
+      add(term);
+    }
+  }
+
+  Polynomial times(const CostTerm& term) const {
+    Polynomial result{};
+    for (const auto& t : m_terms) {
+      result.add(CostTerm{mul_cost(t.coefficient, term.coefficient),
+          t.nodes_exponent + term.nodes_exponent,
+          t.depth_exponent + term.depth_exponent});
+    }
+    return result;
+  }
+
+  // Return a single term bounding this polynomial, given N and D are at
+  // least one.
+  CostTerm dominant() const {
+    CostTerm result{};
+    for (const auto& t : m_terms) {
+      result.coefficient = add_cost(result.coefficient, t.coefficient);
+      result.nodes_exponent = std::max(result.nodes_exponent, t.nodes_exponent);
+      result.depth_exponent = std::max(result.depth_exponent, t.depth_exponent);
+    }
+    return result;
+  }
+
+private:
+  std::vector<CostTerm> m_terms{};
+};
+
+// The nodes reachable from a nodelist of size _size_ in one step: all
+// children, or all descendants. A constant sized nodelist can reach every
+// node in the document. Otherwise each distinct node has one parent and at
+// most D ancestors, so a nodelist's children are bounded by its own size
+// and its descendants by its size times D.
+CostTerm expand(const CostTerm& size, bool descendants) {
+  if (size.nodes_exponent == 0) {
+    return CostTerm{size.coefficient, 1, 0};
+  }
+  return CostTerm{size.coefficient, size.nodes_exponent,
+      size.depth_exponent + (descendants ? 1 : 0)};
+}
+
+struct CostAnalysis {
+  CostEstimate& m_estimate;
+
+  // Work done once per evaluation, like resolving root queries in filters.
+  Polynomial m_once{};
+
+  // Return the work needed to resolve _path_ from a single node.
+  Polynomial path_cost(const segments_t& path, std::size_t filter_depth) {
+    Polynomial work{};
+    CostTerm size{1, 0, 0};
+
+    for (const auto& segment : path) {
+      const bool descendant{std::holds_alternative<RecursiveSegment>(segment)};
+      const auto& selectors{std::visit(
+          [](const auto& s) -> const std::vector<selector_t>& {
+            return s.selectors;
+          },
+          segment)};
+
+      if (descendant) {
+        m_estimate.descendant_segments++;
+      }
+
+      // Nodes the selectors of this segment are applied to.
+      const CostTerm visited{descendant ? expand(size, true) : size};
+      work.add(visited);
+
+      const CostTerm children{expand(visited, false)};
+      Polynomial out{};
+
+      for (const auto& selector : selectors) {
+        if (std::holds_alternative<NameSelector>(selector) ||
+            std::holds_alternative<IndexSelector>(selector)) {
+          out.add(visited);
+        } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+          out.add(children);
+          m_estimate.filter_depth =
+              std::max(m_estimate.filter_depth, filter_depth + 1);
+          work.add(expression_cost((*filter)->expression, filter_depth + 1)
+                       .times(children));
+        } else {
+          out.add(children);
+        }
+      }
+
+      work.add(out);
+      size = out.dominant();
+    }
+    return work;
+  }
+
+  // Return the work needed to evaluate _expression_ for one candidate node.
+  Polynomial expression_cost(
+      const expression_t& expression, std::size_t filter_depth) {
+    Polynomial cost{CostTerm{1, 0, 0}};
+
+    if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+      cost.add(expression_cost((*not_)->right, filter_depth));
+    } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+      cost.add(expression_cost((*infix)->left, filter_depth));
+      cost.add(expression_cost((*infix)->right, filter_depth));
+    } else if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+      cost.add(path_cost((*relative)->query, filter_depth));
+    } else if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+      m_once.add(path_cost((*root)->query, filter_depth));
+    } else if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+      if ((*call)->name == "match" || (*call)->name == "search") {
+        m_estimate.regex_functions++;
+      }
+      for (const auto& arg : (*call)->args) {
+        cost.add(expression_cost(arg, filter_depth));
+      }
+    }
+    return cost;
+  }
+};
+
+} // namespace
+
+std::uint64_t CostEstimate::bound(
+    std::uint64_t nodes, std::uint64_t depth) const {
+  std::uint64_t total{0};
+  for (const auto& term : terms) {
+    std::uint64_t value{term.coefficient};
+    for (unsigned i = 0; i < term.nodes_exponent; i++) {
+      value = mul_cost(value, nodes);
+    }
+    for (unsigned i = 0; i < term.depth_exponent; i++) {
+      value = mul_cost(value, depth);
+    }
+    total = add_cost(total, value);
+  }
+  return total;
+}
+
+CostEstimate estimate_cost(const segments_t& path) {
+  CostEstimate estimate{};
+  CostAnalysis analysis{estimate};
+
+  auto work{analysis.path_cost(path, 0)};
+  work.add(analysis.m_once);
+  estimate.terms = work.terms();
+  estimate.singular = singular_query(path);
+
+  // Terms are sorted by exponent, so the first term dominates.
+  if (!estimate.terms.empty()) {
+    estimate.nodes_exponent = estimate.terms.front().nodes_exponent;
+    estimate.depth_exponent = estimate.terms.front().depth_exponent;
+  }
+
+  if (estimate.nodes_exponent == 0) {
+    estimate.complexity = ComplexityClass::constant;
+  } else if (estimate.nodes_exponent > 1) {
+    estimate.complexity = ComplexityClass::polynomial;
+  } else if (estimate.depth_exponent > 0) {
+    estimate.complexity = ComplexityClass::linear_depth;
+  } else {
+    estimate.complexity = ComplexityClass::linear;
+  }
+  return estimate;
+}
+
+} // namespace libjsonpath
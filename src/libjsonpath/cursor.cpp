@@ -0,0 +1,253 @@
+#include "libjsonpath/cursor.hpp"
+#include "libjsonpath/exceptions.hpp" // libjsonpath::CursorError
+#include <cstddef>                    // std::size_t
+#include <variant>                    // std::get_if std::get
+
+namespace libjsonpath {
+
+using namespace std::string_literals;
+
+namespace {
+
+// Tokens are base64url encoded, without padding, so they can be used in URLs
+// as they are.
+constexpr std::string_view ALPHABET{
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+
+constexpr std::uint8_t FLAG_DONE{1};
+constexpr std::uint8_t FLAG_RETURNED{2};
+
+constexpr std::uint8_t STEP_INDEX{0};
+constexpr std::uint8_t STEP_NAME{1};
+
+void put_varint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// Signed integers are zigzag encoded, so small negative numbers stay small.
+void put_signed(std::string& out, std::int64_t value) {
+  put_varint(out, (static_cast<std::uint64_t>(value) << 1) ^
+                      static_cast<std::uint64_t>(value >> 63));
+}
+
+std::string encode_base64(std::string_view bytes) {
+  std::string rv{};
+  rv.reserve((bytes.size() * 4 + 2) / 3);
+  std::size_t i{0};
+  for (; i + 2 < bytes.size(); i += 3) {
+    const auto n{(static_cast<std::uint32_t>(
+                      static_cast<unsigned char>(bytes[i]))
+                     << 16) |
+                 (static_cast<std::uint32_t>(
+                      static_cast<unsigned char>(bytes[i + 1]))
+                     << 8) |
+                 static_cast<unsigned char>(bytes[i + 2])};
+    rv.push_back(ALPHABET[(n >> 18) & 0x3F]);
+    rv.push_back(ALPHABET[(n >> 12) & 0x3F]);
+    rv.push_back(ALPHABET[(n >> 6) & 0x3F]);
+    rv.push_back(ALPHABET[n & 0x3F]);
+  }
+
+  const auto rest{bytes.size() - i};
+  if (rest > 0) {
+    std::uint32_t n{static_cast<std::uint32_t>(
+                        static_cast<unsigned char>(bytes[i]))
+                    << 16};
+    if (rest == 2) {
+      n |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[i + 1]))
+           << 8;
+    }
+    rv.push_back(ALPHABET[(n >> 18) & 0x3F]);
+    rv.push_back(ALPHABET[(n >> 12) & 0x3F]);
+    if (rest == 2) {
+      rv.push_back(ALPHABET[(n >> 6) & 0x3F]);
+    }
+  }
+  return rv;
+}
+
+std::string decode_base64(std::string_view text) {
+  if (text.size() % 4 == 1) {
+    throw CursorError("malformed cursor token");
+  }
+
+  std::string rv{};
+  rv.reserve(text.size() * 3 / 4);
+  std::uint32_t n{0};
+  int bits{0};
+  for (const auto ch : text) {
+    const auto value{ALPHABET.find(ch)};
+    if (value == std::string_view::npos) {
+      throw CursorError("malformed cursor token");
+    }
+    n = (n << 6) | static_cast<std::uint32_t>(value);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      rv.push_back(static_cast<char>((n >> bits) & 0xFF));
+    }
+  }
+  return rv;
+}
+
+class Reader {
+public:
+  Reader(std::string_view bytes) : m_bytes{bytes} {};
+
+  bool at_end() const noexcept { return m_pos == m_bytes.size(); }
+
+  std::uint8_t byte() {
+    if (m_pos >= m_bytes.size()) {
+      truncated();
+    }
+    return static_cast<std::uint8_t>(m_bytes[m_pos++]);
+  }
+
+  std::uint64_t fixed64() {
+    std::uint64_t value{0};
+    for (int i = 0; i < 8; i++) {
+      value |= static_cast<std::uint64_t>(byte()) << (i * 8);
+    }
+    return value;
+  }
+
+  std::uint64_t varint() {
+    std::uint64_t value{0};
+    for (int shift = 0; shift < 64; shift += 7) {
+      const auto b{byte()};
+      value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) {
+        return value;
+      }
+    }
+    throw CursorError("malformed cursor token");
+  }
+
+  std::int64_t signed_varint() {
+    const auto value{varint()};
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+  }
+
+  // Read a count of items that each take at least one byte, so malformed
+  // counts are caught before anything is allocated.
+  std::size_t count() {
+    const auto value{varint()};
+    if (value > m_bytes.size() - m_pos) {
+      truncated();
+    }
+    return static_cast<std::size_t>(value);
+  }
+
+  std::string_view bytes(std::size_t size) {
+    if (size > m_bytes.size() - m_pos) {
+      truncated();
+    }
+    auto rv{m_bytes.substr(m_pos, size)};
+    m_pos += size;
+    return rv;
+  }
+
+private:
+  std::string_view m_bytes;
+  std::size_t m_pos{0};
+
+  [[noreturn]] static void truncated() {
+    throw CursorError("truncated cursor token");
+  }
+};
+
+} // namespace
+
+// Token layout, before base64url encoding:
+//
+//   u8 version   u64 query hash   u8 flags
+//   varint entry count, then for each entry
+//     varint segment   varint selector   u8 started   zigzag varint index
+//   varint location count, then for each step
+//     u8 0 and a zigzag varint index, or u8 1, a varint length and a name
+//
+// The query hash is little endian. All other integers are LEB128 varints.
+std::string Cursor::to_token() const {
+  std::string bytes{};
+  bytes.push_back(static_cast<char>(CURSOR_FORMAT_VERSION));
+  for (int i = 0; i < 8; i++) {
+    bytes.push_back(static_cast<char>((query_hash >> (i * 8)) & 0xFF));
+  }
+  bytes.push_back(static_cast<char>((done ? FLAG_DONE : 0) |
+                                    (returned ? FLAG_RETURNED : 0)));
+
+  put_varint(bytes, entries.size());
+  for (const auto& entry : entries) {
+    put_varint(bytes, entry.segment);
+    put_varint(bytes, entry.selector);
+    bytes.push_back(static_cast<char>(entry.started ? 1 : 0));
+    put_signed(bytes, entry.index);
+  }
+
+  put_varint(bytes, location.size());
+  for (const auto& step : location) {
+    if (auto name{std::get_if<std::string>(&step)}) {
+      bytes.push_back(static_cast<char>(STEP_NAME));
+      put_varint(bytes, name->size());
+      bytes.append(*name);
+    } else {
+      bytes.push_back(static_cast<char>(STEP_INDEX));
+      put_signed(bytes, std::get<std::int64_t>(step));
+    }
+  }
+
+  return encode_base64(bytes);
+}
+
+Cursor Cursor::from_token(std::string_view token) {
+  const auto bytes{decode_base64(token)};
+  Reader reader{bytes};
+
+  const auto version{reader.byte()};
+  if (version != CURSOR_FORMAT_VERSION) {
+    throw CursorError(
+        "unsupported cursor token version "s + std::to_string(version));
+  }
+
+  Cursor cursor{};
+  cursor.query_hash = reader.fixed64();
+  const auto flags{reader.byte()};
+  cursor.done = flags & FLAG_DONE;
+  cursor.returned = flags & FLAG_RETURNED;
+
+  const auto entry_count{reader.count()};
+  cursor.entries.reserve(entry_count);
+  for (std::size_t i = 0; i < entry_count; i++) {
+    CursorEntry entry{};
+    entry.segment = reader.varint();
+    entry.selector = reader.varint();
+    entry.started = reader.byte() != 0;
+    entry.index = reader.signed_varint();
+    cursor.entries.push_back(entry);
+  }
+
+  const auto step_count{reader.count()};
+  cursor.location.reserve(step_count);
+  for (std::size_t i = 0; i < step_count; i++) {
+    const auto tag{reader.byte()};
+    if (tag == STEP_NAME) {
+      cursor.location.emplace_back(std::string{reader.bytes(reader.count())});
+    } else if (tag == STEP_INDEX) {
+      cursor.location.emplace_back(reader.signed_varint());
+    } else {
+      throw CursorError("malformed cursor token");
+    }
+  }
+
+  if (!reader.at_end()) {
+    throw CursorError("malformed cursor token");
+  }
+  return cursor;
+}
+
+} // namespace libjsonpath
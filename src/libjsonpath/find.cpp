@@ -0,0 +1,126 @@
+#include "libjsonpath/find.hpp"
+
+namespace libjsonpath {
+
+namespace {
+
+// Decode the UTF-8 string _value_ to a wide string. Invalid sequences are
+// replaced with U+FFFD.
+std::wstring widen(std::string_view value) {
+  std::wstring rv{};
+  rv.reserve(value.size());
+
+  for (std::size_t i = 0; i < value.size();) {
+    const auto ch{static_cast<unsigned char>(value[i])};
+    std::size_t length{1};
+    char32_t code_point{0xFFFD};
+
+    if (ch < 0x80) {
+      code_point = ch;
+    } else if ((ch & 0xE0) == 0xC0) {
+      length = 2;
+      code_point = ch & 0x1F;
+    } else if ((ch & 0xF0) == 0xE0) {
+      length = 3;
+      code_point = ch & 0x0F;
+    } else if ((ch & 0xF8) == 0xF0) {
+      length = 4;
+      code_point = ch & 0x07;
+    }
+
+    if (i + length > value.size()) {
+      length = 1;
+      code_point = 0xFFFD;
+    }
+
+    for (std::size_t j = 1; j < length; j++) {
+      const auto cont{static_cast<unsigned char>(value[i + j])};
+      if ((cont & 0xC0) != 0x80) {
+        length = j;
+        code_point = 0xFFFD;
+        break;
+      }
+      code_point = (code_point << 6) | (cont & 0x3F);
+    }
+
+    if constexpr (sizeof(wchar_t) >= 4) {
+      rv.push_back(static_cast<wchar_t>(code_point));
+    } else if (code_point < 0x10000) {
+      rv.push_back(static_cast<wchar_t>(code_point));
+    } else {
+      code_point -= 0x10000;
+      rv.push_back(static_cast<wchar_t>(0xD800 + (code_point >> 10)));
+      rv.push_back(static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF)));
+    }
+    i += length;
+  }
+  return rv;
+}
+
+// Translate the I-Regexp (RFC 9485) _pattern_ to an ECMAScript regular
+// expression. An I-Regexp `.` matches any character except line feed and
+// carriage return, where an ECMAScript `.` excludes other line terminators
+// too.
+std::wstring translate(std::string_view pattern) {
+  const auto wide{widen(pattern)};
+  std::wstring rv{};
+  rv.reserve(wide.size());
+
+  bool in_class{false};
+  for (std::size_t i = 0; i < wide.size(); i++) {
+    const auto ch{wide[i]};
+    if (ch == L'\\' && i + 1 < wide.size()) {
+      rv.push_back(ch);
+      rv.push_back(wide[++i]);
+    } else if (in_class) {
+      in_class = ch != L']';
+      rv.push_back(ch);
+    } else if (ch == L'[') {
+      in_class = true;
+      rv.push_back(ch);
+    } else if (ch == L'.') {
+      rv.append(L"[^\n\r]");
+    } else {
+      rv.push_back(ch);
+    }
+  }
+  return rv;
+}
+
+} // namespace
+
+bool RegexCache::matches(
+    std::string_view pattern, std::string_view value, bool full) {
+  auto it{m_cache.find(std::string{pattern})};
+  if (it == m_cache.end()) {
+    std::unique_ptr<std::wregex> re{};
+    try {
+      re = std::make_unique<std::wregex>(
+          translate(pattern), std::regex_constants::ECMAScript);
+    } catch (const std::regex_error&) {
+      // Not a pattern we can use, which never matches.
+    }
+    it = m_cache.emplace(std::string{pattern}, std::move(re)).first;
+  }
+
+  if (!it->second) {
+    return false;
+  }
+
+  const auto subject{widen(value)};
+  return full ? std::regex_match(subject, *it->second)
+              : std::regex_search(subject, *it->second);
+}
+
+std::size_t utf8_length(std::string_view value) noexcept {
+  std::size_t length{0};
+  for (const auto ch : value) {
+    // Count every byte that isn't a continuation byte.
+    if ((static_cast<unsigned char>(ch) & 0xC0) != 0x80) {
+      length++;
+    }
+  }
+  return length;
+}
+
+} // namespace libjsonpath
@@ -0,0 +1,197 @@
+#include "libjsonpath/footprint.hpp"
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::write_to_string
+#include <algorithm>                // std::any_of std::find
+#include <variant>                  // std::visit std::get_if
+
+namespace libjsonpath {
+
+namespace {
+
+void add_expression(KeyFootprint& footprint, std::size_t current,
+    const expression_t& expression);
+
+// Add _path_ starting from the footprint node _start_, returning the nodes
+// it ends at.
+std::vector<std::size_t> add_path(
+    KeyFootprint& footprint, std::size_t start, const segments_t& path) {
+  std::vector<std::size_t> current{start};
+
+  for (const auto& segment : path) {
+    const bool descendant{std::holds_alternative<RecursiveSegment>(segment)};
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+
+    std::vector<std::size_t> next{};
+    auto push{[&next](std::size_t index) {
+      if (std::find(next.begin(), next.end(), index) == next.end()) {
+        next.push_back(index);
+      }
+    }};
+
+    for (auto index : current) {
+      const auto base{descendant ? footprint.add_any_depth(index) : index};
+      for (const auto& selector : selectors) {
+        if (auto name{std::get_if<NameSelector>(&selector)}) {
+          push(footprint.add_name(base, name->name));
+        } else {
+          const auto child{footprint.add_any_key(base)};
+          if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+            add_expression(footprint, child, (*filter)->expression);
+          }
+          push(child);
+        }
+      }
+    }
+    current = std::move(next);
+  }
+  return current;
+}
+
+// Add the footprint of a filter expression evaluated with _current_ as the
+// current node.
+void add_expression(KeyFootprint& footprint, std::size_t current,
+    const expression_t& expression) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    add_expression(footprint, current, (*not_)->right);
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    add_expression(footprint, current, (*infix)->left);
+    add_expression(footprint, current, (*infix)->right);
+  } else if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    for (const auto& arg : (*call)->args) {
+      add_expression(footprint, current, arg);
+    }
+  } else if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    for (auto index : add_path(footprint, current, (*relative)->query)) {
+      footprint.set_whole(index);
+    }
+  } else if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    for (auto index : add_path(footprint, 0, (*root)->query)) {
+      footprint.set_whole(index);
+    }
+  }
+}
+
+std::string quote_name(const std::string& name) {
+  return write_to_string(
+      [&](CanonicalWriter& writer) { writer.write_name(name); });
+}
+
+} // namespace
+
+std::size_t KeyFootprint::add_node() {
+  m_nodes.emplace_back();
+  return m_nodes.size() - 1;
+}
+
+std::size_t KeyFootprint::add_name(
+    std::size_t parent, const std::string& name) {
+  if (auto it{m_nodes.at(parent).names.find(name)};
+      it != m_nodes[parent].names.end()) {
+    return it->second;
+  }
+  const auto child{add_node()};
+  m_nodes[parent].names.emplace(name, child);
+  return child;
+}
+
+std::size_t KeyFootprint::add_any_key(std::size_t parent) {
+  if (!m_nodes.at(parent).any_key) {
+    const auto child{add_node()};
+    m_nodes[parent].any_key = child;
+  }
+  return m_nodes[parent].any_key.value();
+}
+
+std::size_t KeyFootprint::add_any_depth(std::size_t parent) {
+  if (!m_nodes.at(parent).any_depth) {
+    const auto child{add_node()};
+    m_nodes[parent].any_depth = child;
+  }
+  return m_nodes[parent].any_depth.value();
+}
+
+bool KeyFootprint::has_any_key() const noexcept {
+  return std::any_of(m_nodes.begin(), m_nodes.end(),
+      [](const Node& node) { return node.any_key.has_value(); });
+}
+
+bool KeyFootprint::has_any_depth() const noexcept {
+  return std::any_of(m_nodes.begin(), m_nodes.end(),
+      [](const Node& node) { return node.any_depth.has_value(); });
+}
+
+std::set<std::string> KeyFootprint::names() const {
+  std::set<std::string> result{};
+  for (const auto& node : m_nodes) {
+    for (const auto& [name, _] : node.names) {
+      result.insert(name);
+    }
+  }
+  return result;
+}
+
+std::string KeyFootprint::to_string() const {
+  std::string out{};
+  write(0, out);
+  return out;
+}
+
+void KeyFootprint::write(std::size_t index, std::string& out) const {
+  const auto& node{m_nodes[index]};
+  const bool has_children{
+      !node.names.empty() || node.any_key || node.any_depth};
+
+  if (node.whole) {
+    out.push_back('!');
+  }
+  if (!has_children) {
+    if (!node.whole) {
+      out += "{}";
+    }
+    return;
+  }
+
+  out.push_back('{');
+  bool first{true};
+  auto separate{[&]() {
+    if (!first) {
+      out += ", ";
+    }
+    first = false;
+  }};
+
+  for (const auto& [name, child] : node.names) {
+    separate();
+    out += quote_name(name);
+    out += ": ";
+    write(child, out);
+  }
+  if (node.any_key) {
+    separate();
+    out += "*: ";
+    write(node.any_key.value(), out);
+  }
+  if (node.any_depth) {
+    separate();
+    out += "..: ";
+    write(node.any_depth.value(), out);
+  }
+  out.push_back('}');
+}
+
+KeyFootprint key_footprint(const segments_t& path) {
+  KeyFootprint footprint{};
+  add_footprint(footprint, path);
+  return footprint;
+}
+
+void add_footprint(KeyFootprint& footprint, const segments_t& path) {
+  for (auto index : add_path(footprint, 0, path)) {
+    footprint.set_whole(index);
+  }
+}
+
+} // namespace libjsonpath
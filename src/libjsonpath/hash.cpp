@@ -0,0 +1,192 @@
+#include "libjsonpath/hash.hpp"
+#include <cstring>     // std::memcpy
+#include <string_view> // std::string_view
+#include <variant>     // std::visit
+
+namespace libjsonpath {
+
+// Node tags fed to the hash ahead of each node's contents. These values are
+// part of the stable hash format. Don't reorder them.
+enum class HashTag : std::uint8_t {
+  segment = 1,
+  recursive_segment,
+  name_selector,
+  index_selector,
+  wild_selector,
+  slice_selector,
+  filter_selector,
+  null_literal,
+  boolean_literal,
+  integer_literal,
+  float_literal,
+  string_literal,
+  logical_not,
+  infix,
+  relative_query,
+  root_query,
+  function_call,
+  absent,
+};
+
+// A _segments_t_, _selector_t_ and _expression_t_ visitor feeding each node
+// of a parse tree into a 64-bit FNV-1a hash. Integers are fed in little
+// endian byte order, so the result does not depend on the host.
+struct HashVisitor {
+  static constexpr std::uint64_t OFFSET_BASIS{14695981039346656037ULL};
+  static constexpr std::uint64_t PRIME{1099511628211ULL};
+
+  std::uint64_t m_state{OFFSET_BASIS};
+
+  void byte(std::uint8_t b) {
+    m_state ^= b;
+    m_state *= PRIME;
+  }
+
+  void tag(HashTag t) { byte(static_cast<std::uint8_t>(t)); }
+
+  void integer(std::uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      byte(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void string(std::string_view value) {
+    integer(value.size());
+    for (const auto ch : value) {
+      byte(static_cast<std::uint8_t>(ch));
+    }
+  }
+
+  void optional_integer(const std::optional<std::int64_t>& value) {
+    if (value) {
+      integer(static_cast<std::uint64_t>(value.value()));
+    } else {
+      tag(HashTag::absent);
+    }
+  }
+
+  void operator()(const Segment& segment) {
+    tag(HashTag::segment);
+    selectors(segment.selectors);
+  }
+
+  void operator()(const RecursiveSegment& segment) {
+    tag(HashTag::recursive_segment);
+    selectors(segment.selectors);
+  }
+
+  void operator()(const NameSelector& selector) {
+    tag(HashTag::name_selector);
+    string(selector.name);
+  }
+
+  void operator()(const IndexSelector& selector) {
+    tag(HashTag::index_selector);
+    integer(static_cast<std::uint64_t>(selector.index));
+  }
+
+  void operator()(const WildSelector&) { tag(HashTag::wild_selector); }
+
+  void operator()(const SliceSelector& selector) {
+    tag(HashTag::slice_selector);
+    optional_integer(selector.start);
+    optional_integer(selector.stop);
+    integer(static_cast<std::uint64_t>(selector.step.value_or(1)));
+  }
+
+  void operator()(const Box<FilterSelector>& selector) {
+    tag(HashTag::filter_selector);
+    std::visit(*this, selector->expression);
+  }
+
+  void operator()(const NullLiteral&) { tag(HashTag::null_literal); }
+
+  void operator()(const BooleanLiteral& expression) {
+    tag(HashTag::boolean_literal);
+    byte(expression.value ? 1 : 0);
+  }
+
+  void operator()(const IntegerLiteral& expression) {
+    tag(HashTag::integer_literal);
+    integer(static_cast<std::uint64_t>(expression.value));
+  }
+
+  void operator()(const FloatLiteral& expression) {
+    tag(HashTag::float_literal);
+    // -0.0 compares equal to 0.0, so it must hash the same too.
+    const double value{expression.value == 0.0 ? 0.0 : expression.value};
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    integer(bits);
+  }
+
+  void operator()(const StringLiteral& expression) {
+    tag(HashTag::string_literal);
+    string(expression.value);
+  }
+
+  void operator()(const Box<LogicalNotExpression>& expression) {
+    tag(HashTag::logical_not);
+    std::visit(*this, expression->right);
+  }
+
+  void operator()(const Box<InfixExpression>& expression) {
+    tag(HashTag::infix);
+    byte(static_cast<std::uint8_t>(expression->op));
+    std::visit(*this, expression->left);
+    std::visit(*this, expression->right);
+  }
+
+  void operator()(const Box<RelativeQuery>& expression) {
+    tag(HashTag::relative_query);
+    segments(expression->query);
+  }
+
+  void operator()(const Box<RootQuery>& expression) {
+    tag(HashTag::root_query);
+    segments(expression->query);
+  }
+
+  void operator()(const Box<FunctionCall>& expression) {
+    tag(HashTag::function_call);
+    string(expression->name);
+    integer(expression->args.size());
+    for (const auto& arg : expression->args) {
+      std::visit(*this, arg);
+    }
+  }
+
+  void segments(const segments_t& path) {
+    integer(path.size());
+    for (const auto& segment : path) {
+      std::visit(*this, segment);
+    }
+  }
+
+  void selectors(const std::vector<selector_t>& items) {
+    integer(items.size());
+    for (const auto& selector : items) {
+      std::visit(*this, selector);
+    }
+  }
+};
+
+std::uint64_t hash(const segments_t& path) {
+  HashVisitor visitor{};
+  visitor.segments(path);
+  return visitor.m_state;
+}
+
+std::uint64_t hash(const selector_t& selector) {
+  HashVisitor visitor{};
+  std::visit(visitor, selector);
+  return visitor.m_state;
+}
+
+std::uint64_t hash(const expression_t& expression) {
+  HashVisitor visitor{};
+  std::visit(visitor, expression);
+  return visitor.m_state;
+}
+
+} // namespace libjsonpath
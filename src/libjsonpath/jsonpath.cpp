@@ -3,6 +3,11 @@
 #include "libjsonpath/lex.hpp"        // libjsonpath::Lexer
 #include "libjsonpath/parse.hpp"      // libjsonpath::Parser
 #include "libjsonpath/tokens.hpp"     // libjsonpath::TokenType
+#include <algorithm>                  // std::min
+#include <charconv>                   // std::to_chars
+#include <cstdio>                     // std::snprintf
+#include <cstdlib>                    // std::strtod
+#include <cstring>                    // std::memcpy
 #include <string>                     // std::string
 #include <variant>                    // std::visit
 
@@ -34,21 +39,307 @@ segments_t parse(std::string_view s,
 }
 
 std::string to_string(const segments_t& path) {
-  std::string rv{"$"};
-  for (const auto& segment : path) {
-    rv += std::visit(SegmentToStringVisitor(), segment);
-  }
+  std::string rv{};
+  to_string(path, rv);
   return rv;
 }
 
+void to_string(const segments_t& path, std::string& buffer) {
+  buffer.resize(to_string_length(path));
+  CanonicalWriter writer{buffer.data(), buffer.size()};
+  writer.write(path);
+}
+
+std::size_t to_string(const segments_t& path, char* buffer, std::size_t size) {
+  CanonicalWriter writer{buffer, size};
+  writer.write(path);
+  return writer.length();
+}
+
+std::size_t to_string_length(const segments_t& path) {
+  CanonicalWriter writer{};
+  writer.write(path);
+  return writer.length();
+}
+
+static std::string_view binary_operator_to_string(BinaryOperator op) {
+  switch (op) {
+  case BinaryOperator::logical_and:
+    return "&&";
+  case BinaryOperator::logical_or:
+    return "||";
+  case BinaryOperator::eq:
+    return "==";
+  case BinaryOperator::ge:
+    return ">=";
+  case BinaryOperator::gt:
+    return ">";
+  case BinaryOperator::le:
+    return "<=";
+  case BinaryOperator::lt:
+    return "<";
+  case BinaryOperator::ne:
+    return "!=";
+  default:
+    return "OPERATOR ERROR";
+  }
+}
+
+void CanonicalWriter::put(char ch) noexcept {
+  if (m_length < m_size) {
+    m_buffer[m_length] = ch;
+  }
+  m_length++;
+}
+
+void CanonicalWriter::write(std::string_view sv) noexcept {
+  if (m_length < m_size) {
+    std::memcpy(
+        m_buffer + m_length, sv.data(), std::min(sv.size(), m_size - m_length));
+  }
+  m_length += sv.size();
+}
+
+// A _segments_t_, _selector_t_ and _expression_t_ visitor writing the
+// canonical representation of each node to a CanonicalWriter.
+struct CanonicalWriterVisitor {
+  CanonicalWriter& m_writer;
+
+  void operator()(const Segment& segment) const {
+    m_writer.put('[');
+    write_selectors(segment.selectors);
+    m_writer.put(']');
+  }
+
+  void operator()(const RecursiveSegment& segment) const {
+    m_writer.write("..[");
+    write_selectors(segment.selectors);
+    m_writer.put(']');
+  }
+
+  void operator()(const NameSelector& selector) const {
+    m_writer.write_name(selector.name);
+  }
+
+  void operator()(const IndexSelector& selector) const {
+    m_writer.write_int(selector.index);
+  }
+
+  void operator()(const WildSelector&) const { m_writer.put('*'); }
+
+  void operator()(const SliceSelector& selector) const {
+    if (selector.start) {
+      m_writer.write_int(selector.start.value());
+    }
+    m_writer.put(':');
+    if (selector.stop) {
+      m_writer.write_int(selector.stop.value());
+    }
+    m_writer.put(':');
+    if (selector.step) {
+      m_writer.write_int(selector.step.value());
+    } else {
+      m_writer.put('1');
+    }
+  }
+
+  void operator()(const Box<FilterSelector>& selector) const {
+    m_writer.put('?');
+    m_writer.write(selector->expression);
+  }
+
+  void operator()(const NullLiteral&) const { m_writer.write("null"); }
+
+  void operator()(const BooleanLiteral& expression) const {
+    m_writer.write(expression.value ? "true" : "false");
+  }
+
+  void operator()(const IntegerLiteral& expression) const {
+    m_writer.write_int(expression.value);
+  }
+
+  void operator()(const FloatLiteral& expression) const {
+    m_writer.write_float(expression.value);
+  }
+
+  void operator()(const StringLiteral& expression) const {
+    m_writer.write_string(expression.value);
+  }
+
+  void operator()(const Box<LogicalNotExpression>& expression) const {
+    m_writer.put('!');
+    m_writer.write(expression->right);
+  }
+
+  void operator()(const Box<InfixExpression>& expression) const {
+    const bool logical{expression->op == BinaryOperator::logical_and ||
+                       expression->op == BinaryOperator::logical_or};
+    if (logical) {
+      m_writer.put('(');
+    }
+    m_writer.write(expression->left);
+    m_writer.put(' ');
+    m_writer.write(binary_operator_to_string(expression->op));
+    m_writer.put(' ');
+    m_writer.write(expression->right);
+    if (logical) {
+      m_writer.put(')');
+    }
+  }
+
+  void operator()(const Box<RelativeQuery>& expression) const {
+    m_writer.put('@');
+    write_segments(expression->query);
+  }
+
+  void operator()(const Box<RootQuery>& expression) const {
+    m_writer.write(expression->query);
+  }
+
+  void operator()(const Box<FunctionCall>& expression) const {
+    m_writer.write(expression->name);
+    m_writer.put('(');
+    bool first{true};
+    for (const auto& arg : expression->args) {
+      if (!first) {
+        m_writer.write(", ");
+      }
+      m_writer.write(arg);
+      first = false;
+    }
+    m_writer.put(')');
+  }
+
+  void write_segments(const segments_t& path) const {
+    for (const auto& segment : path) {
+      std::visit(*this, segment);
+    }
+  }
+
+  void write_selectors(const std::vector<selector_t>& selectors) const {
+    bool first{true};
+    for (const auto& selector : selectors) {
+      if (!first) {
+        m_writer.write(", ");
+      }
+      std::visit(*this, selector);
+      first = false;
+    }
+  }
+};
+
+void CanonicalWriter::write(const segments_t& path) {
+  put('$');
+  CanonicalWriterVisitor{*this}.write_segments(path);
+}
+
+void CanonicalWriter::write(const selector_t& selector) {
+  std::visit(CanonicalWriterVisitor{*this}, selector);
+}
+
+void CanonicalWriter::write(const expression_t& expression) {
+  std::visit(CanonicalWriterVisitor{*this}, expression);
+}
+
+void CanonicalWriter::write_name(std::string_view name) {
+  write_quoted(name, '\'');
+}
+
+void CanonicalWriter::write_string(std::string_view value) {
+  write_quoted(value, '"');
+}
+
+void CanonicalWriter::write_quoted(std::string_view value, char quote) {
+  static constexpr char hex_digits[]{"0123456789abcdef"};
+  put(quote);
+
+  // Copy runs of characters that don't need escaping in one go.
+  std::string_view::size_type run_start{0};
+  for (std::string_view::size_type i = 0; i < value.size(); i++) {
+    const auto ch{static_cast<unsigned char>(value[i])};
+    if (ch >= 0x20 && ch != '\\' && ch != static_cast<unsigned char>(quote)) {
+      continue;
+    }
+
+    write(value.substr(run_start, i - run_start));
+    run_start = i + 1;
+    put('\\');
+
+    switch (ch) {
+    case '\b':
+      put('b');
+      break;
+    case '\f':
+      put('f');
+      break;
+    case '\n':
+      put('n');
+      break;
+    case '\r':
+      put('r');
+      break;
+    case '\t':
+      put('t');
+      break;
+    case '\\':
+      put('\\');
+      break;
+    default:
+      if (ch == static_cast<unsigned char>(quote)) {
+        put(quote);
+      } else {
+        write("u00");
+        put(hex_digits[ch >> 4]);
+        put(hex_digits[ch & 0xF]);
+      }
+    }
+  }
+
+  write(value.substr(run_start));
+  put(quote);
+}
+
+void CanonicalWriter::write_int(std::int64_t value) {
+  char buf[24];
+  auto [end, ec]{std::to_chars(buf, buf + sizeof(buf), value)};
+  write(std::string_view{buf, static_cast<std::size_t>(end - buf)});
+}
+
+void CanonicalWriter::write_float(double value) {
+  char buf[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  auto [end, ec]{std::to_chars(buf, buf + sizeof(buf), value)};
+  write(std::string_view{buf, static_cast<std::size_t>(end - buf)});
+#else
+  // NOTE: floating point std::to_chars is not yet implemented, sometimes.
+  // Fifteen significant digits are enough for most values, otherwise we use
+  // the shortest of 16 or 17 digits that converts back to _value_.
+  int length{0};
+  for (int precision = 15; precision <= 17; precision++) {
+    length = std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+    if (std::strtod(buf, nullptr) == value) {
+      break;
+    }
+  }
+  write(std::string_view{buf, static_cast<std::size_t>(length)});
+#endif
+}
+
+// Return the canonical string representation of a single segment, selector
+// or filter expression node.
+template <typename T> static std::string node_to_string(const T& node) {
+  return write_to_string(
+      [&](CanonicalWriter& writer) { CanonicalWriterVisitor{writer}(node); });
+}
+
 std::string SelectorToStringVisitor::operator()(
     const NameSelector& selector) const {
-  return "'"s + selector.name + "'"s;
+  return node_to_string(selector);
 }
 
 std::string SelectorToStringVisitor::operator()(
     const IndexSelector& selector) const {
-  return std::to_string(selector.index);
+  return node_to_string(selector);
 }
 
 std::string SelectorToStringVisitor::operator()(const WildSelector&) const {
@@ -57,37 +348,21 @@ std::string SelectorToStringVisitor::operator()(const WildSelector&) const {
 
 std::string SelectorToStringVisitor::operator()(
     const SliceSelector& selector) const {
-  return (selector.start ? std::to_string(selector.start.value()) : ""s) + ":" +
-         (selector.stop ? std::to_string(selector.stop.value()) : ""s) + ":" +
-         (selector.step ? std::to_string(selector.step.value()) : "1"s);
+  return node_to_string(selector);
 }
 
 std::string SelectorToStringVisitor::operator()(
     const Box<FilterSelector>& selector) const {
-  return "?" + std::visit(ExpressionToStringVisitor(), selector->expression);
+  return node_to_string(selector);
 }
 
 std::string SegmentToStringVisitor::operator()(const Segment& segment) const {
-  std::string rv{"["};
-  for (const auto& selector : segment.selectors) {
-    rv += std::visit(SelectorToStringVisitor(), selector);
-    rv += ", ";
-  }
-  rv.erase(rv.end() - 2, rv.end()); // remove the trailing comma and space
-  rv += "]";
-  return rv;
+  return node_to_string(segment);
 }
 
 std::string SegmentToStringVisitor::operator()(
     const RecursiveSegment& segment) const {
-  std::string rv{"..["};
-  for (const auto& selector : segment.selectors) {
-    rv += std::visit(SelectorToStringVisitor(), selector);
-    rv += ", ";
-  }
-  rv.erase(rv.end() - 2, rv.end()); // remove the trailing comma and space
-  rv += "]";
-  return rv;
+  return node_to_string(segment);
 }
 
 std::string ExpressionToStringVisitor::operator()(const NullLiteral&) const {
@@ -101,87 +376,42 @@ std::string ExpressionToStringVisitor::operator()(
 
 std::string ExpressionToStringVisitor::operator()(
     const IntegerLiteral& expression) const {
-  return std::to_string(expression.value);
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const FloatLiteral& expression) const {
-  // NOTE: std::to_string adds trailing zeros
-  std::string rv = std::to_string(expression.value);
-  rv.erase(rv.find_last_not_of('0') + 1, std::string::npos);
-  rv.erase(rv.find_last_not_of('.') + 1, std::string::npos);
-  return rv;
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const StringLiteral& expression) const {
-  return "\""s + expression.value + "\"";
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const Box<LogicalNotExpression>& expression) const {
-  return "!" + std::visit(ExpressionToStringVisitor(), expression->right);
-}
-
-static std::string binary_operator_to_string(BinaryOperator op) {
-  switch (op) {
-  case BinaryOperator::logical_and:
-    return "&&";
-  case BinaryOperator::logical_or:
-    return "||";
-  case BinaryOperator::eq:
-    return "==";
-  case BinaryOperator::ge:
-    return ">=";
-  case BinaryOperator::gt:
-    return ">";
-  case BinaryOperator::le:
-    return "<=";
-  case BinaryOperator::lt:
-    return "<";
-  case BinaryOperator::ne:
-    return "!=";
-  default:
-    return "OPERATOR ERROR";
-  }
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const Box<InfixExpression>& expression) const {
-  if (expression->op == BinaryOperator::logical_and ||
-      expression->op == BinaryOperator::logical_or) {
-    return "("s + std::visit(ExpressionToStringVisitor(), expression->left) +
-           " " + binary_operator_to_string(expression->op) + " " +
-           std::visit(ExpressionToStringVisitor(), expression->right) + ")"s;
-  }
-  return std::visit(ExpressionToStringVisitor(), expression->left) + " " +
-         binary_operator_to_string(expression->op) + " " +
-         std::visit(ExpressionToStringVisitor(), expression->right);
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const Box<RelativeQuery>& expression) const {
-  auto path_string{to_string(expression->query)};
-  path_string[0] = '@';
-  return path_string;
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const Box<RootQuery>& expression) const {
-  return to_string(expression->query);
+  return node_to_string(expression);
 }
 
 std::string ExpressionToStringVisitor::operator()(
     const Box<FunctionCall>& expression) const {
-  std::string rv{expression->name};
-  rv.push_back('(');
-  for (const auto& arg : expression->args) {
-    rv.append(std::visit(ExpressionToStringVisitor(), arg));
-    rv.append(", ");
-  }
-  rv.erase(rv.end() - 2, rv.end()); // remove the trailing comma and space
-  rv.push_back(')');
-  return rv;
+  return node_to_string(expression);
 }
 
-} // namespace libjsonpath
\ No newline at end of file
+} // namespace libjsonpath
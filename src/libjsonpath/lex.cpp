@@ -281,7 +281,7 @@ Lexer::State Lexer::lex_inside_filter() {
         // Exponent?
         if (accept('e')) {
           accept(s_sign);
-          if (!(accept(s_digits))) {
+          if (!(accept_run(s_digits))) {
             error("at least one exponent digit is required");
             return ERROR;
           }
@@ -295,7 +295,7 @@ Lexer::State Lexer::lex_inside_filter() {
       if (accept('e')) {
         if (accept('-')) {
           // Emit a float if we have a negative exponent.
-          if (!(accept(s_digits))) {
+          if (!(accept_run(s_digits))) {
             error("at least one exponent digit is required");
             return ERROR;
           }
@@ -304,7 +304,7 @@ Lexer::State Lexer::lex_inside_filter() {
         }
 
         accept('+');
-        if (!(accept(s_digits))) {
+        if (!(accept_run(s_digits))) {
           error("at least one exponent digit is required");
           return ERROR;
         }
@@ -328,7 +328,7 @@ Lexer::State Lexer::lex_inside_filter() {
           // Exponent?
           if (accept('e')) {
             accept(s_sign);
-            if (!(accept(s_digits))) {
+            if (!(accept_run(s_digits))) {
               error("at least one exponent digit is required");
               return ERROR;
             }
@@ -342,7 +342,7 @@ Lexer::State Lexer::lex_inside_filter() {
         if (accept('e')) {
           if (accept('-')) {
             // Emit a float if we have a negative exponent.
-            if (!(accept(s_digits))) {
+            if (!(accept_run(s_digits))) {
               error("at least one exponent digit is required");
               return ERROR;
             }
@@ -351,7 +351,7 @@ Lexer::State Lexer::lex_inside_filter() {
           }
 
           accept('+');
-          if (!(accept(s_digits))) {
+          if (!(accept_run(s_digits))) {
             error("at least one exponent digit is required");
             return ERROR;
           }
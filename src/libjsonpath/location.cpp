@@ -0,0 +1,88 @@
+#include "libjsonpath/location.hpp"
+#include "libjsonpath/pointer.hpp" // libjsonpath::to_normalized_path
+#include <algorithm>               // std::reverse
+#include <utility>                 // std::move
+
+namespace libjsonpath {
+
+std::size_t Location::depth() const {
+  std::size_t rv{0};
+  if (m_tree) {
+    for (auto i{m_index}; i != LocationTree::ROOT; i = (*m_tree)[i].parent) {
+      rv++;
+    }
+  }
+  return rv;
+}
+
+std::vector<location_step_t> Location::steps() const {
+  std::vector<location_step_t> rv{};
+  if (m_tree) {
+    for (auto i{m_index}; i != LocationTree::ROOT; i = (*m_tree)[i].parent) {
+      rv.push_back((*m_tree)[i].step);
+    }
+    std::reverse(rv.begin(), rv.end());
+  }
+  return rv;
+}
+
+std::vector<path_step_t> Location::to_path_steps() const {
+  std::vector<path_step_t> rv{};
+  for (const auto& step : steps()) {
+    if (auto name{std::get_if<std::string_view>(&step)}) {
+      rv.emplace_back(std::string{*name});
+    } else {
+      rv.emplace_back(std::get<std::int64_t>(step));
+    }
+  }
+  return rv;
+}
+
+std::string Location::path() const {
+  if (!m_tree) {
+    return std::string{};
+  }
+  return to_normalized_path(steps());
+}
+
+std::string Location::to_json_pointer() const {
+  return SingularPath{to_path_steps()}.to_json_pointer();
+}
+
+Location LocationBuilder::current() {
+  if (!m_tree) {
+    m_tree = std::make_shared<LocationTree>();
+    m_tree->owners = m_owners;
+  } else if (m_tree.use_count() == 1) {
+    m_tree->clear();
+    m_shared = 0;
+  }
+
+  m_entries.resize(m_steps.size());
+  for (auto i{m_shared}; i < m_steps.size(); i++) {
+    m_entries[i] =
+        m_tree->add(i == 0 ? LocationTree::ROOT : m_entries[i - 1], m_steps[i]);
+  }
+  m_shared = m_steps.size();
+
+  return Location{
+      m_tree, m_steps.empty() ? LocationTree::ROOT : m_entries.back()};
+}
+
+void LocationBuilder::retain(std::shared_ptr<const void> owner) {
+  if (owner) {
+    if (m_tree) {
+      m_tree->owners.push_back(owner);
+    }
+    m_owners.push_back(std::move(owner));
+  }
+}
+
+void LocationBuilder::reset() {
+  m_tree.reset();
+  m_steps.clear();
+  m_entries.clear();
+  m_shared = 0;
+}
+
+} // namespace libjsonpath
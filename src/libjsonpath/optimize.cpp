@@ -0,0 +1,619 @@
+#include "libjsonpath/optimize.hpp"
+#include "libjsonpath/cost.hpp"  // libjsonpath::add_cost libjsonpath::mul_cost
+#include "libjsonpath/hash.hpp"  // libjsonpath::hash
+#include "libjsonpath/range.hpp" // libjsonpath::find_ranges
+#include <algorithm> // std::stable_sort std::is_sorted
+#include <optional>  // std::optional std::nullopt
+#include <string_view> // std::string_view
+#include <utility>   // std::move std::pair
+#include <variant>   // std::visit std::holds_alternative std::get_if
+#include <vector>    // std::vector
+
+namespace libjsonpath {
+
+namespace {
+
+void simplify_logical(expression_t& expression);
+void simplify_nested(expression_t& expression);
+
+// Simplify filters in _path_ without counting removed nodes. Nested filters
+// are included in the count of their enclosing expression.
+void simplify_path(segments_t& path) {
+  for (auto& segment : path) {
+    auto& selectors{std::visit(
+        [](auto& s) -> std::vector<selector_t>& { return s.selectors; },
+        segment)};
+    for (auto& selector : selectors) {
+      if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        simplify_logical((*filter)->expression);
+      }
+    }
+  }
+}
+
+// Replace _expression_ with _replacement_, which may be a child of
+// _expression_. The child is moved out before its parent is destroyed.
+void replace(expression_t& expression, expression_t&& replacement) {
+  expression_t tmp{std::move(replacement)};
+  expression = std::move(tmp);
+}
+
+void replace(expression_t& expression, bool value, const Token& token) {
+  expression = BooleanLiteral{token, value};
+}
+
+std::optional<bool> boolean_value(const expression_t& expression) {
+  if (auto literal{std::get_if<BooleanLiteral>(&expression)}) {
+    return literal->value;
+  }
+  return std::nullopt;
+}
+
+// Comparing structurally identical singular queries or function calls
+// compares a value with itself, or Nothing with Nothing, both of which are
+// equal. JSON has no NaN, so no value is unequal to itself.
+std::optional<bool> compare_identical(
+    const expression_t& left, BinaryOperator op, const expression_t& right) {
+  if (is_literal(left) || left != right) {
+    return std::nullopt;
+  }
+
+  switch (op) {
+  case BinaryOperator::eq:
+  case BinaryOperator::le:
+  case BinaryOperator::ge:
+    return true;
+  case BinaryOperator::ne:
+  case BinaryOperator::lt:
+  case BinaryOperator::gt:
+    return false;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Return true if comparisons against literals in the chain of `&&` rooted at
+// _expression_ contradict one another, like `@.a > 5 && @.a < 3`.
+bool has_contradiction(const expression_t& expression) {
+  for (const auto& range : find_ranges(expression)) {
+    if (range.empty) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void simplify_infix(expression_t& expression, InfixExpression& infix) {
+  if (infix.op == BinaryOperator::logical_and ||
+      infix.op == BinaryOperator::logical_or) {
+    simplify_logical(infix.left);
+    simplify_logical(infix.right);
+
+    // The value that short-circuits this operator.
+    const bool dominant{infix.op == BinaryOperator::logical_or};
+    const auto left{boolean_value(infix.left)};
+    const auto right{boolean_value(infix.right)};
+
+    if ((left && left.value() == dominant) ||
+        (right && right.value() == dominant)) {
+      replace(expression, dominant, infix.token);
+    } else if (left) {
+      replace(expression, std::move(infix.right));
+    } else if (right || infix.left == infix.right) {
+      replace(expression, std::move(infix.left));
+    } else if (infix.op == BinaryOperator::logical_and &&
+               has_contradiction(expression)) {
+      replace(expression, false, infix.token);
+    }
+    return;
+  }
+
+  simplify_nested(infix.left);
+  simplify_nested(infix.right);
+
+  auto result{compare_literals(infix.left, infix.op, infix.right)};
+  if (!result) {
+    result = compare_identical(infix.left, infix.op, infix.right);
+  }
+  if (!result && has_contradiction(expression)) {
+    result = false;
+  }
+  if (result) {
+    replace(expression, result.value(), infix.token);
+  }
+}
+
+// Simplify an expression in a logical context, where the result of a query
+// is an existence test.
+void simplify_logical(expression_t& expression) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    auto& right{(*not_)->right};
+    simplify_logical(right);
+    if (auto value{boolean_value(right)}) {
+      replace(expression, !value.value(), (*not_)->token);
+    } else if (auto inner{std::get_if<Box<LogicalNotExpression>>(&right)}) {
+      // Both operands are in a logical context, so `!!x` is `x` even when
+      // _x_ is an existence test.
+      replace(expression, std::move((*inner)->right));
+    }
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    simplify_infix(expression, **infix);
+  } else {
+    simplify_nested(expression);
+  }
+}
+
+// Simplify filters nested in queries in _expression_, leaving the type and
+// shape of _expression_ itself unchanged.
+void simplify_nested(expression_t& expression) {
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    simplify_path((*relative)->query);
+  } else if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    simplify_path((*root)->query);
+  } else if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    for (auto& arg : (*call)->args) {
+      simplify_nested(arg);
+    }
+  } else if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    simplify_nested((*not_)->right);
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    simplify_nested((*infix)->left);
+    simplify_nested((*infix)->right);
+  }
+}
+
+std::size_t count_path(const segments_t& path) {
+  std::size_t count{0};
+  for (const auto& segment : path) {
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+    for (const auto& selector : selectors) {
+      if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        count += count_nodes((*filter)->expression);
+      }
+    }
+  }
+  return count;
+}
+
+// Relative costs used by _evaluation_cost()_.
+constexpr std::uint64_t LITERAL_COST{1};
+constexpr std::uint64_t SELECTOR_COST{1};
+constexpr std::uint64_t FUNCTION_COST{4};
+constexpr std::uint64_t REGEX_COST{32};
+
+// The assumed number of nodes selected by a wildcard, slice or filter
+// selector, and the assumed number of descendants visited by a descendant
+// segment, for each input node.
+constexpr std::uint64_t FAN_OUT{4};
+constexpr std::uint64_t DESCENDANT_FAN_OUT{16};
+
+// The cost of resolving _path_ for one input node. Each segment costs the
+// sum of its selectors, multiplied by the number of nodes it's expected to
+// be applied to.
+std::uint64_t path_cost(const segments_t& path) {
+  std::uint64_t cost{SELECTOR_COST};
+  std::uint64_t nodes{1};
+
+  for (const auto& segment : path) {
+    const bool descendant{std::holds_alternative<RecursiveSegment>(segment)};
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+
+    std::uint64_t segment_cost{0};
+    std::uint64_t segment_nodes{0};
+    for (const auto& selector : selectors) {
+      if (std::holds_alternative<NameSelector>(selector) ||
+          std::holds_alternative<IndexSelector>(selector)) {
+        segment_cost = add_cost(segment_cost, SELECTOR_COST);
+        segment_nodes = add_cost(segment_nodes, 1);
+      } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        segment_cost = add_cost(segment_cost,
+            mul_cost(FAN_OUT,
+                add_cost(SELECTOR_COST,
+                    evaluation_cost((*filter)->expression))));
+        segment_nodes = add_cost(segment_nodes, FAN_OUT);
+      } else {
+        segment_cost = add_cost(segment_cost, mul_cost(FAN_OUT, SELECTOR_COST));
+        segment_nodes = add_cost(segment_nodes, FAN_OUT);
+      }
+    }
+
+    if (descendant) {
+      segment_cost = mul_cost(segment_cost, DESCENDANT_FAN_OUT);
+      segment_nodes = mul_cost(segment_nodes, DESCENDANT_FAN_OUT);
+    }
+
+    cost = add_cost(cost, mul_cost(nodes, segment_cost));
+    nodes = mul_cost(nodes, segment_nodes ? segment_nodes : 1);
+  }
+  return cost;
+}
+
+// Append the operands of the chain of _op_ rooted at _expression_ to
+// _operands_, in evaluation order.
+void collect_operands(expression_t& expression, BinaryOperator op,
+    std::vector<expression_t*>& operands) {
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+      infix && (*infix)->op == op) {
+    collect_operands((*infix)->left, op, operands);
+    collect_operands((*infix)->right, op, operands);
+  } else {
+    operands.push_back(&expression);
+  }
+}
+
+std::size_t reorder_path(segments_t& path);
+
+std::size_t reorder_expression(expression_t& expression) {
+  std::size_t count{0};
+
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    return reorder_expression((*not_)->right);
+  }
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return reorder_path((*relative)->query);
+  }
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    return reorder_path((*root)->query);
+  }
+  if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    for (auto& arg : (*call)->args) {
+      count += reorder_expression(arg);
+    }
+    return count;
+  }
+
+  auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+  if (!infix) {
+    return count;
+  }
+
+  const auto op{(*infix)->op};
+  if (op != BinaryOperator::logical_and && op != BinaryOperator::logical_or) {
+    count += reorder_expression((*infix)->left);
+    count += reorder_expression((*infix)->right);
+    return count;
+  }
+
+  std::vector<expression_t*> operands{};
+  collect_operands(expression, op, operands);
+
+  std::vector<std::uint64_t> costs{};
+  costs.reserve(operands.size());
+  for (auto operand : operands) {
+    count += reorder_expression(*operand);
+    costs.push_back(evaluation_cost(*operand));
+  }
+
+  if (std::is_sorted(costs.begin(), costs.end())) {
+    return count;
+  }
+
+  std::vector<std::pair<std::uint64_t, expression_t>> sorted{};
+  sorted.reserve(operands.size());
+  for (std::size_t i = 0; i < operands.size(); i++) {
+    sorted.emplace_back(costs[i], std::move(*operands[i]));
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // Rebuild the chain with the same right associative shape as the parser
+  // gives it.
+  const Token token{(*infix)->token};
+  expression_t chain{std::move(sorted.back().second)};
+  for (auto it = sorted.rbegin() + 1; it != sorted.rend(); it++) {
+    chain = Box<InfixExpression>(
+        InfixExpression{token, std::move(it->second), op, std::move(chain)});
+  }
+  replace(expression, std::move(chain));
+  return count + 1;
+}
+
+std::size_t reorder_path(segments_t& path) {
+  std::size_t count{0};
+  for (auto& segment : path) {
+    auto& selectors{std::visit(
+        [](auto& s) -> std::vector<selector_t>& { return s.selectors; },
+        segment)};
+    for (auto& selector : selectors) {
+      if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        count += reorder_expression((*filter)->expression);
+      }
+    }
+  }
+  return count;
+}
+
+void collect_invariants(
+    const segments_t& path, std::vector<const expression_t*>& invariants);
+
+void collect_invariants(const expression_t& expression,
+    std::vector<const expression_t*>& invariants) {
+  if (is_invariant(expression)) {
+    if (!is_literal(expression)) {
+      invariants.push_back(&expression);
+    }
+  } else if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    collect_invariants((*not_)->right, invariants);
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    collect_invariants((*infix)->left, invariants);
+    collect_invariants((*infix)->right, invariants);
+  } else if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    for (const auto& arg : (*call)->args) {
+      collect_invariants(arg, invariants);
+    }
+  } else if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    collect_invariants((*relative)->query, invariants);
+  }
+}
+
+void collect_invariants(
+    const segments_t& path, std::vector<const expression_t*>& invariants) {
+  for (const auto& segment : path) {
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+    for (const auto& selector : selectors) {
+      if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        collect_invariants((*filter)->expression, invariants);
+      }
+    }
+  }
+}
+
+// Append relative queries, root queries and function calls in _expression_
+// to _candidates_, in the order they appear.
+void collect_candidates(const expression_t& expression,
+    std::vector<const expression_t*>& candidates) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    collect_candidates((*not_)->right, candidates);
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    collect_candidates((*infix)->left, candidates);
+    collect_candidates((*infix)->right, candidates);
+  } else if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    candidates.push_back(&expression);
+    for (const auto& arg : (*call)->args) {
+      collect_candidates(arg, candidates);
+    }
+  } else if (std::holds_alternative<Box<RelativeQuery>>(expression) ||
+             std::holds_alternative<Box<RootQuery>>(expression)) {
+    candidates.push_back(&expression);
+  }
+}
+
+struct ExpressionPointerHash {
+  std::size_t operator()(const expression_t* expression) const {
+    return static_cast<std::size_t>(hash(*expression));
+  }
+};
+
+struct ExpressionPointerEqual {
+  bool operator()(const expression_t* lhs, const expression_t* rhs) const {
+    return *lhs == *rhs;
+  }
+};
+
+// Return the name selected by the first segment of _query_, if that segment
+// is a child segment with a single name selector.
+std::optional<std::string_view> leading_name(const segments_t& query) {
+  if (query.empty()) {
+    return std::nullopt;
+  }
+  auto segment{std::get_if<Segment>(&query.front())};
+  if (!segment || segment->selectors.size() != 1) {
+    return std::nullopt;
+  }
+  if (auto name{std::get_if<NameSelector>(&segment->selectors.front())}) {
+    return std::string_view{name->name};
+  }
+  return std::nullopt;
+}
+
+// Return the leading name of _expression_ if it's a relative query.
+std::optional<std::string_view> relative_name(const expression_t& expression) {
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return leading_name((*relative)->query);
+  }
+  return std::nullopt;
+}
+
+void collect_required_names(
+    const expression_t& expression, std::vector<std::string_view>& names) {
+  if (auto name{relative_name(expression)}) {
+    names.push_back(*name);
+    return;
+  }
+
+  auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+  if (!infix) {
+    return;
+  }
+
+  const auto& left{(*infix)->left};
+  const auto& right{(*infix)->right};
+  switch ((*infix)->op) {
+  case BinaryOperator::logical_and:
+    collect_required_names(left, names);
+    collect_required_names(right, names);
+    break;
+  case BinaryOperator::eq:
+  case BinaryOperator::ge:
+  case BinaryOperator::gt:
+  case BinaryOperator::le:
+  case BinaryOperator::lt:
+    // A missing member is Nothing, which is not equal to, or ordered with,
+    // any literal.
+    if (is_literal(right)) {
+      if (auto name{relative_name(left)}) {
+        names.push_back(*name);
+      }
+    } else if (is_literal(left)) {
+      if (auto name{relative_name(right)}) {
+        names.push_back(*name);
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace
+
+std::optional<std::size_t> CommonSubexpressions::slot(
+    const expression_t& expression) const {
+  if (auto it{slots.find(&expression)}; it != slots.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+CommonSubexpressions find_common_subexpressions(
+    const expression_t& expression) {
+  std::vector<const expression_t*> candidates{};
+  collect_candidates(expression, candidates);
+
+  // Group candidates by structure, in order of first appearance.
+  std::vector<CommonSubexpression> groups{};
+  std::unordered_map<const expression_t*, std::size_t, ExpressionPointerHash,
+      ExpressionPointerEqual>
+      seen{};
+
+  for (auto candidate : candidates) {
+    auto [it, inserted]{seen.try_emplace(candidate, groups.size())};
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[it->second].occurrences.push_back(candidate);
+  }
+
+  CommonSubexpressions result{};
+  for (auto& group : groups) {
+    if (group.occurrences.size() < 2) {
+      continue;
+    }
+    for (auto occurrence : group.occurrences) {
+      result.slots.emplace(occurrence, result.merged.size());
+    }
+    result.merged.push_back(std::move(group));
+  }
+  return result;
+}
+
+bool is_invariant(const expression_t& expression) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    return is_invariant((*not_)->right);
+  }
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    return is_invariant((*infix)->left) && is_invariant((*infix)->right);
+  }
+  if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    for (const auto& arg : (*call)->args) {
+      if (!is_invariant(arg)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return !std::holds_alternative<Box<RelativeQuery>>(expression);
+}
+
+std::vector<std::string_view> required_names(const expression_t& expression) {
+  std::vector<std::string_view> names{};
+  collect_required_names(expression, names);
+  return names;
+}
+
+std::vector<const expression_t*> find_invariants(const segments_t& path) {
+  std::vector<const expression_t*> invariants{};
+  collect_invariants(path, invariants);
+  return invariants;
+}
+
+std::uint64_t evaluation_cost(const expression_t& expression) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    return add_cost(LITERAL_COST, evaluation_cost((*not_)->right));
+  }
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    return add_cost(LITERAL_COST, add_cost(evaluation_cost((*infix)->left),
+                                      evaluation_cost((*infix)->right)));
+  }
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return path_cost((*relative)->query);
+  }
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    return path_cost((*root)->query);
+  }
+  if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    std::uint64_t cost{FUNCTION_COST};
+    if ((*call)->name == "match" || (*call)->name == "search") {
+      cost = REGEX_COST;
+    }
+    for (const auto& arg : (*call)->args) {
+      cost = add_cost(cost, evaluation_cost(arg));
+    }
+    return cost;
+  }
+  return LITERAL_COST;
+}
+
+std::size_t reorder(segments_t& path) { return reorder_path(path); }
+
+OptimizeStats optimize(segments_t& path, const OptimizeOptions& options) {
+  OptimizeStats stats{};
+  if (options.simplify) {
+    stats.nodes_removed = simplify(path);
+  }
+  if (options.reorder) {
+    stats.chains_reordered = reorder(path);
+  }
+  return stats;
+}
+
+std::size_t count_nodes(const expression_t& expression) {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    return 1 + count_nodes((*not_)->right);
+  }
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    return 1 + count_nodes((*infix)->left) + count_nodes((*infix)->right);
+  }
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return 1 + count_path((*relative)->query);
+  }
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    return 1 + count_path((*root)->query);
+  }
+  if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    std::size_t count{1};
+    for (const auto& arg : (*call)->args) {
+      count += count_nodes(arg);
+    }
+    return count;
+  }
+  return 1;
+}
+
+Simplified simplify(const expression_t& expression) {
+  Simplified result{expression, 0};
+  const auto before{count_nodes(result.expression)};
+  simplify_logical(result.expression);
+  result.nodes_removed = before - count_nodes(result.expression);
+  return result;
+}
+
+std::size_t simplify(segments_t& path) {
+  const auto before{count_path(path)};
+  simplify_path(path);
+  return before - count_path(path);
+}
+
+} // namespace libjsonpath
@@ -10,7 +10,7 @@
 #include <string>       // std::string
 #include <system_error> // std::errc
 #include <utility>      // std::move
-#include <variant>      // std::holds_alternative std::get
+#include <variant>      // std::holds_alternative std::get std::visit
 
 namespace libjsonpath {
 
@@ -229,15 +229,7 @@ FilterSelector Parser::parse_filter_selector(TokenIterator& tokens) const {
   const auto filter_token{*tokens};
   tokens++;
   auto expr{parse_filter_expression(tokens, PRECEDENCE_LOWEST)};
-
-  if (std::holds_alternative<Box<FunctionCall>>(expr)) {
-    auto func{std::get<Box<FunctionCall>>(expr)};
-    auto name{std::string{func->name}};
-    if (function_result_type(name, func->token) == ExpressionType::value) {
-      throw TypeError(
-          "result of "s + name + "() must be compared", func->token);
-    }
-  }
+  throw_for_non_logical(expr);
 
   return FilterSelector{
       filter_token,
@@ -271,9 +263,11 @@ FloatLiteral Parser::parse_float_literal(TokenIterator& tokens) const {
 expression_t Parser::parse_logical_not(TokenIterator& tokens) const {
   const auto token{*tokens};
   tokens++;
+  auto right{parse_filter_expression(tokens, PRECEDENCE_PREFIX)};
+  throw_for_non_logical(right);
   return Box(LogicalNotExpression{
       token,
-      parse_filter_expression(tokens, PRECEDENCE_PREFIX),
+      std::move(right),
   });
 }
 
@@ -289,6 +283,9 @@ expression_t Parser::parse_infix(
   if (precedence == PRECEDENCE_COMPARISON) {
     throw_for_non_comparable(left);
     throw_for_non_comparable(right);
+  } else {
+    throw_for_non_logical(left);
+    throw_for_non_logical(right);
   }
 
   return Box(InfixExpression{
@@ -501,6 +498,90 @@ void Parser::throw_for_non_comparable(const expression_t& expr) const {
   }
 }
 
+void Parser::throw_for_non_logical(const expression_t& expr) const {
+  const Token* literal{nullptr};
+  if (auto n{std::get_if<NullLiteral>(&expr)}) {
+    literal = &n->token;
+  } else if (auto i{std::get_if<IntegerLiteral>(&expr)}) {
+    literal = &i->token;
+  } else if (auto f{std::get_if<FloatLiteral>(&expr)}) {
+    literal = &f->token;
+  } else if (auto s{std::get_if<StringLiteral>(&expr)}) {
+    literal = &s->token;
+  }
+
+  if (literal) {
+    throw TypeError("filter expression literals must be compared", *literal);
+  }
+
+  if (std::holds_alternative<Box<FunctionCall>>(expr)) {
+    const auto& func{std::get<Box<FunctionCall>>(expr)};
+    auto name{std::string{func->name}};
+    if (function_result_type(name, func->token) == ExpressionType::value) {
+      throw TypeError(
+          "result of "s + name + "() must be compared", func->token);
+    }
+  }
+}
+
+void Parser::check(const segments_t& path) const {
+  auto check_index{[](std::int64_t value, const Token& t) {
+    if (value < -MAX_INDEX || value > MAX_INDEX) {
+      throw SyntaxError(
+          "array index out of range '"s + std::to_string(value) + "'"s, t);
+    }
+  }};
+
+  for (const auto& segment : path) {
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<selector_t>& {
+          return s.selectors;
+        },
+        segment)};
+    for (const auto& selector : selectors) {
+      if (auto index{std::get_if<IndexSelector>(&selector)}) {
+        check_index(index->index, index->token);
+      } else if (auto slice{std::get_if<SliceSelector>(&selector)}) {
+        for (const auto& value : {slice->start, slice->stop, slice->step}) {
+          if (value) {
+            check_index(value.value(), slice->token);
+          }
+        }
+      } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+        throw_for_non_logical((*filter)->expression);
+        check_expression((*filter)->expression);
+      }
+    }
+  }
+}
+
+void Parser::check_expression(const expression_t& expr) const {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expr)}) {
+    throw_for_non_logical((*not_)->right);
+    check_expression((*not_)->right);
+  } else if (auto infix{std::get_if<Box<InfixExpression>>(&expr)}) {
+    if ((*infix)->op == BinaryOperator::logical_and ||
+        (*infix)->op == BinaryOperator::logical_or) {
+      throw_for_non_logical((*infix)->left);
+      throw_for_non_logical((*infix)->right);
+    } else {
+      throw_for_non_comparable((*infix)->left);
+      throw_for_non_comparable((*infix)->right);
+    }
+    check_expression((*infix)->left);
+    check_expression((*infix)->right);
+  } else if (auto relative{std::get_if<Box<RelativeQuery>>(&expr)}) {
+    check((*relative)->query);
+  } else if (auto root{std::get_if<Box<RootQuery>>(&expr)}) {
+    check((*root)->query);
+  } else if (auto call{std::get_if<Box<FunctionCall>>(&expr)}) {
+    throw_for_function_signature((*call)->token, (*call)->args);
+    for (const auto& arg : (*call)->args) {
+      check_expression(arg);
+    }
+  }
+}
+
 std::int64_t Parser::token_to_int(const Token& t) const {
   if (t.value.size() > 1 && t.value.rfind("0", 0) == 0) {
     if (t.type == TokenType::index) {
@@ -528,6 +609,13 @@ std::int64_t Parser::token_to_int(const Token& t) const {
   double double_result;
   iss >> double_result;
 
+  if (t.type == TokenType::index &&
+      (double_result < -static_cast<double>(MAX_INDEX) ||
+          double_result > static_cast<double>(MAX_INDEX))) {
+    throw SyntaxError(
+        "array index out of range '"s + null_terminated_str + "'"s, t);
+  }
+
   // Check if double_result is within the range of int
   if (double_result >= std::numeric_limits<std::int64_t>::min() &&
       double_result <=
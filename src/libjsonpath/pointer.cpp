@@ -0,0 +1,127 @@
+#include "libjsonpath/pointer.hpp"
+#include "libjsonpath/exceptions.hpp" // libjsonpath::TypeError
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::write_to_string
+#include "libjsonpath/utils.hpp"      // libjsonpath::singular_query
+#include <string_view>                // std::string_view
+#include <utility>                    // std::move
+
+namespace libjsonpath {
+
+using namespace std::string_literals;
+
+// Append _name_ to _pointer_ as a JSON Pointer reference token, escaping `~`
+// and `/` as per RFC 6901.
+static void append_reference_token(
+    std::string& pointer, std::string_view name) {
+  pointer.push_back('/');
+  for (const auto ch : name) {
+    switch (ch) {
+    case '~':
+      pointer.append("~0");
+      break;
+    case '/':
+      pointer.append("~1");
+      break;
+    default:
+      pointer.push_back(ch);
+    }
+  }
+}
+
+std::string SingularPath::to_json_pointer() const {
+  std::string rv{};
+  for (const auto& step : m_steps) {
+    if (const auto* name = std::get_if<std::string>(&step)) {
+      append_reference_token(rv, *name);
+    } else {
+      const auto index{std::get<std::int64_t>(step)};
+      if (index < 0) {
+        throw IndexError("negative array index "s + std::to_string(index) +
+                         " can't be represented as a JSON Pointer");
+      }
+      rv.push_back('/');
+      rv.append(std::to_string(index));
+    }
+  }
+  return rv;
+}
+
+std::optional<SingularPath> compile_singular_query(const segments_t& segments) {
+  if (!singular_query(segments)) {
+    return std::nullopt;
+  }
+
+  std::vector<path_step_t> steps{};
+  steps.reserve(segments.size());
+  for (const auto& segment : segments) {
+    // A singular query has exactly one name or index selector per segment.
+    const auto& selector{std::get<Segment>(segment).selectors.front()};
+    if (const auto* name = std::get_if<NameSelector>(&selector)) {
+      steps.push_back(name->name);
+    } else {
+      steps.push_back(std::get<IndexSelector>(selector).index);
+    }
+  }
+  return SingularPath{std::move(steps)};
+}
+
+std::string to_json_pointer(const segments_t& segments) {
+  for (const auto& segment : segments) {
+    if (!std::visit(SingularSegmentVisitor(), segment)) {
+      const auto& token{std::visit(
+          [](const auto& s) -> const Token& { return s.token; }, segment)};
+      throw TypeError(
+          "non-singular query can't be represented as a JSON Pointer", token);
+    }
+  }
+
+  for (const auto& segment : segments) {
+    const auto& selector{std::get<Segment>(segment).selectors.front()};
+    if (const auto* index = std::get_if<IndexSelector>(&selector)) {
+      if (index->index < 0) {
+        throw IndexError("negative array index "s +
+                             std::to_string(index->index) +
+                             " can't be represented as a JSON Pointer",
+            index->token);
+      }
+    }
+  }
+
+  return compile_singular_query(segments)->to_json_pointer();
+}
+
+// Write a normalized path to _writer_, so it can be sized then filled.
+// _Step_ is a variant of a name and an index, in that order.
+template <typename Step>
+static void write_normalized_path(
+    CanonicalWriter& writer, const std::vector<Step>& location) {
+  writer.put('$');
+  for (const auto& step : location) {
+    writer.put('[');
+    if (const auto* name = std::get_if<0>(&step)) {
+      writer.write_name(*name);
+    } else {
+      writer.write_int(std::get<std::int64_t>(step));
+    }
+    writer.put(']');
+  }
+}
+
+template <typename Step>
+static std::string normalized_path(const std::vector<Step>& location) {
+  return write_to_string([&](CanonicalWriter& writer) {
+    write_normalized_path(writer, location);
+  });
+}
+
+std::string to_normalized_path(const std::vector<path_step_t>& location) {
+  return normalized_path(location);
+}
+
+std::string to_normalized_path(
+    const std::vector<std::variant<std::string_view, std::int64_t>>&
+        location) {
+  return normalized_path(location);
+}
+
+} // namespace libjsonpath
@@ -0,0 +1,365 @@
+#include "libjsonpath/range.hpp"
+#include "libjsonpath/utils.hpp" // libjsonpath::singular_query
+#include <algorithm>             // std::any_of std::find_if
+#include <utility>               // std::move
+#include <variant>               // std::holds_alternative std::get_if
+
+namespace libjsonpath {
+
+namespace {
+
+std::optional<double> number_value(const expression_t& expression) {
+  if (auto i{std::get_if<IntegerLiteral>(&expression)}) {
+    return static_cast<double>(i->value);
+  }
+  if (auto f{std::get_if<FloatLiteral>(&expression)}) {
+    return f->value;
+  }
+  return std::nullopt;
+}
+
+// Numbers compare by value, whether they're integers or floats.
+bool literals_equal(const expression_t& left, const expression_t& right) {
+  auto li{std::get_if<IntegerLiteral>(&left)};
+  auto ri{std::get_if<IntegerLiteral>(&right)};
+  if (li && ri) {
+    return li->value == ri->value;
+  }
+
+  auto ln{number_value(left)};
+  auto rn{number_value(right)};
+  if (ln && rn) {
+    return ln.value() == rn.value();
+  }
+
+  if (left.index() != right.index()) {
+    return false;
+  }
+  return left == right;
+}
+
+// Only numbers and strings are ordered, and strings are compared by Unicode
+// scalar value, which UTF-8 byte order preserves.
+bool literals_less(const expression_t& left, const expression_t& right) {
+  auto li{std::get_if<IntegerLiteral>(&left)};
+  auto ri{std::get_if<IntegerLiteral>(&right)};
+  if (li && ri) {
+    return li->value < ri->value;
+  }
+
+  auto ln{number_value(left)};
+  auto rn{number_value(right)};
+  if (ln && rn) {
+    return ln.value() < rn.value();
+  }
+
+  auto ls{std::get_if<StringLiteral>(&left)};
+  auto rs{std::get_if<StringLiteral>(&right)};
+  if (ls && rs) {
+    return ls->value < rs->value;
+  }
+  return false;
+}
+
+enum class LiteralClass { number, string, unordered };
+
+LiteralClass literal_class(const expression_t& literal) {
+  if (number_value(literal)) {
+    return LiteralClass::number;
+  }
+  if (std::holds_alternative<StringLiteral>(literal)) {
+    return LiteralClass::string;
+  }
+  return LiteralClass::unordered;
+}
+
+// Swap the sides of a comparison, so `1 < @.a` becomes `@.a > 1`.
+BinaryOperator flip(BinaryOperator op) {
+  switch (op) {
+  case BinaryOperator::lt:
+    return BinaryOperator::gt;
+  case BinaryOperator::le:
+    return BinaryOperator::ge;
+  case BinaryOperator::gt:
+    return BinaryOperator::lt;
+  case BinaryOperator::ge:
+    return BinaryOperator::le;
+  default:
+    return op;
+  }
+}
+
+bool is_comparison(BinaryOperator op) {
+  return op != BinaryOperator::none && op != BinaryOperator::logical_and &&
+         op != BinaryOperator::logical_or;
+}
+
+bool is_singular_query(const expression_t& expression) {
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return singular_query((*relative)->query);
+  }
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    return singular_query((*root)->query);
+  }
+  return false;
+}
+
+// A comparison between a singular query and a literal, with the query on
+// the left.
+struct RangeComparison {
+  const expression_t* query{nullptr};
+  BinaryOperator op{};
+  const expression_t* literal{nullptr};
+};
+
+std::optional<RangeComparison> range_comparison(
+    const expression_t& expression) {
+  auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+  if (!infix || !is_comparison((*infix)->op)) {
+    return std::nullopt;
+  }
+
+  const auto& left{(*infix)->left};
+  const auto& right{(*infix)->right};
+  if (is_singular_query(left) && is_literal(right)) {
+    return RangeComparison{&left, (*infix)->op, &right};
+  }
+  if (is_literal(left) && is_singular_query(right)) {
+    return RangeComparison{&right, flip((*infix)->op), &left};
+  }
+  return std::nullopt;
+}
+
+void set_equal(RangePredicate& predicate, const expression_t& literal) {
+  if (!predicate.equal) {
+    predicate.equal = literal;
+  } else if (!literals_equal(predicate.equal.value(), literal)) {
+    predicate.empty = true;
+  }
+}
+
+// Tighten the upper bound, or the lower bound if _lower_ is true.
+void tighten(RangePredicate& predicate, const expression_t& literal,
+    bool inclusive, bool lower) {
+  auto& bound{lower ? predicate.lower : predicate.upper};
+  if (!bound) {
+    bound = RangeBound{literal, inclusive};
+    return;
+  }
+
+  if (literal_class(literal) != literal_class(bound->value)) {
+    // The value can't be both a number and a string.
+    predicate.empty = true;
+  } else if (lower ? literals_less(bound->value, literal)
+                   : literals_less(literal, bound->value)) {
+    bound = RangeBound{literal, inclusive};
+  } else if (literals_equal(literal, bound->value)) {
+    bound->inclusive = bound->inclusive && inclusive;
+  }
+}
+
+void add(RangePredicate& predicate, BinaryOperator op,
+    const expression_t& literal) {
+  const bool ordered{literal_class(literal) != LiteralClass::unordered};
+  switch (op) {
+  case BinaryOperator::eq:
+    set_equal(predicate, literal);
+    break;
+  case BinaryOperator::ne:
+    predicate.excluded.push_back(literal);
+    break;
+  case BinaryOperator::lt:
+  case BinaryOperator::gt:
+    // Nothing is less than or greater than null or a boolean.
+    if (!ordered) {
+      predicate.empty = true;
+    } else {
+      tighten(predicate, literal, false, op == BinaryOperator::gt);
+    }
+    break;
+  case BinaryOperator::le:
+  case BinaryOperator::ge:
+    if (!ordered) {
+      set_equal(predicate, literal);
+    } else {
+      tighten(predicate, literal, true, op == BinaryOperator::ge);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+bool within_bounds(const RangePredicate& predicate, const expression_t& value) {
+  if (predicate.lower) {
+    const auto op{
+        predicate.lower->inclusive ? BinaryOperator::ge : BinaryOperator::gt};
+    if (!compare_literals(value, op, predicate.lower->value).value_or(false)) {
+      return false;
+    }
+  }
+  if (predicate.upper) {
+    const auto op{
+        predicate.upper->inclusive ? BinaryOperator::le : BinaryOperator::lt};
+    if (!compare_literals(value, op, predicate.upper->value).value_or(false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool is_excluded(const RangePredicate& predicate, const expression_t& value) {
+  return std::any_of(predicate.excluded.begin(), predicate.excluded.end(),
+      [&](const expression_t& x) { return literals_equal(x, value); });
+}
+
+void normalize(RangePredicate& predicate) {
+  if (!predicate.empty && predicate.lower && predicate.upper) {
+    const auto& lower{predicate.lower.value()};
+    const auto& upper{predicate.upper.value()};
+    if (literal_class(lower.value) != literal_class(upper.value) ||
+        literals_less(upper.value, lower.value)) {
+      predicate.empty = true;
+    } else if (literals_equal(lower.value, upper.value)) {
+      if (lower.inclusive && upper.inclusive) {
+        set_equal(predicate, lower.value);
+      } else {
+        predicate.empty = true;
+      }
+    }
+  }
+
+  if (predicate.empty) {
+    return;
+  }
+
+  if (predicate.equal) {
+    const auto& value{predicate.equal.value()};
+    if (!within_bounds(predicate, value) || is_excluded(predicate, value)) {
+      predicate.empty = true;
+    } else {
+      predicate.lower.reset();
+      predicate.upper.reset();
+      predicate.excluded.clear();
+    }
+    return;
+  }
+
+  // Drop duplicate exclusions and those outside the bounds.
+  std::vector<expression_t> excluded{};
+  for (auto& value : predicate.excluded) {
+    if (within_bounds(predicate, value) &&
+        !std::any_of(excluded.begin(), excluded.end(),
+            [&](const expression_t& x) { return literals_equal(x, value); })) {
+      excluded.push_back(std::move(value));
+    }
+  }
+  predicate.excluded = std::move(excluded);
+}
+
+void find_ranges(
+    const expression_t& expression, std::vector<RangePredicate>& ranges);
+
+// Add the operands of the chain of `&&` rooted at _expression_ to _chain_,
+// searching other operands for chains of their own.
+void collect_chain(const expression_t& expression,
+    std::vector<RangePredicate>& chain, std::vector<RangePredicate>& ranges) {
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+      infix && (*infix)->op == BinaryOperator::logical_and) {
+    collect_chain((*infix)->left, chain, ranges);
+    collect_chain((*infix)->right, chain, ranges);
+    return;
+  }
+
+  auto comparison{range_comparison(expression)};
+  if (!comparison) {
+    find_ranges(expression, ranges);
+    return;
+  }
+
+  auto it{std::find_if(chain.begin(), chain.end(), [&](const auto& p) {
+    return *p.query == *comparison->query;
+  })};
+  if (it == chain.end()) {
+    chain.emplace_back();
+    it = chain.end() - 1;
+    it->query = comparison->query;
+  }
+  it->comparisons.push_back(&expression);
+  add(*it, comparison->op, *comparison->literal);
+}
+
+void find_ranges(
+    const expression_t& expression, std::vector<RangePredicate>& ranges) {
+  auto infix{std::get_if<Box<InfixExpression>>(&expression)};
+  if ((infix && (*infix)->op == BinaryOperator::logical_and) ||
+      range_comparison(expression)) {
+    std::vector<RangePredicate> chain{};
+    collect_chain(expression, chain, ranges);
+    for (auto& predicate : chain) {
+      normalize(predicate);
+      ranges.push_back(std::move(predicate));
+    }
+  } else if (infix) {
+    find_ranges((*infix)->left, ranges);
+    find_ranges((*infix)->right, ranges);
+  } else if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    find_ranges((*not_)->right, ranges);
+  }
+}
+
+} // namespace
+
+bool is_literal(const expression_t& expression) {
+  return std::holds_alternative<NullLiteral>(expression) ||
+         std::holds_alternative<BooleanLiteral>(expression) ||
+         std::holds_alternative<IntegerLiteral>(expression) ||
+         std::holds_alternative<FloatLiteral>(expression) ||
+         std::holds_alternative<StringLiteral>(expression);
+}
+
+std::optional<bool> compare_literals(
+    const expression_t& left, BinaryOperator op, const expression_t& right) {
+  if (!is_literal(left) || !is_literal(right)) {
+    return std::nullopt;
+  }
+
+  switch (op) {
+  case BinaryOperator::eq:
+    return literals_equal(left, right);
+  case BinaryOperator::ne:
+    return !literals_equal(left, right);
+  case BinaryOperator::lt:
+    return literals_less(left, right);
+  case BinaryOperator::le:
+    return literals_less(left, right) || literals_equal(left, right);
+  case BinaryOperator::gt:
+    return literals_less(right, left);
+  case BinaryOperator::ge:
+    return literals_less(right, left) || literals_equal(left, right);
+  default:
+    return std::nullopt;
+  }
+}
+
+bool RangePredicate::contains(const expression_t& value) const {
+  if (empty || !is_literal(value)) {
+    return false;
+  }
+  if (equal) {
+    return literals_equal(value, equal.value());
+  }
+  return within_bounds(*this, value) && !is_excluded(*this, value);
+}
+
+bool RangePredicate::contains_nothing() const {
+  return !empty && !equal && !lower && !upper;
+}
+
+std::vector<RangePredicate> find_ranges(const expression_t& expression) {
+  std::vector<RangePredicate> ranges{};
+  find_ranges(expression, ranges);
+  return ranges;
+}
+
+} // namespace libjsonpath
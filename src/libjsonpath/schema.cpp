@@ -0,0 +1,730 @@
+#include "libjsonpath/schema.hpp"
+#include "libjsonpath/optimize.hpp" // libjsonpath::simplify
+#include "libjsonpath/utils.hpp"    // libjsonpath::singular_query
+#include <algorithm>                // std::all_of std::find std::sort
+#include <cstddef>                  // std::size_t
+#include <map>                      // std::map
+#include <optional>                 // std::optional std::nullopt
+#include <string>                   // std::string
+#include <tuple>                    // std::tuple std::make_tuple std::get
+#include <utility>                  // std::move
+#include <variant>                  // std::visit std::holds_alternative
+#include <vector>                   // std::vector
+
+namespace libjsonpath {
+
+namespace {
+
+// The schemas a set of document nodes might be valid against. A null pointer
+// stands for nodes we know nothing about.
+using states_t = std::vector<const Schema*>;
+
+void add_state(states_t& states, const Schema* state) {
+  if (std::find(states.begin(), states.end(), state) == states.end()) {
+    states.push_back(state);
+  }
+}
+
+// Classes of value, as bit flags, for deciding whether a comparison can be
+// true. Integers and floats compare with one another, so they share a flag.
+constexpr unsigned NULL_CLASS{1 << 0};
+constexpr unsigned BOOLEAN_CLASS{1 << 1};
+constexpr unsigned NUMBER_CLASS{1 << 2};
+constexpr unsigned STRING_CLASS{1 << 3};
+constexpr unsigned ARRAY_CLASS{1 << 4};
+constexpr unsigned OBJECT_CLASS{1 << 5};
+constexpr unsigned NOTHING_CLASS{1 << 6};
+constexpr unsigned ANY_VALUE{(1 << 6) - 1};
+
+unsigned value_class(ValueKind kind) {
+  switch (kind) {
+  case ValueKind::null_:
+    return NULL_CLASS;
+  case ValueKind::boolean:
+    return BOOLEAN_CLASS;
+  case ValueKind::integer:
+  case ValueKind::float_:
+    return NUMBER_CLASS;
+  case ValueKind::string:
+    return STRING_CLASS;
+  case ValueKind::array:
+    return ARRAY_CLASS;
+  default:
+    return OBJECT_CLASS;
+  }
+}
+
+unsigned value_classes(const Schema* state) {
+  if (!state || !state->types) {
+    return ANY_VALUE;
+  }
+  unsigned classes{0};
+  for (auto kind : state->types.value()) {
+    classes |= value_class(kind);
+  }
+  return classes;
+}
+
+bool may_be(const Schema* state, ValueKind kind) {
+  return !state || !state->types || state->types->count(kind) > 0;
+}
+
+// Return true if every member of an object valid against _state_ is listed
+// in its properties.
+bool closed(const Schema* state) {
+  return state &&
+         (!may_be(state, ValueKind::object) || !state->additional_properties);
+}
+
+// A child of a node, reached by a member name or, with no name, an array
+// index.
+struct Step {
+  std::optional<std::string> name{};
+  const Schema* state{nullptr};
+};
+
+std::vector<Step> children(const Schema* state) {
+  if (!state) {
+    return {Step{std::nullopt, nullptr}};
+  }
+
+  std::vector<Step> steps{};
+  if (may_be(state, ValueKind::object)) {
+    for (const auto& [name, property] : state->properties) {
+      steps.push_back(Step{name, &*property});
+    }
+    if (state->additional_properties) {
+      steps.push_back(Step{std::nullopt, nullptr});
+    }
+  }
+  if (may_be(state, ValueKind::array)) {
+    steps.push_back(
+        Step{std::nullopt, state->items ? &**state->items : nullptr});
+  }
+  return steps;
+}
+
+std::optional<const Schema*> member(
+    const Schema* state, const std::string& name) {
+  if (!state) {
+    return nullptr;
+  }
+  if (!may_be(state, ValueKind::object)) {
+    return std::nullopt;
+  }
+  if (auto it{state->properties.find(name)}; it != state->properties.end()) {
+    return &*it->second;
+  }
+  if (state->additional_properties) {
+    return nullptr;
+  }
+  return std::nullopt;
+}
+
+std::optional<const Schema*> element(const Schema* state) {
+  if (!state) {
+    return nullptr;
+  }
+  if (!may_be(state, ValueKind::array)) {
+    return std::nullopt;
+  }
+  return state->items ? &**state->items : nullptr;
+}
+
+// Return _states_ and the states of all their descendants.
+states_t descendants(const states_t& states) {
+  states_t result{};
+  for (auto state : states) {
+    add_state(result, state);
+  }
+  for (std::size_t i = 0; i < result.size(); i++) {
+    if (result[i]) {
+      for (const auto& step : children(result[i])) {
+        add_state(result, step.state);
+      }
+    }
+  }
+  return result;
+}
+
+const std::vector<selector_t>& selectors_of(
+    const std::variant<Segment, RecursiveSegment>& segment) {
+  return std::visit(
+      [](const auto& s) -> const std::vector<selector_t>& {
+        return s.selectors;
+      },
+      segment);
+}
+
+std::optional<bool> boolean_value(const expression_t& expression) {
+  if (auto literal{std::get_if<BooleanLiteral>(&expression)}) {
+    return literal->value;
+  }
+  return std::nullopt;
+}
+
+// Selectors rewritten for a set of input states, and the states of the nodes
+// they select that can lead to a match for the rest of the query.
+struct Selection {
+  std::vector<selector_t> selectors{};
+  states_t states{};
+};
+
+// A query matching nothing, `[?false]`.
+segments_t nothing() {
+  segments_t path{};
+  path.push_back(Segment{Token{},
+      {Box<FilterSelector>(
+          FilterSelector{Token{}, BooleanLiteral{Token{}, false}})}});
+  return path;
+}
+
+class Specializer {
+public:
+  Specializer(const Schema& root) : m_root{&root} {};
+
+  segments_t rewrite(const segments_t& path, states_t states) const;
+
+private:
+  const Schema* m_root;
+
+  // Results of _reachable()_, keyed by path, segment index and the sorted
+  // input states. Without these, each segment of a chain like `$..*..*..*`
+  // would check the rest of the chain again for every state.
+  mutable std::map<std::tuple<const segments_t*, std::size_t, states_t>, bool>
+      m_reachable{};
+
+  bool reachable(
+      const states_t& states, const segments_t& path, std::size_t i) const;
+
+  Selection select(const states_t& states, const selector_t& selector,
+      const segments_t& path, std::size_t next) const;
+
+  Selection select_all(const states_t& states,
+      const std::vector<selector_t>& selectors, const segments_t& path,
+      std::size_t next) const;
+
+  expression_t filter(
+      const expression_t& expression, const states_t& current) const;
+
+  expression_t specialize_logical(
+      const expression_t& expression, const states_t& current) const;
+
+  expression_t specialize_query(
+      const expression_t& expression, const states_t& current) const;
+
+  unsigned operand_classes(
+      const expression_t& expression, const states_t& current) const;
+
+  unsigned query_classes(const segments_t& path, states_t states) const;
+
+  bool rewrite_descendant(const RecursiveSegment& segment,
+      const segments_t& path, std::size_t i, states_t& states,
+      segments_t& result) const;
+};
+
+// Return true if the segments of _path_ from _i_ can select something from
+// nodes with _states_.
+bool Specializer::reachable(
+    const states_t& states, const segments_t& path, std::size_t i) const {
+  if (i == path.size()) {
+    return !states.empty();
+  }
+
+  auto key{std::make_tuple(&path, i, states)};
+  std::sort(std::get<2>(key).begin(), std::get<2>(key).end());
+  if (auto it{m_reachable.find(key)}; it != m_reachable.end()) {
+    return it->second;
+  }
+
+  bool rv{false};
+  const bool descendant{std::holds_alternative<RecursiveSegment>(path[i])};
+  const auto inputs{descendant ? descendants(states) : states};
+  for (const auto& selector : selectors_of(path[i])) {
+    if (!select(inputs, selector, path, i + 1).selectors.empty()) {
+      rv = true;
+      break;
+    }
+  }
+
+  m_reachable.emplace(std::move(key), rv);
+  return rv;
+}
+
+Selection Specializer::select(const states_t& states,
+    const selector_t& selector, const segments_t& path,
+    std::size_t next) const {
+  // The states of every node a kept selector selects go in the result, not
+  // just those that can lead to a match, as the rest of the query is applied
+  // to all of them.
+  Selection selection{};
+  bool found{false};
+  auto keep{[&](const Schema* state) {
+    add_state(selection.states, state);
+    found = found || reachable({state}, path, next);
+  }};
+
+  if (auto name{std::get_if<NameSelector>(&selector)}) {
+    for (auto state : states) {
+      if (auto child{member(state, name->name)}) {
+        keep(child.value());
+      }
+    }
+  } else if (std::holds_alternative<IndexSelector>(selector) ||
+             std::holds_alternative<SliceSelector>(selector)) {
+    for (auto state : states) {
+      if (auto child{element(state)}) {
+        keep(child.value());
+      }
+    }
+  } else if (auto filter{std::get_if<Box<FilterSelector>>(&selector)}) {
+    states_t candidates{};
+    for (auto state : states) {
+      for (const auto& step : children(state)) {
+        add_state(candidates, step.state);
+      }
+    }
+
+    auto expression{this->filter((*filter)->expression, candidates)};
+    if (auto value{boolean_value(expression)}) {
+      if (value.value()) {
+        return select(states, WildSelector{(*filter)->token}, path, next);
+      }
+      return selection;
+    }
+
+    for (auto state : candidates) {
+      keep(state);
+    }
+    if (!found) {
+      return Selection{};
+    }
+    selection.selectors.push_back(Box<FilterSelector>(
+        FilterSelector{(*filter)->token, std::move(expression)}));
+    return selection;
+  } else {
+    // A wildcard. On closed objects, it becomes the names that can lead to a
+    // match.
+    std::vector<std::string> names{};
+    bool elements{false};
+    for (auto state : states) {
+      for (const auto& step : children(state)) {
+        if (!reachable({step.state}, path, next)) {
+          continue;
+        }
+        found = true;
+        if (!step.name) {
+          elements = true;
+        } else if (std::find(names.begin(), names.end(), step.name.value()) ==
+                   names.end()) {
+          names.push_back(step.name.value());
+        }
+      }
+    }
+
+    if (!found) {
+      return selection;
+    }
+
+    const bool rewrite{
+        !names.empty() && std::all_of(states.begin(), states.end(), closed)};
+    for (auto state : states) {
+      for (const auto& step : children(state)) {
+        if (!rewrite || (step.name ? std::find(names.begin(), names.end(),
+                                         step.name.value()) != names.end()
+                                   : elements)) {
+          add_state(selection.states, step.state);
+        }
+      }
+    }
+
+    if (!rewrite) {
+      selection.selectors.push_back(selector);
+      return selection;
+    }
+
+    for (auto& member_name : names) {
+      selection.selectors.push_back(
+          NameSelector{Token{}, std::move(member_name), false});
+    }
+    if (elements) {
+      selection.selectors.push_back(SliceSelector{});
+    }
+    return selection;
+  }
+
+  if (!found) {
+    return Selection{};
+  }
+  selection.selectors.push_back(selector);
+  return selection;
+}
+
+Selection Specializer::select_all(const states_t& states,
+    const std::vector<selector_t>& selectors, const segments_t& path,
+    std::size_t next) const {
+  Selection selection{};
+  for (const auto& selector : selectors) {
+    auto selected{select(states, selector, path, next)};
+    for (auto& s : selected.selectors) {
+      selection.selectors.push_back(std::move(s));
+    }
+    for (auto state : selected.states) {
+      add_state(selection.states, state);
+    }
+  }
+  return selection;
+}
+
+// Specialize a filter expression for candidate nodes with _current_ states,
+// then simplify it.
+expression_t Specializer::filter(
+    const expression_t& expression, const states_t& current) const {
+  return simplify(specialize_logical(expression, current)).expression;
+}
+
+// Specialize an expression in a logical context, where the result of a
+// query is an existence test.
+expression_t Specializer::specialize_logical(
+    const expression_t& expression, const states_t& current) const {
+  if (auto not_{std::get_if<Box<LogicalNotExpression>>(&expression)}) {
+    return Box<LogicalNotExpression>(LogicalNotExpression{
+        (*not_)->token, specialize_logical((*not_)->right, current)});
+  }
+
+  if (auto infix{std::get_if<Box<InfixExpression>>(&expression)}) {
+    const auto op{(*infix)->op};
+    if (op == BinaryOperator::logical_and ||
+        op == BinaryOperator::logical_or) {
+      return Box<InfixExpression>(InfixExpression{(*infix)->token,
+          specialize_logical((*infix)->left, current), op,
+          specialize_logical((*infix)->right, current)});
+    }
+
+    // A comparison. Query operands are singular, so there are no paths to
+    // rewrite, only types to check.
+    const auto left{operand_classes((*infix)->left, current)};
+    const auto right{operand_classes((*infix)->right, current)};
+    const bool can_equal{(left & right) != 0};
+    const bool can_order{(left & right & (NUMBER_CLASS | STRING_CLASS)) != 0};
+
+    std::optional<bool> result{};
+    switch (op) {
+    case BinaryOperator::eq:
+      result = can_equal ? std::nullopt : std::optional<bool>{false};
+      break;
+    case BinaryOperator::ne:
+      result = can_equal ? std::nullopt : std::optional<bool>{true};
+      break;
+    case BinaryOperator::lt:
+    case BinaryOperator::gt:
+      result = can_order ? std::nullopt : std::optional<bool>{false};
+      break;
+    default:
+      result = can_order || can_equal ? std::nullopt
+                                      : std::optional<bool>{false};
+      break;
+    }
+
+    if (result) {
+      return BooleanLiteral{(*infix)->token, result.value()};
+    }
+    return Box<InfixExpression>(InfixExpression{(*infix)->token,
+        specialize_query((*infix)->left, current), op,
+        specialize_query((*infix)->right, current)});
+  }
+
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    const auto& query{(*relative)->query};
+    if (!reachable(current, query, 0)) {
+      return BooleanLiteral{(*relative)->token, false};
+    }
+    if (singular_query(query) &&
+        (query_classes(query, current) & NOTHING_CLASS) == 0) {
+      return BooleanLiteral{(*relative)->token, true};
+    }
+  } else if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    const auto& query{(*root)->query};
+    if (!reachable({m_root}, query, 0)) {
+      return BooleanLiteral{(*root)->token, false};
+    }
+    if (singular_query(query) &&
+        (query_classes(query, {m_root}) & NOTHING_CLASS) == 0) {
+      return BooleanLiteral{(*root)->token, true};
+    }
+  }
+
+  return specialize_query(expression, current);
+}
+
+// Rewrite the paths of non-singular queries that are existence tests or
+// function arguments, leaving the type of _expression_ unchanged. Singular
+// queries are left alone, as they must stay singular.
+expression_t Specializer::specialize_query(
+    const expression_t& expression, const states_t& current) const {
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)};
+      relative && !singular_query((*relative)->query)) {
+    return Box<RelativeQuery>(RelativeQuery{
+        (*relative)->token, rewrite((*relative)->query, current)});
+  }
+
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)};
+      root && !singular_query((*root)->query)) {
+    return Box<RootQuery>(
+        RootQuery{(*root)->token, rewrite((*root)->query, {m_root})});
+  }
+
+  if (auto call{std::get_if<Box<FunctionCall>>(&expression)}) {
+    FunctionCall result{(*call)->token, (*call)->name, {}};
+    for (const auto& arg : (*call)->args) {
+      result.args.push_back(specialize_query(arg, current));
+    }
+    return Box<FunctionCall>(std::move(result));
+  }
+
+  return expression;
+}
+
+// Return the classes of value a comparison operand can have.
+unsigned Specializer::operand_classes(
+    const expression_t& expression, const states_t& current) const {
+  if (std::holds_alternative<NullLiteral>(expression)) {
+    return NULL_CLASS;
+  }
+  if (std::holds_alternative<BooleanLiteral>(expression)) {
+    return BOOLEAN_CLASS;
+  }
+  if (std::holds_alternative<IntegerLiteral>(expression) ||
+      std::holds_alternative<FloatLiteral>(expression)) {
+    return NUMBER_CLASS;
+  }
+  if (std::holds_alternative<StringLiteral>(expression)) {
+    return STRING_CLASS;
+  }
+  if (auto relative{std::get_if<Box<RelativeQuery>>(&expression)}) {
+    return query_classes((*relative)->query, current);
+  }
+  if (auto root{std::get_if<Box<RootQuery>>(&expression)}) {
+    return query_classes((*root)->query, {m_root});
+  }
+  return ANY_VALUE | NOTHING_CLASS;
+}
+
+// Return the classes of value the singular query _path_ can produce from
+// nodes with _states_, including NOTHING_CLASS unless the schema guarantees
+// the node exists.
+unsigned Specializer::query_classes(
+    const segments_t& path, states_t states) const {
+  if (!singular_query(path)) {
+    return ANY_VALUE | NOTHING_CLASS;
+  }
+
+  bool exists{true};
+  for (const auto& segment : path) {
+    const auto& selector{selectors_of(segment).front()};
+    states_t next{};
+
+    if (auto name{std::get_if<NameSelector>(&selector)}) {
+      exists = exists && std::all_of(states.begin(), states.end(),
+                             [name](const Schema* state) {
+                               return state && state->types &&
+                                      state->types->size() == 1 &&
+                                      may_be(state, ValueKind::object) &&
+                                      state->required.count(name->name) > 0;
+                             });
+      for (auto state : states) {
+        if (auto child{member(state, name->name)}) {
+          add_state(next, child.value());
+        }
+      }
+    } else {
+      exists = false;
+      for (auto state : states) {
+        if (auto child{element(state)}) {
+          add_state(next, child.value());
+        }
+      }
+    }
+    states = std::move(next);
+  }
+
+  unsigned classes{exists && !states.empty() ? 0 : NOTHING_CLASS};
+  for (auto state : states) {
+    classes |= value_classes(state);
+  }
+  return classes;
+}
+
+// Rewrite the descendant segment _segment_, at index _i_ of _path_, into
+// child segments if its selectors can only match at one depth below nodes
+// with _states_. Returns false if the segment can't match anything.
+bool Specializer::rewrite_descendant(const RecursiveSegment& segment,
+    const segments_t& path, std::size_t i, states_t& states,
+    segments_t& result) const {
+  // Descendants, level by level, each with the index of its parent in the
+  // previous level.
+  struct Entry {
+    Step step{};
+    std::size_t parent{0};
+    bool marked{false};
+    bool reached{false};
+  };
+
+  std::vector<std::vector<Entry>> levels{{}};
+  for (auto state : states) {
+    levels.back().push_back(Entry{Step{std::nullopt, state}, 0});
+  }
+
+  bool unknown{false};
+  while (!levels.back().empty() && !unknown) {
+    std::vector<Entry> next{};
+    for (std::size_t j = 0; j < levels.back().size(); j++) {
+      const auto state{levels.back()[j].step.state};
+      unknown = unknown || !state;
+      if (state) {
+        for (auto& step : children(state)) {
+          next.push_back(Entry{std::move(step), j});
+        }
+      }
+    }
+    levels.push_back(std::move(next));
+  }
+
+  if (unknown) {
+    auto selection{select_all(states_t{nullptr}, segment.selectors, path,
+        i + 1)};
+    if (selection.selectors.empty()) {
+      return false;
+    }
+    result.push_back(
+        RecursiveSegment{segment.token, std::move(selection.selectors)});
+    states = std::move(selection.states);
+    return true;
+  }
+
+  // Mark the descendants that can lead to a match, and their ancestors.
+  std::vector<std::size_t> depths{};
+  for (std::size_t depth = 0; depth < levels.size(); depth++) {
+    for (auto& entry : levels[depth]) {
+      if (select_all({entry.step.state}, segment.selectors, path, i + 1)
+              .selectors.empty()) {
+        continue;
+      }
+      entry.marked = true;
+      if (depths.empty() || depths.back() != depth) {
+        depths.push_back(depth);
+      }
+    }
+  }
+
+  if (depths.empty()) {
+    return false;
+  }
+
+  // The rewritten segment is applied to every descendant, so its selectors
+  // are specialized for all of them, not only those that match.
+  if (depths.size() > 1) {
+    auto selection{
+        select_all(descendants(states), segment.selectors, path, i + 1)};
+    result.push_back(
+        RecursiveSegment{segment.token, std::move(selection.selectors)});
+    states = std::move(selection.states);
+    return true;
+  }
+
+  const auto depth{depths.front()};
+  for (std::size_t d = depth; d > 0; d--) {
+    for (const auto& entry : levels[d]) {
+      if (entry.marked) {
+        levels[d - 1][entry.parent].marked = true;
+      }
+    }
+  }
+
+  // Child segments for the names on the way to the marked descendants. These
+  // can also select unmarked descendants with the same names, which are
+  // tracked as reached so the last segment is specialized for them too.
+  for (auto& entry : levels.front()) {
+    entry.reached = true;
+  }
+
+  for (std::size_t d = 1; d <= depth; d++) {
+    std::vector<selector_t> selectors{};
+    bool elements{false};
+    for (const auto& entry : levels[d]) {
+      if (!entry.marked) {
+        continue;
+      }
+      if (!entry.step.name) {
+        elements = true;
+        continue;
+      }
+      NameSelector name{Token{}, entry.step.name.value(), false};
+      if (std::find(selectors.begin(), selectors.end(), selector_t{name}) ==
+          selectors.end()) {
+        selectors.push_back(std::move(name));
+      }
+    }
+
+    const bool wild{selectors.empty()};
+    for (auto& entry : levels[d]) {
+      entry.reached =
+          levels[d - 1][entry.parent].reached &&
+          (wild || (entry.step.name
+                           ? std::find(selectors.begin(), selectors.end(),
+                                 selector_t{NameSelector{Token{},
+                                     entry.step.name.value(), false}}) !=
+                                 selectors.end()
+                           : elements));
+    }
+
+    if (wild) {
+      selectors.push_back(WildSelector{});
+    } else if (elements) {
+      selectors.push_back(SliceSelector{});
+    }
+    result.push_back(Segment{segment.token, std::move(selectors)});
+  }
+
+  states_t reached{};
+  for (const auto& entry : levels[depth]) {
+    if (entry.reached) {
+      add_state(reached, entry.step.state);
+    }
+  }
+
+  auto selection{select_all(reached, segment.selectors, path, i + 1)};
+  result.push_back(Segment{segment.token, std::move(selection.selectors)});
+  states = std::move(selection.states);
+  return true;
+}
+
+segments_t Specializer::rewrite(
+    const segments_t& path, states_t states) const {
+  segments_t result{};
+  for (std::size_t i = 0; i < path.size(); i++) {
+    if (auto descendant{std::get_if<RecursiveSegment>(&path[i])}) {
+      if (!rewrite_descendant(*descendant, path, i, states, result)) {
+        return nothing();
+      }
+      continue;
+    }
+
+    const auto& segment{std::get<Segment>(path[i])};
+    auto selection{select_all(states, segment.selectors, path, i + 1)};
+    if (selection.selectors.empty()) {
+      return nothing();
+    }
+    result.push_back(Segment{segment.token, std::move(selection.selectors)});
+    states = std::move(selection.states);
+  }
+  return result;
+}
+
+} // namespace
+
+segments_t specialize(const segments_t& path, const Schema& schema) {
+  return Specializer{schema}.rewrite(path, {&schema});
+}
+
+} // namespace libjsonpath
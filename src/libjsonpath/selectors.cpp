@@ -0,0 +1,141 @@
+#include "libjsonpath/selectors.hpp"
+
+namespace libjsonpath {
+
+bool operator==(const NullLiteral&, const NullLiteral&) { return true; }
+
+bool operator==(const BooleanLiteral& lhs, const BooleanLiteral& rhs) {
+  return lhs.value == rhs.value;
+}
+
+bool operator==(const IntegerLiteral& lhs, const IntegerLiteral& rhs) {
+  return lhs.value == rhs.value;
+}
+
+bool operator==(const FloatLiteral& lhs, const FloatLiteral& rhs) {
+  return lhs.value == rhs.value;
+}
+
+bool operator==(const StringLiteral& lhs, const StringLiteral& rhs) {
+  return lhs.value == rhs.value;
+}
+
+bool operator==(
+    const LogicalNotExpression& lhs, const LogicalNotExpression& rhs) {
+  return lhs.right == rhs.right;
+}
+
+bool operator==(const InfixExpression& lhs, const InfixExpression& rhs) {
+  return lhs.op == rhs.op && lhs.left == rhs.left && lhs.right == rhs.right;
+}
+
+bool operator==(const RelativeQuery& lhs, const RelativeQuery& rhs) {
+  return lhs.query == rhs.query;
+}
+
+bool operator==(const RootQuery& lhs, const RootQuery& rhs) {
+  return lhs.query == rhs.query;
+}
+
+bool operator==(const FunctionCall& lhs, const FunctionCall& rhs) {
+  return lhs.name == rhs.name && lhs.args == rhs.args;
+}
+
+bool operator==(const NameSelector& lhs, const NameSelector& rhs) {
+  return lhs.name == rhs.name;
+}
+
+bool operator==(const IndexSelector& lhs, const IndexSelector& rhs) {
+  return lhs.index == rhs.index;
+}
+
+bool operator==(const WildSelector&, const WildSelector&) { return true; }
+
+bool operator==(const SliceSelector& lhs, const SliceSelector& rhs) {
+  // A missing step is equivalent to a step of 1.
+  return lhs.start == rhs.start && lhs.stop == rhs.stop &&
+         lhs.step.value_or(1) == rhs.step.value_or(1);
+}
+
+bool operator==(const FilterSelector& lhs, const FilterSelector& rhs) {
+  return lhs.expression == rhs.expression;
+}
+
+bool operator==(const Segment& lhs, const Segment& rhs) {
+  return lhs.selectors == rhs.selectors;
+}
+
+bool operator==(const RecursiveSegment& lhs, const RecursiveSegment& rhs) {
+  return lhs.selectors == rhs.selectors;
+}
+
+bool operator!=(const NullLiteral& lhs, const NullLiteral& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const BooleanLiteral& lhs, const BooleanLiteral& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const IntegerLiteral& lhs, const IntegerLiteral& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const FloatLiteral& lhs, const FloatLiteral& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const StringLiteral& lhs, const StringLiteral& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(
+    const LogicalNotExpression& lhs, const LogicalNotExpression& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const InfixExpression& lhs, const InfixExpression& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const RelativeQuery& lhs, const RelativeQuery& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const RootQuery& lhs, const RootQuery& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const FunctionCall& lhs, const FunctionCall& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const NameSelector& lhs, const NameSelector& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const IndexSelector& lhs, const IndexSelector& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const WildSelector& lhs, const WildSelector& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const SliceSelector& lhs, const SliceSelector& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const FilterSelector& lhs, const FilterSelector& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const Segment& lhs, const Segment& rhs) {
+  return !(lhs == rhs);
+}
+
+bool operator!=(const RecursiveSegment& lhs, const RecursiveSegment& rhs) {
+  return !(lhs == rhs);
+}
+
+} // namespace libjsonpath
@@ -0,0 +1,405 @@
+#include "libjsonpath/value.hpp"
+#include "libjsonpath/exceptions.hpp" // libjsonpath::JSONError
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::write_to_string
+#include <algorithm>                  // std::all_of std::find_if
+#include <cerrno>                     // errno ERANGE
+#include <charconv>                   // std::from_chars
+#include <cstdlib>                    // std::strtod
+
+namespace libjsonpath {
+
+using namespace std::string_literals;
+
+const Value* Value::find(std::string_view name) const noexcept {
+  if (auto object{std::get_if<object_t>(&m_value)}) {
+    auto it{std::find_if(object->begin(), object->end(),
+        [name](const auto& member) { return member.first == name; })};
+    if (it != object->end()) {
+      return &it->second;
+    }
+  }
+  return nullptr;
+}
+
+bool operator==(const Value& lhs, const Value& rhs) {
+  const auto lk{lhs.kind()};
+  const auto rk{rhs.kind()};
+  const bool l_number{lk == ValueKind::integer || lk == ValueKind::float_};
+  const bool r_number{rk == ValueKind::integer || rk == ValueKind::float_};
+
+  if (l_number && r_number) {
+    if (lk == ValueKind::integer && rk == ValueKind::integer) {
+      return lhs.as_integer() == rhs.as_integer();
+    }
+    auto as_double{[](const Value& v, ValueKind k) {
+      return k == ValueKind::integer ? static_cast<double>(v.as_integer())
+                                     : v.as_float();
+    }};
+    return as_double(lhs, lk) == as_double(rhs, rk);
+  }
+
+  if (lk != rk) {
+    return false;
+  }
+
+  if (lk == ValueKind::object) {
+    const auto& lo{lhs.as_object()};
+    const auto& ro{rhs.as_object()};
+    return lo.size() == ro.size() &&
+           std::all_of(lo.begin(), lo.end(), [&rhs](const auto& member) {
+             auto other{rhs.find(member.first)};
+             return other && *other == member.second;
+           });
+  }
+
+  return lhs.m_value == rhs.m_value;
+}
+
+namespace {
+
+class JSONParser {
+public:
+  JSONParser(std::string_view text) : m_text{text} {};
+
+  Value parse() {
+    skip_whitespace();
+    auto value{parse_value()};
+    skip_whitespace();
+    if (m_pos != m_text.size()) {
+      error("unexpected trailing characters");
+    }
+    return value;
+  }
+
+private:
+  std::string_view m_text;
+  std::size_t m_pos{0};
+
+  [[noreturn]] void error(std::string_view message) const {
+    throw JSONError(std::string{message} + " at offset "s +
+                    std::to_string(m_pos));
+  }
+
+  char peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+
+  void skip_whitespace() {
+    while (m_pos < m_text.size()) {
+      const auto ch{m_text[m_pos]};
+      if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+        break;
+      }
+      m_pos++;
+    }
+  }
+
+  void expect(char ch) {
+    if (peek() != ch) {
+      error("expected '"s + ch + "'");
+    }
+    m_pos++;
+  }
+
+  void expect_keyword(std::string_view keyword) {
+    if (m_text.substr(m_pos, keyword.size()) != keyword) {
+      error("unexpected token");
+    }
+    m_pos += keyword.size();
+  }
+
+  Value parse_value() {
+    switch (peek()) {
+    case '{':
+      return parse_object();
+    case '[':
+      return parse_array();
+    case '"':
+      return parse_string();
+    case 't':
+      expect_keyword("true");
+      return true;
+    case 'f':
+      expect_keyword("false");
+      return false;
+    case 'n':
+      expect_keyword("null");
+      return nullptr;
+    default:
+      return parse_number();
+    }
+  }
+
+  Value parse_object() {
+    expect('{');
+    Value::object_t object{};
+    skip_whitespace();
+    if (peek() == '}') {
+      m_pos++;
+      return object;
+    }
+
+    for (;;) {
+      skip_whitespace();
+      if (peek() != '"') {
+        error("expected a member name");
+      }
+      auto name{parse_string()};
+      skip_whitespace();
+      expect(':');
+      skip_whitespace();
+      object.emplace_back(std::move(name), parse_value());
+      skip_whitespace();
+      if (peek() == ',') {
+        m_pos++;
+        continue;
+      }
+      expect('}');
+      return object;
+    }
+  }
+
+  Value parse_array() {
+    expect('[');
+    Value::array_t array{};
+    skip_whitespace();
+    if (peek() == ']') {
+      m_pos++;
+      return array;
+    }
+
+    for (;;) {
+      skip_whitespace();
+      array.push_back(parse_value());
+      skip_whitespace();
+      if (peek() == ',') {
+        m_pos++;
+        continue;
+      }
+      expect(']');
+      return array;
+    }
+  }
+
+  std::uint32_t parse_hex4() {
+    if (m_pos + 4 > m_text.size()) {
+      error("truncated escape sequence");
+    }
+    std::uint32_t code_point{0};
+    auto [end, ec]{std::from_chars(
+        m_text.data() + m_pos, m_text.data() + m_pos + 4, code_point, 16)};
+    if (ec != std::errc{} || end != m_text.data() + m_pos + 4) {
+      error("invalid escape sequence");
+    }
+    m_pos += 4;
+    return code_point;
+  }
+
+  static void append_utf8(std::string& out, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+      out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+  }
+
+  std::string parse_string() {
+    expect('"');
+    std::string out{};
+    for (;;) {
+      // Copy runs of unescaped characters in one go.
+      const auto start{m_pos};
+      while (m_pos < m_text.size() && m_text[m_pos] != '"' &&
+             m_text[m_pos] != '\\' &&
+             static_cast<unsigned char>(m_text[m_pos]) >= 0x20) {
+        m_pos++;
+      }
+      out.append(m_text.substr(start, m_pos - start));
+
+      if (m_pos == m_text.size()) {
+        error("unterminated string");
+      }
+
+      const auto ch{m_text[m_pos++]};
+      if (ch == '"') {
+        return out;
+      }
+      if (ch != '\\') {
+        error("unescaped control character");
+      }
+
+      const auto escape{peek()};
+      m_pos++;
+      switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        out.push_back(escape);
+        break;
+      case 'b':
+        out.push_back('\b');
+        break;
+      case 'f':
+        out.push_back('\f');
+        break;
+      case 'n':
+        out.push_back('\n');
+        break;
+      case 'r':
+        out.push_back('\r');
+        break;
+      case 't':
+        out.push_back('\t');
+        break;
+      case 'u': {
+        auto code_point{parse_hex4()};
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+          expect('\\');
+          expect('u');
+          const auto low{parse_hex4()};
+          if (low < 0xDC00 || low > 0xDFFF) {
+            error("invalid surrogate pair");
+          }
+          code_point =
+              0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+          error("unpaired low surrogate");
+        }
+        append_utf8(out, code_point);
+        break;
+      }
+      default:
+        error("invalid escape sequence");
+      }
+    }
+  }
+
+  Value parse_number() {
+    const auto start{m_pos};
+    bool is_float{false};
+
+    if (peek() == '-') {
+      m_pos++;
+    }
+    if (peek() == '0') {
+      m_pos++;
+    } else if (peek() >= '1' && peek() <= '9') {
+      while (peek() >= '0' && peek() <= '9') {
+        m_pos++;
+      }
+    } else {
+      error("unexpected token");
+    }
+
+    if (peek() == '.') {
+      is_float = true;
+      m_pos++;
+      if (!(peek() >= '0' && peek() <= '9')) {
+        error("expected a digit");
+      }
+      while (peek() >= '0' && peek() <= '9') {
+        m_pos++;
+      }
+    }
+
+    if (peek() == 'e' || peek() == 'E') {
+      is_float = true;
+      m_pos++;
+      if (peek() == '+' || peek() == '-') {
+        m_pos++;
+      }
+      if (!(peek() >= '0' && peek() <= '9')) {
+        error("expected a digit");
+      }
+      while (peek() >= '0' && peek() <= '9') {
+        m_pos++;
+      }
+    }
+
+    const auto first{m_text.data() + start};
+    const auto last{m_text.data() + m_pos};
+    if (!is_float) {
+      std::int64_t value{0};
+      auto [end, ec]{std::from_chars(first, last, value)};
+      if (ec == std::errc{} && end == last) {
+        return value;
+      }
+    }
+
+    // std::strtod needs a null terminated string.
+    const std::string number{first, last};
+    errno = 0;
+    const double value{std::strtod(number.c_str(), nullptr)};
+    if (errno == ERANGE && (value > 1.0 || value < -1.0)) {
+      error("number out of range");
+    }
+    return value;
+  }
+};
+
+void write_json(CanonicalWriter& writer, const Value& value) {
+  switch (value.kind()) {
+  case ValueKind::null_:
+    writer.write("null");
+    break;
+  case ValueKind::boolean:
+    writer.write(value.as_bool() ? "true" : "false");
+    break;
+  case ValueKind::integer:
+    writer.write_int(value.as_integer());
+    break;
+  case ValueKind::float_:
+    writer.write_float(value.as_float());
+    break;
+  case ValueKind::string:
+    writer.write_string(value.as_string());
+    break;
+  case ValueKind::array: {
+    writer.put('[');
+    bool first{true};
+    for (const auto& element : value.as_array()) {
+      if (!first) {
+        writer.put(',');
+      }
+      first = false;
+      write_json(writer, element);
+    }
+    writer.put(']');
+    break;
+  }
+  case ValueKind::object: {
+    writer.put('{');
+    bool first{true};
+    for (const auto& [name, member] : value.as_object()) {
+      if (!first) {
+        writer.put(',');
+      }
+      first = false;
+      writer.write_string(name);
+      writer.put(':');
+      write_json(writer, member);
+    }
+    writer.put('}');
+    break;
+  }
+  }
+}
+
+} // namespace
+
+Value parse_json(std::string_view text) { return JSONParser{text}.parse(); }
+
+std::string to_json(const Value& value) {
+  return write_to_string(
+      [&](CanonicalWriter& writer) { write_json(writer, value); });
+}
+
+} // namespace libjsonpath
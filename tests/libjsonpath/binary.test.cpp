@@ -0,0 +1,208 @@
+#include "libjsonpath/binary.hpp"     // libjsonpath::dump libjsonpath::load
+#include "libjsonpath/exceptions.hpp" // libjsonpath::FormatError
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include <gtest/gtest.h>              // EXPEXT_* TEST_F testing::Test
+#include <string>                     // std::string
+#include <cstdint>                    // std::int64_t
+#include <limits>                     // std::numeric_limits
+#include <string_view>                // std::string_view
+#include <variant>                    // std::get
+
+using libjsonpath::Box;
+using libjsonpath::FilterSelector;
+using libjsonpath::InfixExpression;
+using libjsonpath::RelativeQuery;
+using libjsonpath::Segment;
+
+class BinaryTest : public testing::Test {
+protected:
+  void expect_round_trip(std::string_view query) {
+    auto segments{libjsonpath::parse(query)};
+    auto data{libjsonpath::dump(segments)};
+    auto loaded{libjsonpath::load(data)};
+    EXPECT_EQ(loaded, segments) << query;
+    EXPECT_EQ(libjsonpath::to_string(loaded), libjsonpath::to_string(segments));
+  }
+};
+
+TEST_F(BinaryTest, JustRoot) { expect_round_trip("$"); }
+
+TEST_F(BinaryTest, Names) { expect_round_trip("$.foo['bar', 'a\\'b']"); }
+
+TEST_F(BinaryTest, IndicesAndWild) { expect_round_trip("$[0, -1, *].*"); }
+
+TEST_F(BinaryTest, Slices) { expect_round_trip("$[1:-1:2, :3, ::-1, 2:]"); }
+
+TEST_F(BinaryTest, Descendants) { expect_round_trip("$..a..[0]..*"); }
+
+TEST_F(BinaryTest, Literals) {
+  expect_round_trip(
+      "$[?@.a == null || @.a == true && @.b != false || @.c < 1.5e-07]");
+  expect_round_trip("$[?@.a == -9007199254740993 || @.b == 'x\\ny']");
+}
+
+TEST_F(BinaryTest, NestedQueries) {
+  expect_round_trip("$.a[?@.b[?@.c > $.d.e] && !($.f || @..g)]");
+}
+
+TEST_F(BinaryTest, FunctionCalls) {
+  expect_round_trip("$[?count(@..*) > 2 && length(@.a) == value($.b)]");
+  expect_round_trip("$[?match(@.a, 'x.*') || search(@.b, 'y')]");
+}
+
+TEST_F(BinaryTest, SharedStrings) {
+  auto once{libjsonpath::dump(libjsonpath::parse("$.abcdefgh"))};
+  auto twice{libjsonpath::dump(libjsonpath::parse("$.abcdefgh.abcdefgh"))};
+  // One more segment and one more selector node, but no more string data.
+  EXPECT_EQ(twice.size(), once.size() + 32);
+}
+
+TEST_F(BinaryTest, ReadInPlace) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a[?length(@) > 1]"))};
+  libjsonpath::QueryImage image{data};
+  auto root{image.node(0)};
+  EXPECT_EQ(root.kind, libjsonpath::BinaryNodeKind::query);
+  EXPECT_EQ(root.b, 2);
+
+  auto segment{image.node(root.a)};
+  EXPECT_EQ(segment.kind, libjsonpath::BinaryNodeKind::segment);
+  auto name{image.node(segment.a)};
+  EXPECT_EQ(name.kind, libjsonpath::BinaryNodeKind::name_selector);
+  EXPECT_EQ(image.string(name), "a");
+
+  EXPECT_EQ(image.function_count(), 1);
+  EXPECT_EQ(image.function(0).name, "length");
+}
+
+TEST_F(BinaryTest, NotABinaryQuery) {
+  EXPECT_THROW(libjsonpath::load("$.foo"), libjsonpath::FormatError);
+  EXPECT_THROW(libjsonpath::load(""), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, UnsupportedVersion) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a"))};
+  data[4] = 99;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, Truncated) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a[?@.b]"))};
+  for (std::size_t size = 0; size < data.size(); size++) {
+    EXPECT_THROW(libjsonpath::load(std::string_view{data}.substr(0, size)),
+        libjsonpath::FormatError)
+        << size;
+  }
+}
+
+TEST_F(BinaryTest, ChildBeforeParent) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a"))};
+  // Point the root query's first child back at itself.
+  data[32 + 4] = 0;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, SharedChildren) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a.b"))};
+  // Point the second segment at the first segment's selector.
+  data[32 + 2 * 16 + 4] = 3;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, UnreachableNodes) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$.a.b"))};
+  // Drop the root query's second segment, leaving its records orphaned.
+  data[32 + 8] = 1;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, UnknownOperator) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$[?@.a && @.b]"))};
+  libjsonpath::QueryImage image{data};
+  // Records are root, segment, filter selector and then the infix node.
+  ASSERT_EQ(image.node(3).kind, libjsonpath::BinaryNodeKind::infix);
+  data[32 + 3 * 16 + 1] = 99;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, FunctionArgumentsOutOfRange) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$[?length(@.a) > 1]"))};
+  libjsonpath::QueryImage image{data};
+  const auto functions_offset{32 + image.node_count() * 16};
+  // Move the argument types offset far past the end of the image.
+  data[functions_offset + 10] = 0x10;
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::FormatError);
+}
+
+TEST_F(BinaryTest, UnknownFunction) {
+  libjsonpath::function_signature_map functions{
+      libjsonpath::DEFAULT_FUNCTION_EXTENSIONS};
+  functions["foo"] = {{libjsonpath::ExpressionType::value},
+      libjsonpath::ExpressionType::logical};
+
+  auto data{libjsonpath::dump(
+      libjsonpath::parse("$[?foo(@.a)]", functions), functions)};
+  EXPECT_EQ(libjsonpath::load(data, functions),
+      libjsonpath::parse("$[?foo(@.a)]", functions));
+  EXPECT_THROW(libjsonpath::load(data), libjsonpath::NameError);
+}
+
+TEST_F(BinaryTest, ChangedFunctionSignature) {
+  auto data{libjsonpath::dump(libjsonpath::parse("$[?length(@.a) > 1]"))};
+  libjsonpath::function_signature_map functions{
+      libjsonpath::DEFAULT_FUNCTION_EXTENSIONS};
+  functions["length"] = {
+      {libjsonpath::ExpressionType::nodes}, libjsonpath::ExpressionType::value};
+  EXPECT_THROW(libjsonpath::load(data, functions), libjsonpath::TypeError);
+}
+
+TEST_F(BinaryTest, IllTypedQueries) {
+  // _dump()_ encodes any tree, so ill-typed ones are made by editing parsed
+  // queries.
+  auto filter{[](libjsonpath::segments_t& path) -> auto& {
+    return std::get<Box<FilterSelector>>(std::get<Segment>(path[0]).selectors[0])
+        ->expression;
+  }};
+
+  // `$[?1]`
+  auto literal{libjsonpath::parse("$[?@.a]")};
+  filter(literal) = libjsonpath::IntegerLiteral{{}, 1};
+  EXPECT_THROW(
+      libjsonpath::load(libjsonpath::dump(literal)), libjsonpath::TypeError);
+
+  // `$[?@[*] == 1]`
+  auto comparison{libjsonpath::parse("$[?@[0] == 1]")};
+  auto& left{std::get<Box<InfixExpression>>(filter(comparison))->left};
+  std::get<Segment>(std::get<Box<RelativeQuery>>(left)->query[0])
+      .selectors[0] = libjsonpath::WildSelector{};
+  EXPECT_THROW(libjsonpath::load(libjsonpath::dump(comparison)),
+      libjsonpath::TypeError);
+
+  // `$[?length(@[*]) == 1]`, a NodesType argument for a ValueType parameter.
+  auto argument{libjsonpath::parse("$[?length(@[0]) == 1]")};
+  auto& call{std::get<Box<libjsonpath::FunctionCall>>(
+      std::get<Box<InfixExpression>>(filter(argument))->left)};
+  std::get<Segment>(std::get<Box<RelativeQuery>>(call->args[0])->query[0])
+      .selectors[0] = libjsonpath::WildSelector{};
+  EXPECT_THROW(libjsonpath::load(libjsonpath::dump(argument)),
+      libjsonpath::TypeError);
+
+  // An index outside the I-JSON range.
+  auto index{libjsonpath::parse("$[1]")};
+  std::get<libjsonpath::IndexSelector>(std::get<Segment>(index[0]).selectors[0])
+      .index = std::numeric_limits<std::int64_t>::max();
+  EXPECT_THROW(
+      libjsonpath::load(libjsonpath::dump(index)), libjsonpath::SyntaxError);
+}
+
+TEST_F(BinaryTest, DeeplyNested) {
+  std::string query{"$[?"};
+  query.append(libjsonpath::MAX_BINARY_DEPTH, '!');
+  query.append("@.a]");
+  EXPECT_THROW(libjsonpath::load(libjsonpath::dump(libjsonpath::parse(query))),
+      libjsonpath::FormatError);
+
+  // The deepest that fits: the root, a segment and a filter selector, the
+  // `!`s, then a query with a segment and a name selector.
+  query = "$[?" + std::string(libjsonpath::MAX_BINARY_DEPTH - 6, '!') + "@.a]";
+  expect_round_trip(query);
+}
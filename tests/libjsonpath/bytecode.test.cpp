@@ -0,0 +1,91 @@
+#include "libjsonpath/bytecode.hpp" // libjsonpath::compile_filter
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <variant>                  // std::get
+
+using libjsonpath::Box;
+using libjsonpath::FilterSelector;
+using libjsonpath::Segment;
+
+class BytecodeTest : public testing::Test {
+protected:
+  // Compile the filter of the single filter selector in _query_ and check
+  // its listing against _want_.
+  void expect_program(std::string_view query, std::string_view want,
+      std::size_t registers) {
+    const auto path{libjsonpath::parse(query)};
+    const auto& selector{std::get<Segment>(path[0]).selectors[0]};
+    const auto& expression{std::get<Box<FilterSelector>>(selector)->expression};
+    const auto program{libjsonpath::compile_filter(expression)};
+    EXPECT_EQ(libjsonpath::to_string(program), want) << query;
+    EXPECT_EQ(program.registers, registers) << query;
+  }
+};
+
+TEST_F(BytecodeTest, TypedComparisons) {
+  expect_program("$[?@.a > 1]",
+      "0: load_singular r0, @['a']\n"
+      "1: compare_number r0 > 1\n",
+      1);
+  expect_program("$[?'x' == @.b[0]]",
+      "0: load_singular r0, @['b'][0]\n"
+      "1: compare_string r0 == \"x\"\n",
+      1);
+}
+
+TEST_F(BytecodeTest, LiteralOnTheLeftIsFlipped) {
+  expect_program("$[?1.5 <= @]",
+      "0: load_singular r0, @\n"
+      "1: compare_number r0 >= 1.5\n",
+      1);
+}
+
+TEST_F(BytecodeTest, GeneralComparisons) {
+  expect_program("$[?@.a == @.b]",
+      "0: load_singular r0, @['a']\n"
+      "1: load_singular r1, @['b']\n"
+      "2: compare r0 == r1\n",
+      2);
+  expect_program("$[?@.a != null]",
+      "0: load_singular r0, @['a']\n"
+      "1: load_constant r1, null\n"
+      "2: compare r0 != r1\n",
+      2);
+}
+
+TEST_F(BytecodeTest, ShortCircuitJumps) {
+  expect_program("$[?@.a && @.b || !@.c]",
+      "0: exists_singular @['a']\n"
+      "1: jump_if_false 3\n"
+      "2: exists_singular @['b']\n"
+      "3: jump_if_true 6\n"
+      "4: exists_singular @['c']\n"
+      "5: not\n",
+      0);
+}
+
+TEST_F(BytecodeTest, OperandsAreLeftToTheEvaluator) {
+  expect_program("$[?length(@.a) > 2]",
+      "0: load_value r0, length(@['a'])\n"
+      "1: compare_number r0 > 2\n",
+      1);
+  expect_program("$[?@..a]", "0: test @..['a']\n", 0);
+  expect_program("$[?match(@.a, 'b.*')]", "0: test match(@['a'], \"b.*\")\n",
+      0);
+}
+
+TEST_F(BytecodeTest, InvariantsAreLeftToTheEvaluator) {
+  expect_program("$[?$.a == 1 && @.b == $.c]",
+      "0: test $['a'] == 1\n"
+      "1: jump_if_false 5\n"
+      "2: load_singular r0, @['b']\n"
+      "3: load_value r1, $['c']\n"
+      "4: compare r0 == r1\n",
+      2);
+}
+
+TEST_F(BytecodeTest, BooleanLiterals) {
+  expect_program("$[?true]", "0: set true\n", 0);
+}
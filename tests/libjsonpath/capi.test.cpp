@@ -0,0 +1,154 @@
+#include "libjsonpath/capi.h" // jsonpath_*
+#include <gtest/gtest.h>      // EXPEXT_* TEST_F testing::Test
+#include <string>             // std::string
+#include <string_view>        // std::string_view
+#include <vector>             // std::vector
+
+class CApiTest : public testing::Test {
+protected:
+  std::string to_string(const jsonpath_query* query) {
+    size_t length{0};
+    EXPECT_EQ(jsonpath_to_string(query, nullptr, 0, &length),
+        JSONPATH_BUFFER_TOO_SMALL);
+    std::string rv(length, '\0');
+    EXPECT_EQ(jsonpath_to_string(query, rv.data(), rv.size(), &length),
+        JSONPATH_OK);
+    return rv;
+  }
+};
+
+TEST_F(CApiTest, Version) { EXPECT_STRNE(jsonpath_version(), ""); }
+
+TEST_F(CApiTest, ParseAndToString) {
+  std::string_view query{"$.foo[?@.bar > 1]"};
+  jsonpath_query* handle{nullptr};
+  jsonpath_error error{};
+  ASSERT_EQ(jsonpath_parse(query.data(), query.size(), &handle, &error),
+      JSONPATH_OK);
+  ASSERT_NE(handle, nullptr);
+  EXPECT_EQ(error.status, JSONPATH_OK);
+  EXPECT_EQ(to_string(handle), "$['foo'][?@['bar'] > 1]");
+  jsonpath_free(handle);
+}
+
+TEST_F(CApiTest, HandleOwnsQuery) {
+  std::string query{"$.some_long_member_name_beyond_sso[?@.other]"};
+  jsonpath_query* handle{nullptr};
+  ASSERT_EQ(jsonpath_parse(query.data(), query.size(), &handle, nullptr),
+      JSONPATH_OK);
+  query.assign(query.size(), 'x');
+  EXPECT_EQ(to_string(handle),
+      "$['some_long_member_name_beyond_sso'][?@['other']]");
+  jsonpath_free(handle);
+}
+
+TEST_F(CApiTest, SyntaxError) {
+  std::string_view query{"$.foo["};
+  jsonpath_query* handle{nullptr};
+  jsonpath_error error{};
+  EXPECT_EQ(jsonpath_parse(query.data(), query.size(), &handle, &error),
+      JSONPATH_SYNTAX_ERROR);
+  EXPECT_EQ(handle, nullptr);
+  EXPECT_EQ(error.status, JSONPATH_SYNTAX_ERROR);
+  EXPECT_STRNE(error.message, "");
+}
+
+TEST_F(CApiTest, TypeAndNameErrors) {
+  std::string_view type_error{"$[?length(@.*) < 3]"};
+  std::string_view name_error{"$[?nosuchthing(@.a)]"};
+  jsonpath_query* handle{nullptr};
+  jsonpath_error error{};
+  EXPECT_EQ(jsonpath_parse(type_error.data(), type_error.size(), &handle,
+                &error),
+      JSONPATH_TYPE_ERROR);
+  EXPECT_EQ(error.index, 3);
+  EXPECT_EQ(jsonpath_parse(name_error.data(), name_error.size(), &handle,
+                &error),
+      JSONPATH_NAME_ERROR);
+}
+
+TEST_F(CApiTest, InvalidArguments) {
+  EXPECT_EQ(jsonpath_parse("$", 1, nullptr, nullptr),
+      JSONPATH_INVALID_ARGUMENT);
+  EXPECT_EQ(jsonpath_to_string(nullptr, nullptr, 0, nullptr),
+      JSONPATH_INVALID_ARGUMENT);
+  jsonpath_free(nullptr);
+}
+
+TEST_F(CApiTest, ParseBatch) {
+  std::vector<std::string_view> queries{"$.a", "$[", "$['a']", "$..b"};
+  std::vector<const char*> data{};
+  std::vector<size_t> lengths{};
+  for (auto query : queries) {
+    data.push_back(query.data());
+    lengths.push_back(query.size());
+  }
+
+  std::vector<jsonpath_query*> handles(queries.size());
+  std::vector<jsonpath_status> statuses(queries.size());
+  EXPECT_EQ(jsonpath_parse_batch(data.data(), lengths.data(), queries.size(),
+                handles.data(), statuses.data()),
+      JSONPATH_SYNTAX_ERROR);
+
+  EXPECT_EQ(statuses[0], JSONPATH_OK);
+  EXPECT_EQ(statuses[1], JSONPATH_SYNTAX_ERROR);
+  EXPECT_EQ(statuses[2], JSONPATH_OK);
+  EXPECT_EQ(statuses[3], JSONPATH_OK);
+  EXPECT_EQ(handles[1], nullptr);
+
+  EXPECT_TRUE(jsonpath_equal(handles[0], handles[2]));
+  EXPECT_FALSE(jsonpath_equal(handles[0], handles[3]));
+  EXPECT_EQ(jsonpath_hash(handles[0]), jsonpath_hash(handles[2]));
+
+  jsonpath_free_batch(handles.data(), handles.size());
+  EXPECT_EQ(handles[0], nullptr);
+}
+
+TEST_F(CApiTest, ToStringBatch) {
+  jsonpath_query* a{nullptr};
+  jsonpath_query* b{nullptr};
+  ASSERT_EQ(jsonpath_parse("$.a", 3, &a, nullptr), JSONPATH_OK);
+  ASSERT_EQ(jsonpath_parse("$.*", 3, &b, nullptr), JSONPATH_OK);
+  const jsonpath_query* queries[]{a, b};
+  size_t offsets[3];
+
+  EXPECT_EQ(jsonpath_to_string_batch(queries, 2, nullptr, 0, offsets),
+      JSONPATH_BUFFER_TOO_SMALL);
+  EXPECT_EQ(offsets[2], 10);
+
+  std::string buffer(offsets[2], '\0');
+  EXPECT_EQ(jsonpath_to_string_batch(
+                queries, 2, buffer.data(), buffer.size(), offsets),
+      JSONPATH_OK);
+  EXPECT_EQ(buffer.substr(offsets[0], offsets[1] - offsets[0]), "$['a']");
+  EXPECT_EQ(buffer.substr(offsets[1], offsets[2] - offsets[1]), "$[*]");
+
+  jsonpath_free(a);
+  jsonpath_free(b);
+}
+
+TEST_F(CApiTest, DumpAndLoad) {
+  jsonpath_query* handle{nullptr};
+  ASSERT_EQ(
+      jsonpath_parse("$[?count(@.*) > 1]", 18, &handle, nullptr), JSONPATH_OK);
+
+  size_t length{0};
+  EXPECT_EQ(jsonpath_dump(handle, nullptr, 0, &length),
+      JSONPATH_BUFFER_TOO_SMALL);
+  std::string image(length, '\0');
+  EXPECT_EQ(jsonpath_dump(handle, image.data(), image.size(), &length),
+      JSONPATH_OK);
+
+  jsonpath_query* loaded{nullptr};
+  EXPECT_EQ(jsonpath_load(image.data(), image.size(), &loaded, nullptr),
+      JSONPATH_OK);
+  image.assign(image.size(), '\0');
+  EXPECT_TRUE(jsonpath_equal(handle, loaded));
+  EXPECT_EQ(to_string(loaded), "$[?count(@[*]) > 1]");
+
+  jsonpath_error error{};
+  EXPECT_EQ(jsonpath_load("nope", 4, &loaded, &error), JSONPATH_FORMAT_ERROR);
+  EXPECT_EQ(loaded, nullptr);
+
+  jsonpath_free(handle);
+}
@@ -0,0 +1,103 @@
+#include "libjsonpath/containment.hpp" // libjsonpath::contained_in
+#include "libjsonpath/jsonpath.hpp"    // libjsonpath::parse
+#include <gtest/gtest.h>               // EXPEXT_* TEST_F testing::Test
+#include <string>                      // std::string
+#include <string_view>                 // std::string_view
+#include <variant>                     // std::visit
+
+using libjsonpath::path_step_t;
+
+class ContainmentTest : public testing::Test {
+protected:
+  std::optional<libjsonpath::Residual> contained(
+      std::string_view a, std::string_view b) {
+    return libjsonpath::contained_in(
+        libjsonpath::parse(a), libjsonpath::parse(b));
+  }
+
+  std::string filter_string(const libjsonpath::Residual& residual) {
+    return std::visit(
+        libjsonpath::ExpressionToStringVisitor{}, residual.filter.value());
+  }
+};
+
+TEST_F(ContainmentTest, IdenticalQueries) {
+  auto got{contained("$.a.b[*]", "$['a']['b'][*]")};
+  ASSERT_TRUE(got);
+  EXPECT_TRUE(got->empty());
+  EXPECT_TRUE(contained("$..a[?@.b]", "$..a[?@.b]"));
+}
+
+TEST_F(ContainmentTest, IndexInWildcard) {
+  auto got{contained("$.a.b[0]", "$.a.b[*]")};
+  ASSERT_TRUE(got);
+  ASSERT_EQ(got->restrictions.size(), 1);
+  EXPECT_EQ(got->restrictions.front().segment, 2);
+  EXPECT_FALSE(got->filter);
+
+  EXPECT_TRUE(got->matches_location({"a", "b", std::int64_t{0}}));
+  EXPECT_FALSE(got->matches_location({"a", "b", std::int64_t{1}}));
+  EXPECT_FALSE(got->matches_location({"a", "b", "0"}));
+}
+
+TEST_F(ContainmentTest, NamesAndSlices) {
+  auto got{contained("$['a', 'b'][2].c", "$[*][1:5].c")};
+  ASSERT_TRUE(got);
+  EXPECT_EQ(got->restrictions.size(), 2);
+  EXPECT_TRUE(got->matches_location({"b", std::int64_t{2}, "c"}));
+  EXPECT_FALSE(got->matches_location({"c", std::int64_t{2}, "c"}));
+
+  got = contained("$.a[2:4]", "$.a[0:10]");
+  ASSERT_TRUE(got);
+  EXPECT_TRUE(got->matches_location({"a", std::int64_t{3}}));
+  EXPECT_FALSE(got->matches_location({"a", std::int64_t{4}}));
+
+  got = contained("$.a[0:10:2]", "$.a[*]");
+  ASSERT_TRUE(got);
+  EXPECT_TRUE(got->matches_location({"a", std::int64_t{4}}));
+  EXPECT_FALSE(got->matches_location({"a", std::int64_t{5}}));
+
+  EXPECT_TRUE(contained("$.a[3]", "$.a[1:10:2]"));
+  EXPECT_FALSE(contained("$.a[4]", "$.a[1:10:2]"));
+  EXPECT_FALSE(contained("$.a[2:12]", "$.a[0:10]"));
+}
+
+TEST_F(ContainmentTest, NarrowerFilter) {
+  auto got{contained("$.a[?@.x > 5 && @.y]", "$.a[?@.x > 5]")};
+  ASSERT_TRUE(got);
+  EXPECT_TRUE(got->restrictions.empty());
+  EXPECT_EQ(filter_string(got.value()), "@['y']");
+
+  got = contained("$.a[?@.z && @.x > 5 && @.y]", "$.a[?@.x > 5]");
+  ASSERT_TRUE(got);
+  EXPECT_EQ(filter_string(got.value()), "(@['z'] && @['y'])");
+
+  got = contained("$.a[?@.y && @.x]", "$.a[?@.x && @.y]");
+  ASSERT_TRUE(got);
+  EXPECT_TRUE(got->empty());
+}
+
+TEST_F(ContainmentTest, FilterInWildcard) {
+  auto got{contained("$.a[?@.x > 5]", "$.a.*")};
+  ASSERT_TRUE(got);
+  EXPECT_EQ(filter_string(got.value()), "@['x'] > 5");
+}
+
+TEST_F(ContainmentTest, NotContained) {
+  EXPECT_FALSE(contained("$.a[*]", "$.a[0]"));
+  EXPECT_FALSE(contained("$.a.b", "$.a"));
+  EXPECT_FALSE(contained("$.a", "$.a.b"));
+  EXPECT_FALSE(contained("$.a[?@.x > 5]", "$.a[?@.x > 5 && @.y]"));
+  EXPECT_FALSE(contained("$.a[?@.x]", "$.a[?@.y]"));
+  EXPECT_FALSE(contained("$..a", "$.a"));
+}
+
+TEST_F(ContainmentTest, ResidualNeedsMoreThanResults) {
+  // A filter on an ancestor of the results would need the document.
+  EXPECT_FALSE(contained("$[?@.x && @.y].b", "$[?@.x].b"));
+  // Negative indices depend on array lengths.
+  EXPECT_FALSE(contained("$.a[-1]", "$.a[*]"));
+  // Path steps don't line up with segments after a descendant segment.
+  EXPECT_FALSE(contained("$..a[0]", "$..a[*]"));
+  EXPECT_FALSE(contained("$..a", "$..*"));
+}
@@ -0,0 +1,81 @@
+#include "libjsonpath/cost.hpp"     // libjsonpath::estimate_cost
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string_view>              // std::string_view
+
+using libjsonpath::ComplexityClass;
+
+class CostTest : public testing::Test {
+protected:
+  libjsonpath::CostEstimate estimate(std::string_view query) {
+    return libjsonpath::estimate_cost(libjsonpath::parse(query));
+  }
+
+  void expect_complexity(std::string_view query, ComplexityClass complexity,
+      unsigned nodes_exponent, unsigned depth_exponent) {
+    auto got{estimate(query)};
+    EXPECT_EQ(got.complexity, complexity) << query;
+    EXPECT_EQ(got.nodes_exponent, nodes_exponent) << query;
+    EXPECT_EQ(got.depth_exponent, depth_exponent) << query;
+  }
+};
+
+TEST_F(CostTest, Singular) {
+  expect_complexity("$", ComplexityClass::constant, 0, 0);
+  expect_complexity("$.a.b[0]", ComplexityClass::constant, 0, 0);
+  expect_complexity("$['a', 'b'][0, 1]", ComplexityClass::constant, 0, 0);
+  EXPECT_TRUE(estimate("$.a.b").singular);
+  EXPECT_FALSE(estimate("$.a[0, 1]").singular);
+}
+
+TEST_F(CostTest, Linear) {
+  expect_complexity("$.a[*]", ComplexityClass::linear, 1, 0);
+  expect_complexity("$.a[1:5].b", ComplexityClass::linear, 1, 0);
+  expect_complexity("$..a", ComplexityClass::linear, 1, 0);
+  expect_complexity("$.a[?@.b > 1]", ComplexityClass::linear, 1, 0);
+  expect_complexity("$[?@.a > $.threshold]", ComplexityClass::linear, 1, 0);
+  expect_complexity("$.*.*.*", ComplexityClass::linear, 1, 0);
+}
+
+TEST_F(CostTest, DescendantDepth) {
+  expect_complexity("$..*..*", ComplexityClass::linear_depth, 1, 1);
+  expect_complexity("$..a..b..c", ComplexityClass::linear_depth, 1, 2);
+  expect_complexity("$.*..a", ComplexityClass::linear_depth, 1, 1);
+  EXPECT_EQ(estimate("$..a..b..c").descendant_segments, 3);
+}
+
+TEST_F(CostTest, NestedFilterQueries) {
+  expect_complexity("$[?@..x]", ComplexityClass::polynomial, 2, 0);
+  expect_complexity("$..*..*[?@..x]", ComplexityClass::polynomial, 2, 1);
+  expect_complexity("$[?@[?@[?@.*]]]", ComplexityClass::polynomial, 4, 0);
+  EXPECT_EQ(estimate("$[?@[?@[?@.*]]]").filter_depth, 3);
+  EXPECT_EQ(estimate("$[?@.a][?@.b]").filter_depth, 1);
+  EXPECT_EQ(estimate("$.a").filter_depth, 0);
+}
+
+TEST_F(CostTest, RootQueriesAreEvaluatedOnce) {
+  expect_complexity("$[?$..x]", ComplexityClass::linear, 1, 0);
+  expect_complexity("$[?$..x..y]", ComplexityClass::linear_depth, 1, 1);
+}
+
+TEST_F(CostTest, RegexFunctions) {
+  auto got{estimate("$[?match(@.a, 'x') || search(@.b, 'y')]")};
+  EXPECT_EQ(got.regex_functions, 2);
+  EXPECT_EQ(estimate("$[?length(@.a) > 1]").regex_functions, 0);
+}
+
+TEST_F(CostTest, Bound) {
+  // One visit to the root, then one to each of its children.
+  auto got{estimate("$.*")};
+  EXPECT_EQ(got.bound(100, 5), 101);
+  EXPECT_EQ(estimate("$.a").bound(1000000, 100), estimate("$.a").bound(1, 1));
+  EXPECT_LT(
+      estimate("$..*").bound(1000, 10), estimate("$..*..*").bound(1000, 10));
+  EXPECT_LT(estimate("$..*..*").bound(1000, 10),
+      estimate("$..*..*[?@..x]").bound(1000, 10));
+}
+
+TEST_F(CostTest, BoundSaturates) {
+  auto got{estimate("$[?@[?@[?@[?@[?@[?@.*]]]]]]")};
+  EXPECT_EQ(got.bound(1000000000, 1000), UINT64_MAX);
+}
@@ -0,0 +1,112 @@
+#include "libjsonpath/exceptions.hpp" // libjsonpath::Exception
+#include "libjsonpath/find.hpp"       // libjsonpath::Evaluator
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include "libjsonpath/value.hpp"      // libjsonpath::parse_json
+#include <gtest/gtest.h> // EXPECT_* TEST_P testing::TestWithParam
+#include <cctype>        // std::isalnum
+#include <cstddef>       // std::size_t
+#include <fstream>       // std::ifstream
+#include <sstream>       // std::ostringstream
+#include <string>        // std::string
+#include <vector>        // std::vector
+
+// Data driven tests from the JSONPath Compliance Test Suite, fetched at
+// configure time. Its location is given by LIBJSONPATH_CTS_PATH.
+//
+// Each case has a selector and either _invalid_selector_, or a document and
+// the expected nodes as _result_, or _results_ if more than one ordering is
+// allowed.
+
+using libjsonpath::parse_json;
+using libjsonpath::Value;
+using libjsonpath::ValueAdapter;
+
+namespace {
+
+const Value& suite() {
+  static const Value cts{[]() {
+    std::ifstream file{LIBJSONPATH_CTS_PATH};
+    std::ostringstream text{};
+    text << file.rdbuf();
+    return parse_json(text.str());
+  }()};
+  return cts;
+}
+
+std::vector<std::size_t> case_indices() {
+  std::vector<std::size_t> rv{};
+  const auto* tests{suite().find("tests")};
+  for (std::size_t i = 0; tests && i < tests->as_array().size(); i++) {
+    rv.push_back(i);
+  }
+  return rv;
+}
+
+const Value& test_case(std::size_t index) {
+  return suite().find("tests")->as_array()[index];
+}
+
+// A gtest parameter name made from a case's name. Names in the suite are
+// unique, but aren't valid identifiers.
+std::string case_name(const testing::TestParamInfo<std::size_t>& info) {
+  std::string rv{};
+  for (const char ch : test_case(info.param).find("name")->as_string()) {
+    rv.push_back(std::isalnum(static_cast<unsigned char>(ch)) ? ch : '_');
+  }
+  return rv + "_" + std::to_string(info.param);
+}
+
+} // namespace
+
+class ComplianceTest : public testing::TestWithParam<std::size_t> {};
+
+TEST_P(ComplianceTest, Case) {
+  const auto& cts{test_case(GetParam())};
+  const auto& selector{cts.find("selector")->as_string()};
+
+  if (const auto* invalid{cts.find("invalid_selector")};
+      invalid && invalid->as_bool()) {
+    EXPECT_THROW(libjsonpath::parse(selector), libjsonpath::Exception)
+        << selector;
+    return;
+  }
+
+  const auto path{libjsonpath::parse(selector)};
+  for (const bool bytecode : {true, false}) {
+    libjsonpath::Evaluator<ValueAdapter> evaluator{path, {bytecode}};
+    Value::array_t nodes{};
+    Value::array_t paths{};
+    for (const auto& node : evaluator.find(cts.find("document"))) {
+      nodes.push_back(*node.value);
+      paths.push_back(node.path());
+    }
+    const Value got{nodes};
+    const Value got_paths{paths};
+
+    if (const auto* result{cts.find("result")}) {
+      EXPECT_EQ(got, *result)
+          << selector << " got " << libjsonpath::to_json(got);
+      if (const auto* result_paths{cts.find("result_paths")}) {
+        EXPECT_EQ(got_paths, *result_paths)
+            << selector << " got " << libjsonpath::to_json(got_paths);
+      }
+      continue;
+    }
+
+    // Objects have no defined member order, so any of _results_ will do,
+    // along with its paths from _results_paths_ if given.
+    const auto& results{cts.find("results")->as_array()};
+    const auto* results_paths{cts.find("results_paths")};
+    bool found{false};
+    for (std::size_t i = 0; i < results.size(); i++) {
+      found = found || (got == results[i] &&
+                           (!results_paths ||
+                               got_paths == results_paths->as_array()[i]));
+    }
+    EXPECT_TRUE(found) << selector << " got " << libjsonpath::to_json(got)
+                       << " at " << libjsonpath::to_json(got_paths);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CTS, ComplianceTest, testing::ValuesIn(case_indices()), case_name);
@@ -0,0 +1,252 @@
+#include "libjsonpath/cursor.hpp"     // libjsonpath::Cursor
+#include "libjsonpath/exceptions.hpp" // libjsonpath::CursorError
+#include "libjsonpath/find.hpp"       // libjsonpath::Evaluator
+#include "libjsonpath/hash.hpp"       // libjsonpath::hash
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include "libjsonpath/value.hpp"      // libjsonpath::ValueAdapter
+#include "helpers.hpp"                // CountingAdapter node_paths
+#include <gtest/gtest.h>              // EXPEXT_* TEST_F testing::Test
+#include <cstddef>                    // std::size_t
+#include <cstdint>                    // std::int64_t
+#include <limits>                     // std::numeric_limits
+#include <string>                     // std::string
+#include <string_view>                // std::string_view
+#include <vector>                     // std::vector
+
+using libjsonpath::Cursor;
+using libjsonpath::CursorError;
+using libjsonpath::parse_json;
+using libjsonpath::Value;
+using libjsonpath::ValueAdapter;
+
+class CursorTest : public testing::Test {
+protected:
+  // Page through the results of _query_ against _document_, _size_ nodes
+  // at a time, resuming from a token for each page, and check the pages
+  // add up to the results of evaluating _query_ in one go.
+  void expect_pages(std::string_view query, std::string_view document,
+      std::size_t size) {
+    const auto root{parse_json(document)};
+    const auto path{libjsonpath::parse(query)};
+    libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+
+    const auto want{node_paths(evaluator.find(&root))};
+
+    std::vector<std::string> got{};
+    std::string token{};
+    for (;;) {
+      auto range{token.empty()
+                     ? evaluator.lazy_find(&root)
+                     : evaluator.resume(&root, Cursor::from_token(token))};
+      std::size_t count{0};
+      for (auto it{range.begin()}; it != range.end(); ++it) {
+        got.push_back(it->path());
+        if (++count == size) {
+          break;
+        }
+      }
+
+      const auto cursor{range.cursor()};
+      token = cursor.to_token();
+      if (count < size) {
+        break;
+      }
+    }
+
+    EXPECT_EQ(got, want) << query;
+  }
+};
+
+TEST_F(CursorTest, TokenRoundTrip) {
+  Cursor cursor{};
+  cursor.query_hash = 0x0123456789ABCDEF;
+  cursor.returned = true;
+  cursor.entries = {{0, 1, true, 5}, {2, 0, false, -3}};
+  cursor.location = {"a\xC3\xA9", std::int64_t{7}};
+
+  const auto token{cursor.to_token()};
+  EXPECT_EQ(token.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                    "abcdefghijklmnopqrstuvwxyz0123456789-_"),
+      std::string::npos);
+
+  const auto got{Cursor::from_token(token)};
+  EXPECT_EQ(got.query_hash, cursor.query_hash);
+  EXPECT_FALSE(got.done);
+  EXPECT_TRUE(got.returned);
+  ASSERT_EQ(got.entries.size(), 2);
+  EXPECT_EQ(got.entries[0].selector, 1);
+  EXPECT_EQ(got.entries[0].index, 5);
+  EXPECT_EQ(got.entries[1].segment, 2);
+  EXPECT_FALSE(got.entries[1].started);
+  EXPECT_EQ(got.entries[1].index, -3);
+  EXPECT_EQ(got.location, cursor.location);
+}
+
+TEST_F(CursorTest, MalformedTokens) {
+  EXPECT_THROW(Cursor::from_token(""), CursorError);
+  EXPECT_THROW(Cursor::from_token("not a token!"), CursorError);
+  EXPECT_THROW(Cursor::from_token("A"), CursorError);
+
+  auto token{Cursor{}.to_token()};
+  EXPECT_THROW(Cursor::from_token(token.substr(0, token.size() - 2)),
+      CursorError);
+  EXPECT_THROW(Cursor::from_token(token + "AA"), CursorError);
+
+  // An unknown version.
+  token[0] = 'B';
+  EXPECT_THROW(Cursor::from_token(token), CursorError);
+
+  // Slice indices far outside the slice's bounds.
+  const auto root{parse_json("[0, 1, 2, 3, 4, 5]")};
+  const auto path{libjsonpath::parse("$[1:5]")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+  auto range{evaluator.lazy_find(&root)};
+  range.begin();
+  const auto cursor{range.cursor()};
+
+  for (const auto index : {std::numeric_limits<std::int64_t>::min(),
+           std::numeric_limits<std::int64_t>::max(), std::int64_t{-1},
+           std::int64_t{7}}) {
+    auto hostile{cursor};
+    for (auto& entry : hostile.entries) {
+      entry.index = index;
+    }
+    EXPECT_THROW(evaluator.resume(&root,
+                     Cursor::from_token(hostile.to_token())),
+        CursorError)
+        << index;
+  }
+}
+
+TEST_F(CursorTest, ForgedLocations) {
+  const auto root{parse_json(R"({
+    "public": ["a", "b"],
+    "items": [{"public": true}, {"secret": "x"}],
+    "secret": "hunter2"
+  })")};
+
+  // Tokens are checked against the query, not just its hash, so a forged
+  // location can't make a query return a node it doesn't select.
+  const auto expect_forged{[&](std::string_view query, Cursor cursor) {
+    const auto path{libjsonpath::parse(query)};
+    libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+    cursor.query_hash = libjsonpath::hash(path);
+    EXPECT_THROW(evaluator.resume(&root, Cursor::from_token(cursor.to_token())),
+        CursorError)
+        << query;
+  }};
+
+  Cursor cursor{};
+  cursor.entries = {{0, 1, false, 0}, {2, 0, false, 0}};
+  cursor.location = {std::string{"secret"}};
+  expect_forged("$.public[*]", cursor);
+
+  cursor.entries = {{0, 0, true, 0}, {1, 0, false, 0}};
+  expect_forged("$.public", cursor);
+
+  // A member of the right node, but not the one a wildcard visited last.
+  cursor.entries = {{0, 0, true, 1}, {1, 0, false, 0}};
+  expect_forged("$.*", cursor);
+
+  // An element a filter doesn't select, and one an index doesn't.
+  cursor.entries = {{0, 0, true, 0}, {1, 0, true, 2}, {2, 0, false, 0}};
+  cursor.location = {std::string{"items"}, std::int64_t{1}};
+  expect_forged("$.items[?@.public]", cursor);
+  expect_forged("$.items[0]", cursor);
+
+  // The legitimate cursor for the filter resumes as usual.
+  const auto path{libjsonpath::parse("$.items[?@.public]")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+  cursor.query_hash = libjsonpath::hash(path);
+  cursor.entries = {{0, 0, true, 0}, {1, 0, true, 1}, {2, 0, false, 0}};
+  cursor.location = {std::string{"items"}, std::int64_t{0}};
+  cursor.returned = true;
+  EXPECT_TRUE(node_paths(evaluator.resume(&root, cursor)).empty());
+}
+
+TEST_F(CursorTest, Pages) {
+  const std::string document{R"({"logs": [
+    {"level": "error", "n": 0}, {"level": "info", "n": 1},
+    {"level": "error", "n": 2}, {"level": "error", "n": 3},
+    {"level": "debug", "n": 4}, {"level": "error", "n": 5},
+    {"level": "error", "n": 6}
+  ]})"};
+
+  expect_pages("$.logs[?@.level == 'error']", document, 2);
+  expect_pages("$.logs[?@.level == 'error'].n", document, 1);
+  expect_pages("$.logs[1:6:2, 0, ::-3]", document, 2);
+  expect_pages("$..n", document, 3);
+  expect_pages("$..[?@.n > 4]", document, 1);
+  expect_pages("$.logs[*].*", document, 4);
+  expect_pages("$.nope", document, 1);
+}
+
+TEST_F(CursorTest, LaterPagesCostTheSame) {
+  Value::array_t logs{};
+  for (int i = 0; i < 1000; i++) {
+    logs.push_back(Value::object_t{
+        {"level", i % 2 ? "info" : "error"}, {"n", i}});
+  }
+  const Value root{Value::object_t{{"logs", logs}}};
+
+  const auto path{libjsonpath::parse("$.logs[?@.level == 'error']")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  // Skip to the last page.
+  auto range{evaluator.lazy_find(&root)};
+  std::size_t count{0};
+  for (auto it{range.begin()}; it != range.end() && ++count < 490; ++it) {
+  }
+  const auto token{range.cursor().to_token()};
+
+  CountingAdapter::visits = 0;
+  auto first{evaluator.lazy_find(&root)};
+  count = 0;
+  for (auto it{first.begin()}; it != first.end() && ++count < 10; ++it) {
+  }
+  const auto first_page_visits{CountingAdapter::visits};
+
+  CountingAdapter::visits = 0;
+  const auto paths{
+      node_paths(evaluator.resume(&root, Cursor::from_token(token)))};
+
+  ASSERT_EQ(paths.size(), 10);
+  EXPECT_EQ(paths.front(), "$['logs'][980]");
+  EXPECT_EQ(paths.back(), "$['logs'][998]");
+  EXPECT_LT(CountingAdapter::visits, 2 * first_page_visits);
+}
+
+TEST_F(CursorTest, ExhaustedCursor) {
+  const auto root{parse_json("[1, 2]")};
+  const auto path{libjsonpath::parse("$[*]")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+
+  auto range{evaluator.lazy_find(&root)};
+  for (auto it{range.begin()}; it != range.end(); ++it) {
+  }
+  const auto cursor{range.cursor()};
+  EXPECT_TRUE(cursor.done);
+
+  auto rest{evaluator.resume(&root, Cursor::from_token(cursor.to_token()))};
+  EXPECT_EQ(rest.begin(), rest.end());
+}
+
+TEST_F(CursorTest, WrongQueryOrDocument) {
+  const auto root{parse_json(R"({"a": [1, 2, 3]})")};
+  const auto path{libjsonpath::parse("$.a[*]")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+
+  auto range{evaluator.lazy_find(&root)};
+  range.begin();
+  const auto cursor{range.cursor()};
+
+  const auto other{libjsonpath::parse("$.b[*]")};
+  libjsonpath::Evaluator<ValueAdapter> other_evaluator{other};
+  EXPECT_THROW(other_evaluator.resume(&root, cursor), CursorError);
+
+  const auto changed{parse_json(R"({"b": [1, 2, 3]})")};
+  EXPECT_THROW(evaluator.resume(&changed, cursor), CursorError);
+
+  const auto shorter{parse_json(R"({"a": []})")};
+  EXPECT_THROW(evaluator.resume(&shorter, cursor), CursorError);
+}
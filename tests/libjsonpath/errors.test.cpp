@@ -41,6 +41,27 @@ TEST_F(ErrorTest, EmptyBracketedSegment) {
   expect_syntax_error("$.foo[]", "empty bracketed segment ('$.foo[]':5)");
 }
 
+TEST_F(ErrorTest, IndexOutOfRange) {
+  expect_syntax_error("$[9007199254740992]",
+      "array index out of range '9007199254740992' "
+      "('$[9007199254740992]':2)");
+  expect_syntax_error("$[-9007199254740992]",
+      "array index out of range '-9007199254740992' "
+      "('$[-9007199254740992]':2)");
+  expect_syntax_error("$[1::9223372036854775807]",
+      "array index out of range '9223372036854775807' "
+      "('$[1::9223372036854775807]':5)");
+}
+
+TEST_F(ErrorTest, LiteralsMustBeCompared) {
+  expect_type_error(
+      "$[?1]", "filter expression literals must be compared ('$[?1]':3)");
+  expect_type_error("$[?@.a && 'x']",
+      "filter expression literals must be compared ('$[?@.a && 'x']':11)");
+  expect_type_error(
+      "$[?!null]", "filter expression literals must be compared ('$[?!null]':4)");
+}
+
 TEST_F(ErrorTest, NonSingularQueryInComparison) {
   expect_type_error(
       "$[?@[*]==0]", "non-singular query is not comparable ('$[?@[*]==0]':3)");
@@ -0,0 +1,509 @@
+#include "libjsonpath/find.hpp"       // libjsonpath::Evaluator
+#include "libjsonpath/exceptions.hpp" // libjsonpath::NameError
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include "libjsonpath/value.hpp"      // libjsonpath::ValueAdapter
+#include "helpers.hpp"                // CountingAdapter node_paths
+#include <gtest/gtest.h>              // EXPEXT_* TEST_F testing::Test
+#include <cstddef>                    // std::size_t
+#include <string>                     // std::string
+#include <string_view>                // std::string_view
+#include <variant>                    // std::get std::get_if
+#include <vector>                     // std::vector
+
+using libjsonpath::parse_json;
+using libjsonpath::Value;
+using libjsonpath::ValueAdapter;
+
+class FindTest : public testing::Test {
+protected:
+  // Check the values selected by _query_ from _document_ against the JSON
+  // array _want_, and their normalized paths against _paths_, if given.
+  // Filters are checked with and without the bytecode interpreter.
+  void expect_find(std::string_view query, std::string_view document,
+      std::string_view want, const std::vector<std::string>& paths = {}) {
+    expect_find(query, document, want, paths, {true});
+    expect_find(query, document, want, paths, {false});
+  }
+
+  void expect_find(std::string_view query, std::string_view document,
+      std::string_view want, const std::vector<std::string>& paths,
+      const libjsonpath::EvaluatorOptions& options) {
+    const auto root{parse_json(document)};
+    const auto path{libjsonpath::parse(query)};
+    libjsonpath::Evaluator<ValueAdapter> evaluator{path, options};
+    const auto nodes{evaluator.find(&root)};
+
+    Value::array_t got{};
+    std::vector<std::string> got_paths{};
+    for (const auto& node : nodes) {
+      got.push_back(*node.value);
+      got_paths.push_back(node.path());
+    }
+
+    EXPECT_EQ(Value{got}, parse_json(want))
+        << query << " got " << libjsonpath::to_json(Value{got})
+        << (options.bytecode ? "" : " without bytecode");
+    if (!paths.empty()) {
+      EXPECT_EQ(got_paths, paths) << query;
+    }
+
+    // Lazy evaluation selects the same nodes in the same order.
+    EXPECT_EQ(node_paths(evaluator.lazy_find(&root)), got_paths)
+        << query << " lazily";
+  }
+};
+
+// Examples from section 2.3.1.3 of RFC 9535.
+TEST_F(FindTest, NameSelector) {
+  const std::string document{R"({"o": {"j j": {"k.k": 3}}, "'": {"@": 2}})"};
+  expect_find("$.o['j j']", document, R"([{"k.k": 3}])", {"$['o']['j j']"});
+  expect_find("$.o['j j']['k.k']", document, "[3]", {"$['o']['j j']['k.k']"});
+  expect_find(R"($.o["j j"]["k.k"])", document, "[3]");
+  expect_find(R"($["'"]["@"])", document, "[2]", {R"($['\'']['@'])"});
+}
+
+// Examples from section 2.3.2.3 of RFC 9535.
+TEST_F(FindTest, WildcardSelector) {
+  const std::string document{R"({"o": {"j": 1, "k": 2}, "a": [5, 3]})"};
+  expect_find("$[*]", document, R"([{"j": 1, "k": 2}, [5, 3]])");
+  expect_find("$.o[*]", document, "[1, 2]", {"$['o']['j']", "$['o']['k']"});
+  expect_find("$.o[*, *]", document, "[1, 2, 1, 2]");
+  expect_find("$.a[*]", document, "[5, 3]", {"$['a'][0]", "$['a'][1]"});
+}
+
+// Examples from section 2.3.3.3 of RFC 9535.
+TEST_F(FindTest, IndexSelector) {
+  expect_find("$[1]", R"(["a", "b"])", R"(["b"])", {"$[1]"});
+  expect_find("$[-2]", R"(["a", "b"])", R"(["a"])", {"$[0]"});
+  expect_find("$[2]", R"(["a", "b"])", "[]");
+  expect_find("$[0]", R"({"0": 1})", "[]");
+}
+
+// Examples from section 2.3.4.3 of RFC 9535.
+TEST_F(FindTest, SliceSelector) {
+  const std::string document{R"(["a", "b", "c", "d", "e", "f", "g"])"};
+  expect_find("$[1:3]", document, R"(["b", "c"])", {"$[1]", "$[2]"});
+  expect_find("$[5:]", document, R"(["f", "g"])");
+  expect_find("$[1:5:2]", document, R"(["b", "d"])");
+  expect_find("$[5:1:-2]", document, R"(["f", "d"])", {"$[5]", "$[3]"});
+  expect_find("$[::-1]", document, R"(["g", "f", "e", "d", "c", "b", "a"])");
+  expect_find("$[::0]", document, "[]");
+  expect_find("$[-100:100:3]", document, R"(["a", "d", "g"])");
+  expect_find("$[100:-100:-3]", document, R"(["g", "d", "a"])");
+}
+
+// Examples from section 2.3.5.3 of RFC 9535.
+TEST_F(FindTest, FilterSelector) {
+  const std::string document{R"({
+    "a": [3, 5, 1, 2, 4, 6, {"b": "j"}, {"b": "k"}, {"b": {}}, {"b": "kilo"}],
+    "o": {"p": 1, "q": 2, "r": 3, "s": 5, "t": {"u": 6}},
+    "e": "f"
+  })"};
+
+  expect_find("$.a[?@.b == 'kilo']", document, R"([{"b": "kilo"}])",
+      {"$['a'][9]"});
+  expect_find("$.a[?(@.b == 'kilo')]", document, R"([{"b": "kilo"}])");
+  expect_find("$.a[?@>3.5]", document, "[5, 4, 6]");
+  expect_find("$.a[?@.b]", document,
+      R"([{"b": "j"}, {"b": "k"}, {"b": {}}, {"b": "kilo"}])");
+  expect_find("$[?@.*]", document,
+      R"([[3, 5, 1, 2, 4, 6, {"b": "j"}, {"b": "k"}, {"b": {}},
+          {"b": "kilo"}],
+         {"p": 1, "q": 2, "r": 3, "s": 5, "t": {"u": 6}}])");
+  expect_find("$[?@[?@.b]]", document,
+      R"([[3, 5, 1, 2, 4, 6, {"b": "j"}, {"b": "k"}, {"b": {}},
+          {"b": "kilo"}]])");
+  expect_find("$.o[?@<3, ?@<3]", document, "[1, 2, 1, 2]");
+  expect_find(
+      R"($.a[?@<2 || @.b == "k"])", document, R"([1, {"b": "k"}])");
+  expect_find(R"($.a[?match(@.b, "[jk]")])", document,
+      R"([{"b": "j"}, {"b": "k"}])");
+  expect_find(R"($.a[?search(@.b, "[jk]")])", document,
+      R"([{"b": "j"}, {"b": "k"}, {"b": "kilo"}])");
+  expect_find("$.o[?@>1 && @<4]", document, "[2, 3]");
+  expect_find("$.o[?@.u || @.x]", document, R"([{"u": 6}])");
+  expect_find("$.a[?@.b == $.x]", document, "[3, 5, 1, 2, 4, 6]");
+  expect_find("$.a[?@ == @]", document,
+      R"([3, 5, 1, 2, 4, 6, {"b": "j"}, {"b": "k"}, {"b": {}},
+          {"b": "kilo"}])");
+}
+
+// Examples from section 2.3.5.2.2 of RFC 9535.
+TEST_F(FindTest, Comparisons) {
+  const std::string document{R"({
+    "obj": {"x": "y"},
+    "arr": [2, 3],
+    "items": [1, 1.0, "1", true, null, [1], {"a": 1}]
+  })"};
+
+  expect_find("$.items[?@ == 1]", document, "[1, 1.0]");
+  expect_find("$.items[?@ == '1']", document, R"(["1"])");
+  expect_find("$.items[?@ == true]", document, "[true]");
+  expect_find("$.items[?@ == null]", document, "[null]");
+  expect_find("$.items[?@ == $.arr]", document, "[]");
+  expect_find("$.items[?@ == $.items[5]]", document, "[[1]]");
+  expect_find(R"($.items[?@ == $.items[6]])", document, R"([{"a": 1}])");
+  expect_find("$.items[?@ < 2]", document, "[1, 1.0]");
+  expect_find("$.items[?@ <= 'a']", document, R"(["1"])");
+  expect_find("$.items[?@.nope == $.nope]", document,
+      R"([1, 1.0, "1", true, null, [1], {"a": 1}])");
+  expect_find("$.items[?@ != 1]", document,
+      R"(["1", true, null, [1], {"a": 1}])");
+  expect_find("$[?$.obj == $.obj]", document,
+      R"([{"x": "y"}, [2, 3], [1, 1.0, "1", true, null, [1], {"a": 1}]])");
+  expect_find("$[?$.obj < $.obj]", document, "[]");
+  expect_find("$[?$.obj <= $.obj]", document,
+      R"([{"x": "y"}, [2, 3], [1, 1.0, "1", true, null, [1], {"a": 1}]])");
+  expect_find(R"($.items[?@ > "0"])", document, R"(["1"])");
+  expect_find("$.items[?!(@ == 1)]", document,
+      R"(["1", true, null, [1], {"a": 1}])");
+}
+
+// Examples from section 2.4 of RFC 9535.
+TEST_F(FindTest, FunctionExtensions) {
+  const std::string document{R"([
+    "ab", "aé", [1, 2], {"a": 1, "b": 2, "c": {"d": 1}}, 3
+  ])"};
+
+  expect_find("$[?length(@) == 2]", document,
+      R"(["ab", "aé", [1, 2]])");
+  expect_find("$[?length(@) > 2]", document,
+      R"([{"a": 1, "b": 2, "c": {"d": 1}}])");
+  expect_find("$[?count(@.*) == 2]", document, "[[1, 2]]");
+  expect_find("$[?count(@..*) > 3]", document,
+      R"([{"a": 1, "b": 2, "c": {"d": 1}}])");
+  expect_find("$[?value(@..d) == 1]", document,
+      R"([{"a": 1, "b": 2, "c": {"d": 1}}])");
+  expect_find("$[?value(@.*) == 1]", document, "[]");
+  expect_find("$[?length(@.c) == 1]", document,
+      R"([{"a": 1, "b": 2, "c": {"d": 1}}])");
+  expect_find("$[?count($[*]) == 5 && @ == 3]", document, "[3]");
+  expect_find("$[?value($[4]) == @]", document, "[3]");
+  expect_find("$[?match(@, 'a.')]", document, R"(["ab", "aé"])");
+  expect_find("$[?match(@, 'a')]", document, "[]");
+  expect_find("$[?search(@, 'b')]", document, R"(["ab"])");
+  expect_find("$[?match(@, '[')]", document, "[]");
+}
+
+TEST_F(FindTest, RegexDotExcludesLineBreaks) {
+  const std::string document{R"(["a\nb", "a\rb", "a b", "axb"])"};
+  expect_find("$[?match(@, 'a.b')]", document, R"(["a b", "axb"])");
+}
+
+// Examples from section 2.5.1.3 of RFC 9535.
+TEST_F(FindTest, ChildSegment) {
+  const std::string document{R"(["a", "b", "c", "d", "e", "f", "g"])"};
+  expect_find("$[0, 3]", document, R"(["a", "d"])");
+  expect_find("$[0:2, 5]", document, R"(["a", "b", "f"])");
+  expect_find("$[0, 0]", document, R"(["a", "a"])");
+}
+
+// Examples from section 2.5.2.3 of RFC 9535.
+TEST_F(FindTest, DescendantSegment) {
+  const std::string document{
+      R"({"o": {"j": 1, "k": 2}, "a": [5, 3, [{"j": 4}, {"k": 6}]]})"};
+
+  expect_find("$..j", document, "[1, 4]", {"$['o']['j']", "$['a'][2][0]['j']"});
+  expect_find("$..[0]", document, R"([5, {"j": 4}])");
+  expect_find("$..[*]", document,
+      R"([{"j": 1, "k": 2}, [5, 3, [{"j": 4}, {"k": 6}]], 1, 2, 5, 3,
+          [{"j": 4}, {"k": 6}], {"j": 4}, {"k": 6}, 4, 6])");
+  expect_find("$..o", document, R"([{"j": 1, "k": 2}])");
+  expect_find("$.o..[*, *]", document, "[1, 2, 1, 2]");
+  expect_find("$.a..[0, 1]", document, R"([5, 3, {"j": 4}, {"k": 6}])");
+}
+
+// Examples from section 2.6.1 of RFC 9535.
+TEST_F(FindTest, WideSegments) {
+  const std::string document{R"({
+    "h": 8, "a": 1, "b": 2, "c": 3, "d": 4, "e": 5, "f": 6, "g": 7,
+    "x": {"a": 9, "b": {"a": 10}}, "a": 11
+  })"};
+
+  // Selector order, with repeated names and names that aren't there.
+  expect_find("$['h', 'g', 'f', 'e', 'd', 'c', 'b', 'a']", document,
+      "[8, 7, 6, 5, 4, 3, 2, 1]",
+      {"$['h']", "$['g']", "$['f']", "$['e']", "$['d']", "$['c']", "$['b']",
+          "$['a']"});
+  expect_find("$['a', 'z', 'a', 'y', 'b', 'w', 'v', 'u', 'a']", document,
+      "[1, 1, 2, 1]");
+  expect_find("$['z', 'y', 'x', 'w', 'v', 'u', 't', 's']", document,
+      R"([{"a": 9, "b": {"a": 10}}])");
+  expect_find("$[1, 'z', 'y', 'x', 'w', 'v', 'u', 't', 's']", document,
+      R"([{"a": 9, "b": {"a": 10}}])");
+
+  // Nested and descendant segments, and subqueries in filters.
+  expect_find("$['x', 'b', 'c', 'd', 'e', 'f', 'g', 'h']['a', 'b', 'c', "
+              "'d', 'e', 'f', 'g', 'h']",
+      document, R"([9, {"a": 10}])");
+  expect_find("$..['a', 'b', 'z', 'y', 'w', 'v', 'u', 't']", document,
+      R"([1, 2, 9, {"a": 10}, 10])");
+  expect_find("$[?@['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'] || @ == 1]",
+      document, R"([1, {"a": 9, "b": {"a": 10}}])");
+  expect_find("$['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h']", "[1, 2]", "[]");
+}
+
+TEST_F(FindTest, Null) {
+  const std::string document{
+      R"({"a": null, "b": [null], "c": [{}], "null": 1})"};
+  expect_find("$.a", document, "[null]");
+  expect_find("$.a[0]", document, "[]");
+  expect_find("$.a.d", document, "[]");
+  expect_find("$.b[0]", document, "[null]");
+  expect_find("$.b[*]", document, "[null]");
+  expect_find("$.b[?@]", document, "[null]");
+  expect_find("$.b[?@==null]", document, "[null]");
+  expect_find("$.c[?@.d==null]", document, "[]");
+  expect_find("$.null", document, "[1]");
+}
+
+TEST_F(FindTest, RootQueriesInFilters) {
+  const std::string document{
+      R"({"limit": 2, "items": [{"n": 1}, {"n": 2}, {"n": 3}]})"};
+  expect_find("$.items[?@.n >= $.limit && $.limit]", document,
+      R"([{"n": 2}, {"n": 3}])");
+  expect_find("$.items[?@.n == count($.items[*])]", document, R"([{"n": 3}])");
+}
+
+TEST_F(FindTest, SharedSubexpressions) {
+  const std::string document{R"([{"a": 1}, {"a": 5}, {"a": 9}, {"b": 1}])"};
+  expect_find("$[?@.a > 2 && @.a < 8 || @.a == 1]", document,
+      R"([{"a": 1}, {"a": 5}])");
+  expect_find("$[?count(@.*) == 1 && count(@.*) > 0 && @.a]", document,
+      R"([{"a": 1}, {"a": 5}, {"a": 9}])");
+}
+
+TEST_F(FindTest, TypedComparisons) {
+  const std::string document{
+      R"([{"n": 1}, {"n": 2.5}, {"n": "1"}, {"m": 1}, {"n": 3}, {"n": "b"}])"};
+  expect_find("$[?@.n < 2.5].n", document, "[1]");
+  expect_find("$[?@.n <= 2.5].n", document, "[1, 2.5]");
+  expect_find("$[?2 < @.n].n", document, "[2.5, 3]");
+  expect_find("$[?@.n != 1].n", document, R"([2.5, "1", 3, "b"])");
+  expect_find("$[?@.n >= 'a'].n", document, R"(["b"])");
+  expect_find("$[?@.n == '1'].n", document, R"(["1"])");
+}
+
+TEST_F(FindTest, NestedFilters) {
+  const std::string document{R"([
+    {"a": [{"b": 1}, {"b": 2}], "c": 1},
+    {"a": [{"b": 1}], "c": 1},
+    {"a": [{"b": 3}], "c": 2}
+  ])"};
+  expect_find("$[?@.a[?@.b > 1] && @.c == 1].c", document, "[1]",
+      {"$[0]['c']"});
+  expect_find("$[?@.c == 1 && @.a[?@.b == @.b]].c", document, "[1, 1]");
+}
+
+TEST_F(FindTest, ReuseEvaluator) {
+  const auto path{libjsonpath::parse("$[?@.a == $.x].a")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+
+  const auto first{parse_json(R"({"x": 1, "y": {"a": 1}, "z": {"a": 2}})")};
+  const auto second{parse_json(R"({"x": 2, "y": {"a": 1}, "z": {"a": 2}})")};
+
+  auto nodes{evaluator.find(&first)};
+  ASSERT_EQ(nodes.size(), 1);
+  EXPECT_EQ(nodes[0].path(), "$['y']['a']");
+
+  nodes = evaluator.find(&second);
+  ASSERT_EQ(nodes.size(), 1);
+  EXPECT_EQ(nodes[0].path(), "$['z']['a']");
+}
+
+TEST_F(FindTest, FirstStopsEarly) {
+  Value::array_t records{};
+  for (int i = 0; i < 1000; i++) {
+    records.push_back(Value::object_t{{"a", i}});
+  }
+  const Value root{records};
+
+  const auto path{libjsonpath::parse("$[?@.a >= 0].a")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  CountingAdapter::visits = 0;
+  const auto node{evaluator.first(&root)};
+  ASSERT_TRUE(node.has_value());
+  EXPECT_EQ(node->path(), "$[0]['a']");
+  EXPECT_LT(CountingAdapter::visits, 5);
+
+  CountingAdapter::visits = 0;
+  EXPECT_EQ(evaluator.find(&root).size(), 1000);
+  EXPECT_GT(CountingAdapter::visits, 2000);
+}
+
+TEST_F(FindTest, CountAndExists) {
+  const auto root{parse_json(R"({"a": [[1, 2], [3, 4]], "b": [5, [6]]})")};
+  const auto all{libjsonpath::parse("$..*")};
+  const auto none{libjsonpath::parse("$.x[*]")};
+
+  libjsonpath::Evaluator<CountingAdapter> evaluator{all};
+  EXPECT_EQ(evaluator.count(&root), 11);
+  EXPECT_EQ(evaluator.count(&root), evaluator.find(&root).size());
+
+  CountingAdapter::visits = 0;
+  EXPECT_TRUE(evaluator.exists(&root));
+  EXPECT_EQ(CountingAdapter::visits, 1);
+
+  EXPECT_EQ(libjsonpath::count<ValueAdapter>(none, &root), 0);
+  EXPECT_FALSE(libjsonpath::exists<ValueAdapter>(none, &root));
+  EXPECT_EQ(libjsonpath::count<ValueAdapter>(all, &root), 11);
+  EXPECT_TRUE(libjsonpath::exists<ValueAdapter>(all, &root));
+}
+
+TEST_F(FindTest, FunctionArgumentsStopEarly) {
+  Value::array_t records{};
+  for (int i = 0; i < 1000; i++) {
+    records.push_back(Value::object_t{{"a", i}});
+  }
+  const Value root{Value::object_t{{"x", records}}};
+
+  // `value()` gives up at the second node.
+  const auto path{libjsonpath::parse("$[?value(@..a) == 0]")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+  CountingAdapter::visits = 0;
+  EXPECT_TRUE(evaluator.find(&root).empty());
+  EXPECT_LT(CountingAdapter::visits, 10);
+
+  const auto counted{libjsonpath::parse("$[?count(@..a) == 1000]")};
+  libjsonpath::Evaluator<CountingAdapter> counter{counted};
+  EXPECT_EQ(counter.find(&root).size(), 1);
+}
+
+TEST_F(FindTest, LazyFindStopsWithTheLoop) {
+  const auto root{parse_json(R"({"a": [[1, 2], [3, 4]], "b": [5, [6]]})")};
+  const auto path{libjsonpath::parse("$..*")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  CountingAdapter::visits = 0;
+  std::vector<std::string> paths{};
+  for (const auto& node : evaluator.lazy_find(&root)) {
+    paths.push_back(node.path());
+    if (paths.size() == 3) {
+      break;
+    }
+  }
+
+  EXPECT_EQ(paths, (std::vector<std::string>{"$['a']", "$['b']", "$['a'][0]"}));
+  EXPECT_EQ(CountingAdapter::visits, 4);
+
+  const auto none{libjsonpath::parse("$.x[*]")};
+  libjsonpath::Evaluator<ValueAdapter> empty{none};
+  auto range{empty.lazy_find(&root)};
+  EXPECT_EQ(range.begin(), range.end());
+  EXPECT_FALSE(empty.first(&root).has_value());
+}
+
+TEST_F(FindTest, DescendantChains) {
+  const std::string document{
+      R"({"a": {"b": 1, "a": {"x": {"b": 2}, "a": {"c": 3}}}, "b": 4})"};
+
+  // Nested matches for the first segment repeat the results below them.
+  expect_find("$..a..b", document, "[1, 2, 2]",
+      {"$['a']['b']", "$['a']['a']['x']['b']", "$['a']['a']['x']['b']"});
+  expect_find("$..a..c", document, "[3, 3, 3]");
+  expect_find("$..a..a..b", document, "[2]");
+  expect_find("$..a..x..b", document, "[2, 2]");
+  expect_find("$..x..a", document, "[]");
+  expect_find("$..[?@.b]..b", document, "[1, 2, 2]");
+  expect_find("$..*..*", "[[[1]], 2]", "[[1], 1, 1]",
+      {"$[0][0]", "$[0][0][0]", "$[0][0][0]"});
+}
+
+TEST_F(FindTest, DescendantChainsSkipEmptySubtrees) {
+  // {"a": {"a": ... {"a": {}}}}, without a "b" anywhere.
+  Value root{Value::object_t{}};
+  for (int i = 0; i < 200; i++) {
+    root = Value::object_t{{"a", root}};
+  }
+
+  const auto path{libjsonpath::parse("$..a..b")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  CountingAdapter::visits = 0;
+  EXPECT_TRUE(evaluator.find(&root).empty());
+  EXPECT_LT(CountingAdapter::visits, 2000);
+
+  CountingAdapter::visits = 0;
+  auto range{evaluator.lazy_find(&root)};
+  EXPECT_EQ(range.begin(), range.end());
+  EXPECT_LT(CountingAdapter::visits, 2000);
+}
+
+TEST_F(FindTest, WithoutLocations) {
+  const auto root{parse_json(R"({"a": [1, 2, 3]})")};
+  const auto path{libjsonpath::parse("$.a[?@ > 1]")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path, {true, false}};
+
+  const auto nodes{evaluator.find(&root)};
+  ASSERT_EQ(nodes.size(), 2);
+  EXPECT_EQ(*nodes[1].value, Value{3});
+  EXPECT_FALSE(nodes[1].location.tracked());
+  EXPECT_EQ(nodes[1].path(), "");
+
+  const auto node{evaluator.first(&root)};
+  ASSERT_TRUE(node.has_value());
+  EXPECT_EQ(*node->value, Value{2});
+  EXPECT_FALSE(node->location.tracked());
+}
+
+TEST_F(FindTest, LocationsOutliveTheQuery) {
+  const auto root{parse_json(R"({"some key": {"other key": 1}})")};
+  const auto nodes{libjsonpath::find<ValueAdapter>(
+      std::string_view{"$['some key']['other key']"}, &root)};
+  ASSERT_EQ(nodes.size(), 1);
+  EXPECT_EQ(nodes[0].path(), "$['some key']['other key']");
+  EXPECT_EQ(nodes[0].location.to_json_pointer(), "/some key/other key");
+}
+
+TEST_F(FindTest, UnknownFunction) {
+  const std::string query{"$[?foo(@)]"};
+  const auto path{libjsonpath::parse(query,
+      {{"foo", {{libjsonpath::ExpressionType::value},
+                   libjsonpath::ExpressionType::logical}}})};
+  const auto root{parse_json("[1]")};
+  EXPECT_THROW(
+      libjsonpath::find<ValueAdapter>(path, &root), libjsonpath::NameError);
+}
+
+TEST_F(FindTest, CustomFunctions) {
+  using Evaluator = libjsonpath::Evaluator<ValueAdapter>;
+
+  libjsonpath::function_signature_map functions{
+      libjsonpath::DEFAULT_FUNCTION_EXTENSIONS};
+  functions["starts_with"] = {{libjsonpath::ExpressionType::value,
+                                  libjsonpath::ExpressionType::value},
+      libjsonpath::ExpressionType::logical};
+  functions["first"] = {{libjsonpath::ExpressionType::nodes},
+      libjsonpath::ExpressionType::value};
+
+  const auto path{libjsonpath::parse(
+      "$[?starts_with(@.name, 'a') && first(@.tags.*) == 'x']", functions)};
+  const auto root{parse_json(R"([
+    {"name": "ab", "tags": ["x", "y"]},
+    {"name": "ba", "tags": ["x"]},
+    {"name": "ac", "tags": ["y", "x"]},
+    {"name": 1, "tags": ["x"]}
+  ])")};
+
+  Evaluator evaluator{path};
+  evaluator.add_function(
+      "starts_with", [](const std::vector<Evaluator::value_t>& args) {
+        const auto value{Evaluator::resolve(args[0])};
+        const auto prefix{Evaluator::resolve(args[1])};
+        auto s{std::get_if<std::string_view>(&value)};
+        auto p{std::get_if<std::string_view>(&prefix)};
+        return Evaluator::value_t{s && p && s->substr(0, p->size()) == *p};
+      });
+  evaluator.add_function(
+      "first", [](const std::vector<Evaluator::value_t>& args) {
+        const auto& nodes{std::get<Evaluator::NodesValue>(args[0]).nodes};
+        if (nodes.empty()) {
+          return Evaluator::value_t{Evaluator::Nothing{}};
+        }
+        return Evaluator::value_t{Evaluator::NodeValue{nodes.front()}};
+      });
+
+  EXPECT_EQ(
+      node_paths(evaluator.find(&root)), std::vector<std::string>{"$[0]"});
+}
@@ -0,0 +1,83 @@
+#include "libjsonpath/footprint.hpp" // libjsonpath::key_footprint
+#include "libjsonpath/jsonpath.hpp"  // libjsonpath::parse
+#include <gtest/gtest.h>             // EXPEXT_* TEST_F testing::Test
+#include <set>                       // std::set
+#include <string>                    // std::string
+#include <string_view>               // std::string_view
+
+class FootprintTest : public testing::Test {
+protected:
+  void expect_footprint(std::string_view query, std::string_view want) {
+    auto footprint{libjsonpath::key_footprint(libjsonpath::parse(query))};
+    EXPECT_EQ(footprint.to_string(), want) << query;
+  }
+};
+
+TEST_F(FootprintTest, JustRoot) { expect_footprint("$", "!"); }
+
+TEST_F(FootprintTest, Names) {
+  expect_footprint("$.a.b", "{'a': {'b': !}}");
+  expect_footprint("$['a', 'b'].c", "{'a': {'c': !}, 'b': {'c': !}}");
+}
+
+TEST_F(FootprintTest, AnyKey) {
+  expect_footprint("$.items[*].price", "{'items': {*: {'price': !}}}");
+  expect_footprint("$.items[0].price", "{'items': {*: {'price': !}}}");
+  expect_footprint("$.a[1:3]", "{'a': {*: !}}");
+}
+
+TEST_F(FootprintTest, AnyDepth) {
+  expect_footprint("$..price", "{..: {'price': !}}");
+  expect_footprint("$.a..b.c", "{'a': {..: {'b': {'c': !}}}}");
+}
+
+TEST_F(FootprintTest, Filters) {
+  expect_footprint("$.items[?@.price > 1].name",
+      "{'items': {*: {'name': !, 'price': !}}}");
+  expect_footprint("$.items[?@.price > $.config.min]",
+      "{'config': {'min': !}, 'items': {*: !{'price': !}}}");
+}
+
+TEST_F(FootprintTest, NestedFilterQueries) {
+  expect_footprint(
+      "$.a[?@.b[?@.c == 1]]", "{'a': {*: !{'b': {*: !{'c': !}}}}}");
+}
+
+TEST_F(FootprintTest, FunctionArguments) {
+  expect_footprint("$[?length(@.tags) > 1 && match(@.name, 'a.*')]",
+      "{*: !{'name': !, 'tags': !}}");
+  expect_footprint("$[?count(@..x) > 1]", "{*: !{..: {'x': !}}}");
+}
+
+TEST_F(FootprintTest, Markers) {
+  auto footprint{libjsonpath::key_footprint(libjsonpath::parse("$.a.b"))};
+  EXPECT_FALSE(footprint.has_any_key());
+  EXPECT_FALSE(footprint.has_any_depth());
+  EXPECT_EQ(footprint.names(), (std::set<std::string>{"a", "b"}));
+
+  footprint = libjsonpath::key_footprint(libjsonpath::parse("$..a[*]"));
+  EXPECT_TRUE(footprint.has_any_key());
+  EXPECT_TRUE(footprint.has_any_depth());
+  EXPECT_EQ(footprint.names(), (std::set<std::string>{"a"}));
+}
+
+TEST_F(FootprintTest, TreeStructure) {
+  auto footprint{libjsonpath::key_footprint(libjsonpath::parse("$.a[*]"))};
+  const auto& root{footprint.root()};
+  ASSERT_EQ(root.names.count("a"), 1);
+  const auto& a{footprint.node(root.names.at("a"))};
+  EXPECT_FALSE(a.whole);
+  ASSERT_TRUE(a.any_key);
+  EXPECT_TRUE(footprint.node(a.any_key.value()).whole);
+}
+
+TEST_F(FootprintTest, ManyQueries) {
+  libjsonpath::KeyFootprint footprint{};
+  libjsonpath::add_footprint(footprint, libjsonpath::parse("$.a.b"));
+  libjsonpath::add_footprint(footprint, libjsonpath::parse("$.a.c"));
+  EXPECT_EQ(footprint.to_string(), "{'a': {'b': !, 'c': !}}");
+}
+
+TEST_F(FootprintTest, EscapedNames) {
+  expect_footprint("$[\"it's\"]", "{'it\\'s': !}");
+}
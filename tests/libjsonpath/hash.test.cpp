@@ -0,0 +1,90 @@
+#include "libjsonpath/hash.hpp"     // libjsonpath::hash
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string_view>              // std::string_view
+#include <variant>                  // std::get
+
+class HashTest : public testing::Test {
+protected:
+  void expect_same_hash(std::string_view a, std::string_view b) {
+    EXPECT_EQ(libjsonpath::hash(libjsonpath::parse(a)),
+        libjsonpath::hash(libjsonpath::parse(b)))
+        << a << " and " << b;
+  }
+
+  void expect_different_hash(std::string_view a, std::string_view b) {
+    EXPECT_NE(libjsonpath::hash(libjsonpath::parse(a)),
+        libjsonpath::hash(libjsonpath::parse(b)))
+        << a << " and " << b;
+  }
+};
+
+TEST_F(HashTest, ShorthandAndBracketedNames) {
+  expect_same_hash("$.a", "$['a']");
+  expect_same_hash("$.a", "$[\"a\"]");
+}
+
+TEST_F(HashTest, ShorthandAndBracketedWild) { expect_same_hash("$.*", "$[*]"); }
+
+TEST_F(HashTest, DescendantShorthand) { expect_same_hash("$..a", "$..['a']"); }
+
+TEST_F(HashTest, WhitespaceAndParens) {
+  expect_same_hash("$[?@.a>1]", "$[?( @.a > 1 )]");
+}
+
+TEST_F(HashTest, FilterQueries) {
+  expect_same_hash("$[?@.a && $.b]", "$[?@['a'] && $['b']]");
+  expect_different_hash("$[?@.a]", "$[?$.a]");
+}
+
+TEST_F(HashTest, DifferentNames) { expect_different_hash("$.a", "$.b"); }
+
+TEST_F(HashTest, DifferentSegmentKinds) {
+  expect_different_hash("$.a", "$..a");
+  expect_different_hash("$['a','b']", "$['a']['b']");
+}
+
+TEST_F(HashTest, DifferentOperators) {
+  expect_different_hash("$[?@.a < 1]", "$[?@.a <= 1]");
+  expect_different_hash("$[?@.a && @.b]", "$[?@.a || @.b]");
+}
+
+TEST_F(HashTest, DifferentLiterals) {
+  expect_different_hash("$[?@.a == 1]", "$[?@.a == 1.0]");
+  expect_different_hash("$[?@.a == '1']", "$[?@.a == 1]");
+  expect_different_hash("$[?@.a == true]", "$[?@.a == false]");
+}
+
+TEST_F(HashTest, NegativeZeroFloat) {
+  expect_same_hash("$[?@.a == 0.0]", "$[?@.a == -0.0]");
+}
+
+TEST_F(HashTest, SliceDefaults) {
+  expect_different_hash("$[1:]", "$[1:2]");
+  expect_different_hash("$[:1]", "$[1:]");
+}
+
+TEST_F(HashTest, SelectorAndExpression) {
+  auto a{libjsonpath::parse("$[?@.a == 1]")};
+  auto b{libjsonpath::parse("$[?(@['a']==1)]")};
+  const auto& sa{std::get<libjsonpath::Segment>(a.front()).selectors.front()};
+  const auto& sb{std::get<libjsonpath::Segment>(b.front()).selectors.front()};
+  EXPECT_EQ(libjsonpath::hash(sa), libjsonpath::hash(sb));
+
+  const auto& ea{
+      std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(sa)->expression};
+  const auto& eb{
+      std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(sb)->expression};
+  EXPECT_EQ(libjsonpath::hash(ea), libjsonpath::hash(eb));
+}
+
+TEST_F(HashTest, StableValue) {
+  // Hashes are persisted by callers, so they must not change without a
+  // HASH_VERSION bump.
+  EXPECT_EQ(libjsonpath::HASH_VERSION, 2);
+  EXPECT_EQ(libjsonpath::hash(libjsonpath::parse("$")), 0xa8c7f832281a39c5ULL);
+  EXPECT_EQ(libjsonpath::hash(libjsonpath::parse("$.a[?@.b > 1]")),
+      0xa537817ee653f1a9ULL);
+  EXPECT_EQ(
+      libjsonpath::hash(libjsonpath::parse("$[1:5]")), 0xf4f990c958ac780dULL);
+}
@@ -0,0 +1,42 @@
+#ifndef LIBJSONPATH_TESTS_HELPERS_H
+#define LIBJSONPATH_TESTS_HELPERS_H
+
+#include "libjsonpath/value.hpp" // libjsonpath::ValueAdapter
+#include <cstddef>               // std::size_t
+#include <optional>              // std::optional
+#include <string>                // std::string
+#include <string_view>           // std::string_view
+#include <vector>                // std::vector
+
+// A ValueAdapter that counts the child nodes it hands out.
+struct CountingAdapter : libjsonpath::ValueAdapter {
+  static inline std::size_t visits{0};
+
+  static node_type element(node_type node, std::size_t index) {
+    visits++;
+    return ValueAdapter::element(node, index);
+  }
+
+  static std::optional<node_type> member(
+      node_type node, std::string_view name) {
+    visits++;
+    return ValueAdapter::member(node, name);
+  }
+
+  static node_type member_value(const member_iterator& it) {
+    visits++;
+    return ValueAdapter::member_value(it);
+  }
+};
+
+// Return the normalized path of each node in _nodes_, a nodelist or a lazy
+// range, in order.
+template <typename Nodes> std::vector<std::string> node_paths(Nodes&& nodes) {
+  std::vector<std::string> rv{};
+  for (const auto& node : nodes) {
+    rv.push_back(node.path());
+  }
+  return rv;
+}
+
+#endif // LIBJSONPATH_TESTS_HELPERS_H
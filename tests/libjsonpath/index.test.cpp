@@ -0,0 +1,125 @@
+#include "libjsonpath/index.hpp"    // libjsonpath::KeyIndex
+#include "libjsonpath/find.hpp"     // libjsonpath::Evaluator
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include "libjsonpath/value.hpp"    // libjsonpath::ValueAdapter
+#include "helpers.hpp"              // CountingAdapter node_paths
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <cstddef>                  // std::size_t
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <vector>                   // std::vector
+
+using libjsonpath::parse_json;
+using libjsonpath::Value;
+using libjsonpath::ValueAdapter;
+
+using KeyIndex = libjsonpath::KeyIndex<ValueAdapter>;
+
+class KeyIndexTest : public testing::Test {
+protected:
+  // Check that _query_ selects the same nodes, with the same locations, from
+  // _index_ as it does by walking the document.
+  void expect_same(std::string_view query, const KeyIndex& index) {
+    const auto path{libjsonpath::parse(query)};
+    libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+
+    EXPECT_EQ(node_paths(evaluator.find(index)),
+        node_paths(evaluator.find(index.root())))
+        << query;
+  }
+};
+
+TEST_F(KeyIndexTest, Postings) {
+  const auto root{parse_json(
+      R"({"a": 1, "b": [{"a": 2}, 3, [{"a": 4, "a": 5}]], "c": {"d": {}}})")};
+  const KeyIndex index{&root};
+
+  // The array at "b", its first element, the array inside it and the object
+  // inside that, then "c" and "d".
+  EXPECT_EQ(index.containers(), 6);
+  EXPECT_GT(index.memory_usage(), 0);
+
+  const auto& postings{index.postings("a")};
+  ASSERT_EQ(postings.size(), 3);
+  EXPECT_EQ(postings[0].parent, libjsonpath::LocationTree::ROOT);
+  EXPECT_EQ(*postings[0].node, Value{1});
+  EXPECT_EQ(index.location(postings[1].parent).path(), "$['b'][0]");
+  EXPECT_EQ(*postings[2].node, Value{4});
+  EXPECT_EQ(index.location(postings[2].parent).path(), "$['b'][2][0]");
+
+  EXPECT_TRUE(index.postings("nope").empty());
+}
+
+TEST_F(KeyIndexTest, SameResults) {
+  const auto root{parse_json(R"({
+    "store": {
+      "book": [
+        {"title": "a", "price": 8.95, "author": {"name": "x"}},
+        {"title": "b", "price": 12.99, "isbn": "1"},
+        {"title": "c", "price": 8.99, "isbn": "2", "title": "dup"}
+      ],
+      "bicycle": {"color": "red", "price": 19.95}
+    },
+    "price": {"price": 1, "x": {"price": 2}}
+  })")};
+  const KeyIndex index{&root};
+
+  expect_same("$..price", index);
+  expect_same("$..title", index);
+  expect_same("$..['price', 'isbn']", index);
+  expect_same("$..['isbn', 'price', 'isbn']", index);
+  expect_same("$..price..price", index);
+  expect_same("$..book[?@.price < 10].title", index);
+  expect_same("$..author.name", index);
+  expect_same("$..nope", index);
+
+  // Queries that can't use the index.
+  expect_same("$.store..price", index);
+  expect_same("$..[?@.price]", index);
+  expect_same("$..*", index);
+}
+
+TEST_F(KeyIndexTest, ParentsBeforeChildren) {
+  // Names are selected from each object before its children are visited,
+  // so the root's "a" comes first, even though it's after "x".
+  const auto root{parse_json(R"({"x": {"a": 1}, "a": 2})")};
+  const KeyIndex index{&root};
+
+  const auto path{libjsonpath::parse("$..a")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path};
+  const auto nodes{evaluator.find(index)};
+  ASSERT_EQ(nodes.size(), 2);
+  EXPECT_EQ(nodes[0].path(), "$['a']");
+  EXPECT_EQ(nodes[1].path(), "$['x']['a']");
+}
+
+TEST_F(KeyIndexTest, WithoutLocations) {
+  const auto root{parse_json(R"({"a": [{"b": 1}, {"b": 2}]})")};
+  const KeyIndex index{&root};
+
+  const auto path{libjsonpath::parse("$..b")};
+  libjsonpath::Evaluator<ValueAdapter> evaluator{path, {true, false}};
+  const auto nodes{evaluator.find(index)};
+  ASSERT_EQ(nodes.size(), 2);
+  EXPECT_EQ(*nodes[1].value, Value{2});
+  EXPECT_FALSE(nodes[1].location.tracked());
+}
+
+TEST_F(KeyIndexTest, NoWalk) {
+  Value::array_t records{};
+  for (int i = 0; i < 1000; i++) {
+    records.push_back(Value::object_t{{"id", i}, {"tags", Value::array_t{}}});
+  }
+  records.push_back(Value::object_t{{"needle", 1}});
+  const Value root{Value::object_t{{"records", records}}};
+  const libjsonpath::KeyIndex<CountingAdapter> index{&root};
+
+  const auto path{libjsonpath::parse("$..needle")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  CountingAdapter::visits = 0;
+  const auto nodes{evaluator.find(index)};
+  ASSERT_EQ(nodes.size(), 1);
+  EXPECT_EQ(nodes[0].path(), "$['records'][1000]['needle']");
+  EXPECT_EQ(CountingAdapter::visits, 0);
+}
@@ -502,4 +502,18 @@ TEST_F(LexerTest, IntegerLiteralWithNegativeExponent) {
                                  });
 }
 
+TEST_F(LexerTest, FloatLiteralWithMultiDigitExponent) {
+  expect_tokens("$[?@.a==1.5e+300]", {
+                                         {tt::root, "$", 0, "$[?@.a==1.5e+300]"},
+                                         {tt::lbracket, "[", 1, "$[?@.a==1.5e+300]"},
+                                         {tt::filter_, "?", 2, "$[?@.a==1.5e+300]"},
+                                         {tt::current, "@", 3, "$[?@.a==1.5e+300]"},
+                                         {tt::name_, "a", 5, "$[?@.a==1.5e+300]"},
+                                         {tt::eq, "==", 6, "$[?@.a==1.5e+300]"},
+                                         {tt::float_, "1.5e+300", 8, "$[?@.a==1.5e+300]"},
+                                         {tt::rbracket, "]", 16, "$[?@.a==1.5e+300]"},
+                                         {tt::eof_, "", 17, "$[?@.a==1.5e+300]"},
+                                     });
+}
+
 // TODO: test escape sequences inside string literals
\ No newline at end of file
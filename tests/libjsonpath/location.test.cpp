@@ -0,0 +1,99 @@
+#include "libjsonpath/location.hpp" // libjsonpath::LocationBuilder
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <cstdint>                  // std::int64_t
+#include <memory>                   // std::make_shared
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <vector>                   // std::vector
+
+using libjsonpath::Location;
+using libjsonpath::LocationBuilder;
+using libjsonpath::path_step_t;
+
+class LocationTest : public testing::Test {};
+
+TEST_F(LocationTest, Root) {
+  LocationBuilder builder{};
+  const auto location{builder.current()};
+  EXPECT_TRUE(location.tracked());
+  EXPECT_EQ(location.depth(), 0);
+  EXPECT_EQ(location.path(), "$");
+  EXPECT_EQ(location.to_json_pointer(), "");
+}
+
+TEST_F(LocationTest, RenderOnDemand) {
+  LocationBuilder builder{};
+  builder.push(std::string_view{"a"});
+  builder.push(std::int64_t{1});
+  builder.push(std::string_view{"b/c~d"});
+  const auto location{builder.current()};
+
+  EXPECT_EQ(location.depth(), 3);
+  EXPECT_EQ(location.path(), "$['a'][1]['b/c~d']");
+  EXPECT_EQ(location.to_json_pointer(), "/a/1/b~1c~0d");
+  EXPECT_EQ(location.to_path_steps(),
+      (std::vector<path_step_t>{"a", std::int64_t{1}, "b/c~d"}));
+}
+
+TEST_F(LocationTest, NamesAreEscapedLikeNameSelectors) {
+  LocationBuilder builder{};
+  builder.push(std::string_view{"it's"});
+  builder.push(std::string_view{"back\\slash"});
+  builder.push(std::string_view{"\n\x01"});
+  EXPECT_EQ(builder.current().path(),
+      "$['it\\'s']['back\\\\slash']['\\n\\u0001']");
+}
+
+TEST_F(LocationTest, SiblingsShareTheirParents) {
+  LocationBuilder builder{};
+  builder.push(std::string_view{"a"});
+  builder.push(std::string_view{"b"});
+  builder.push(std::int64_t{0});
+  const auto first{builder.current()};
+  builder.pop();
+  builder.push(std::int64_t{1});
+  const auto second{builder.current()};
+  builder.pop();
+  builder.pop();
+  builder.push(std::string_view{"c"});
+  const auto third{builder.current()};
+
+  EXPECT_EQ(first.path(), "$['a']['b'][0]");
+  EXPECT_EQ(second.path(), "$['a']['b'][1]");
+  EXPECT_EQ(third.path(), "$['a']['c']");
+
+  // Copies refer to the same tree.
+  const auto copy{second};
+  EXPECT_EQ(copy.path(), "$['a']['b'][1]");
+}
+
+TEST_F(LocationTest, UnreferencedTreesAreReused) {
+  LocationBuilder builder{};
+  builder.push(std::string_view{"a"});
+  builder.push(std::int64_t{0});
+  {
+    const auto dropped{builder.current()};
+  }
+  builder.pop();
+  builder.push(std::int64_t{1});
+  EXPECT_EQ(builder.current().path(), "$['a'][1]");
+}
+
+TEST_F(LocationTest, RetainedOwners) {
+  auto name{std::make_shared<const std::string>("some name")};
+  LocationBuilder builder{};
+  builder.retain(name);
+  builder.push(std::string_view{*name});
+  const auto location{builder.current()};
+
+  name.reset();
+  builder.reset();
+  EXPECT_EQ(location.path(), "$['some name']");
+}
+
+TEST_F(LocationTest, Untracked) {
+  const Location location{};
+  EXPECT_FALSE(location.tracked());
+  EXPECT_EQ(location.path(), "");
+  EXPECT_TRUE(location.steps().empty());
+}
@@ -0,0 +1,54 @@
+#include "libjsonpath/nlohmann.hpp" // libjsonpath::NlohmannAdapter
+#include "libjsonpath/find.hpp"     // libjsonpath::find
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <nlohmann/json.hpp>        // nlohmann::json
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <vector>                   // std::vector
+
+using libjsonpath::NlohmannAdapter;
+using nlohmann::json;
+
+class NlohmannTest : public testing::Test {
+protected:
+  void expect_find(std::string_view query, const json& document,
+      const json& want, const std::vector<std::string>& paths = {}) {
+    const auto nodes{libjsonpath::find<NlohmannAdapter>(query, &document)};
+
+    json got = json::array();
+    std::vector<std::string> got_paths{};
+    for (const auto& node : nodes) {
+      got.push_back(*node.value);
+      got_paths.push_back(node.path());
+    }
+
+    EXPECT_EQ(got, want) << query << " got " << got.dump();
+    if (!paths.empty()) {
+      EXPECT_EQ(got_paths, paths) << query;
+    }
+  }
+};
+
+TEST_F(NlohmannTest, Selectors) {
+  const auto document = json::parse(
+      R"({"a": [1, 2, 3, {"b": "x"}], "c": {"d": true, "e": null}})");
+  expect_find("$.a[1]", document, json::parse("[2]"), {"$['a'][1]"});
+  expect_find("$.a[-1].b", document, json::parse(R"(["x"])"));
+  expect_find("$.a[:2]", document, json::parse("[1, 2]"));
+  expect_find("$.c.*", document, json::parse("[true, null]"));
+  expect_find("$..b", document, json::parse(R"(["x"])"),
+      {"$['a'][3]['b']"});
+}
+
+TEST_F(NlohmannTest, Filters) {
+  const auto document = json::parse(R"([
+    {"n": 1, "s": "abc"}, {"n": 2.5, "s": "xyz"}, {"n": 18446744073709551615}
+  ])");
+  expect_find("$[?@.n > 2].s", document, json::parse(R"(["xyz"])"));
+  expect_find("$[?@.n == 1]", document,
+      json::parse(R"([{"n": 1, "s": "abc"}])"));
+  expect_find("$[?match(@.s, 'a.c')].n", document, json::parse("[1]"));
+  expect_find("$[?length(@.s) == 3].n", document, json::parse("[1, 2.5]"));
+  expect_find("$[?@.n > 1e18].n", document,
+      json::parse("[18446744073709551615]"));
+}
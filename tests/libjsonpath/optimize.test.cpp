@@ -0,0 +1,379 @@
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse libjsonpath::to_string
+#include "libjsonpath/optimize.hpp" // libjsonpath::optimize
+#include <cstdint>                  // std::uint64_t
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <utility>                  // std::pair
+#include <variant>                  // std::get std::visit
+#include <vector>                   // std::vector
+
+class SimplifyTest : public testing::Test {
+protected:
+  void expect_simplified(std::string_view query, std::string_view want,
+      std::size_t removed) {
+    auto path{libjsonpath::parse(query)};
+    EXPECT_EQ(libjsonpath::simplify(path), removed) << query;
+    EXPECT_EQ(libjsonpath::to_string(path), want) << query;
+  }
+};
+
+TEST_F(SimplifyTest, NothingToSimplify) {
+  expect_simplified("$[?@.a]", "$[?@['a']]", 0);
+  expect_simplified("$[?@.a == 1 && @.b]", "$[?(@['a'] == 1 && @['b'])]", 0);
+  expect_simplified("$.a[0]", "$['a'][0]", 0);
+}
+
+TEST_F(SimplifyTest, LiteralComparisons) {
+  expect_simplified("$[?1 == 1]", "$[?true]", 2);
+  expect_simplified("$[?1 == 1.0]", "$[?true]", 2);
+  expect_simplified("$[?1 != 2]", "$[?true]", 2);
+  expect_simplified("$[?2 < 1.5]", "$[?false]", 2);
+  expect_simplified("$[?'a' <= 'b']", "$[?true]", 2);
+  expect_simplified("$[?'b' >= 'a']", "$[?true]", 2);
+  expect_simplified("$[?null == null]", "$[?true]", 2);
+  expect_simplified("$[?null == false]", "$[?false]", 2);
+  expect_simplified("$[?true == true]", "$[?true]", 2);
+  expect_simplified("$[?1 == '1']", "$[?false]", 2);
+}
+
+TEST_F(SimplifyTest, UnorderedLiteralsAreNeitherLessNorGreater) {
+  expect_simplified("$[?true < false]", "$[?false]", 2);
+  expect_simplified("$[?true <= true]", "$[?true]", 2);
+  expect_simplified("$[?null > null]", "$[?false]", 2);
+  expect_simplified("$[?1 < 'a']", "$[?false]", 2);
+}
+
+TEST_F(SimplifyTest, IdenticalOperands) {
+  expect_simplified("$[?@.a == @.a]", "$[?true]", 2);
+  expect_simplified("$[?@.a != @['a']]", "$[?false]", 2);
+  expect_simplified("$[?@.a <= @.a]", "$[?true]", 2);
+  expect_simplified("$[?length(@.a) < length(@.a)]", "$[?false]", 4);
+  expect_simplified("$[?@.a == @.b]", "$[?@['a'] == @['b']]", 0);
+}
+
+TEST_F(SimplifyTest, LogicalIdentities) {
+  expect_simplified("$[?true && @.a]", "$[?@['a']]", 2);
+  expect_simplified("$[?@.a && true]", "$[?@['a']]", 2);
+  expect_simplified("$[?false || @.a]", "$[?@['a']]", 2);
+  expect_simplified("$[?@.a || false]", "$[?@['a']]", 2);
+  expect_simplified("$[?@.a && @.a]", "$[?@['a']]", 2);
+  expect_simplified("$[?@.a > 1 || @.a > 1]", "$[?@['a'] > 1]", 4);
+}
+
+TEST_F(SimplifyTest, DeadBranches) {
+  expect_simplified("$[?false && @..a]", "$[?false]", 2);
+  expect_simplified("$[?@..a && false]", "$[?false]", 2);
+  expect_simplified("$[?true || search(@.a, 'b')]", "$[?true]", 4);
+  expect_simplified("$[?@.a || 1 == 1]", "$[?true]", 4);
+  expect_simplified("$[?@.a && (@.b || 1 < 2)]", "$[?@['a']]", 6);
+}
+
+TEST_F(SimplifyTest, Contradictions) {
+  expect_simplified("$[?@.a > 5 && @.a < 3]", "$[?false]", 6);
+  expect_simplified("$[?@.a > 5 && @.b && @.a < 3]", "$[?false]", 8);
+  expect_simplified("$[?@.a < true]", "$[?false]", 2);
+  expect_simplified("$[?@.a > 5 && @.a < 3 || @.b]", "$[?@['b']]", 8);
+  expect_simplified(
+      "$[?@.a > 5 && @.a < 6]", "$[?(@['a'] > 5 && @['a'] < 6)]", 0);
+}
+
+TEST_F(SimplifyTest, ContradictionsInFunctionArguments) {
+  libjsonpath::function_signature_map functions{
+      libjsonpath::DEFAULT_FUNCTION_EXTENSIONS};
+  functions["none"] = {{libjsonpath::ExpressionType::logical},
+      libjsonpath::ExpressionType::logical};
+
+  // `none()` could map a false argument to true, so an empty range in its
+  // argument says nothing about the enclosing chain.
+  auto path{
+      libjsonpath::parse("$[?@.x && none(@.a > 5 && @.a < 3)]", functions)};
+  EXPECT_EQ(libjsonpath::simplify(path), 0);
+  EXPECT_EQ(libjsonpath::to_string(path),
+      "$[?(@['x'] && none((@['a'] > 5 && @['a'] < 3)))]");
+}
+
+TEST_F(SimplifyTest, Negation) {
+  expect_simplified("$[?!true]", "$[?false]", 1);
+  expect_simplified("$[?!(1 == 2)]", "$[?true]", 3);
+  expect_simplified("$[?!(!@.b)]", "$[?@['b']]", 2);
+  expect_simplified("$[?!!!@.b]", "$[?!@['b']]", 2);
+  expect_simplified("$[?!@.b]", "$[?!@['b']]", 0);
+}
+
+TEST_F(SimplifyTest, NestedFilters) {
+  expect_simplified("$[?@.a[?true && @.b]]", "$[?@['a'][?@['b']]]", 2);
+  expect_simplified("$[?@.a[?!(!@.b)] || @.c[?false]]",
+      "$[?(@['a'][?@['b']] || @['c'][?false])]", 2);
+  expect_simplified("$[?$.a[?1 == 1]]", "$[?$['a'][?true]]", 2);
+}
+
+TEST_F(SimplifyTest, SimplifyExpression) {
+  auto path{libjsonpath::parse("$[?!(!@.b) && true]")};
+  const auto& segment{std::get<libjsonpath::Segment>(path.front())};
+  const auto& filter{std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+      segment.selectors.front())};
+
+  EXPECT_EQ(libjsonpath::count_nodes(filter->expression), 5);
+  auto result{libjsonpath::simplify(filter->expression)};
+  EXPECT_EQ(result.nodes_removed, 4);
+  EXPECT_EQ(libjsonpath::count_nodes(result.expression), 1);
+  EXPECT_TRUE(
+      std::holds_alternative<libjsonpath::Box<libjsonpath::RelativeQuery>>(
+          result.expression));
+
+  // The original expression is unchanged.
+  EXPECT_EQ(libjsonpath::count_nodes(filter->expression), 5);
+}
+
+class ReorderTest : public testing::Test {
+protected:
+  void expect_reordered(std::string_view query, std::string_view want,
+      std::size_t reordered) {
+    auto path{libjsonpath::parse(query)};
+    EXPECT_EQ(libjsonpath::reorder(path), reordered) << query;
+    EXPECT_EQ(libjsonpath::to_string(path), want) << query;
+  }
+
+  std::uint64_t cost(std::string_view expression) {
+    // Function names are views into the query, so it must outlive the path.
+    const std::string query{"$[?" + std::string{expression} + "]"};
+    auto path{libjsonpath::parse(query)};
+    const auto& segment{std::get<libjsonpath::Segment>(path.front())};
+    return libjsonpath::evaluation_cost(
+        std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+            segment.selectors.front())
+            ->expression);
+  }
+};
+
+TEST_F(ReorderTest, RelativeCosts) {
+  EXPECT_LT(cost("1 == 1"), cost("@.a == 1"));
+  EXPECT_LT(cost("@.a == 1"), cost("@.a.b == 1"));
+  EXPECT_LT(cost("@.a.b"), cost("@.*"));
+  EXPECT_LT(cost("@.*"), cost("@..a"));
+  EXPECT_LT(cost("@..a"), cost("@..a[?@.b]"));
+  EXPECT_LT(cost("length(@.a) == 1"), cost("match(@.a, 'a')"));
+  EXPECT_LT(cost("@.*.a"), cost("@.*.*"));
+}
+
+TEST_F(ReorderTest, CheapOperandFirst) {
+  expect_reordered("$[?search(@.text, 'err') && @.level == 3]",
+      "$[?(@['level'] == 3 && search(@['text'], \"err\"))]", 1);
+  expect_reordered("$[?@..a || @.b]", "$[?(@['b'] || @..['a'])]", 1);
+}
+
+TEST_F(ReorderTest, AlreadyOrdered) {
+  expect_reordered("$[?@.level == 3 && search(@.text, 'err')]",
+      "$[?(@['level'] == 3 && search(@['text'], \"err\"))]", 0);
+}
+
+TEST_F(ReorderTest, EqualCostsKeepSourceOrder) {
+  expect_reordered("$[?@.b && @.a]", "$[?(@['b'] && @['a'])]", 0);
+  expect_reordered("$[?@..x && @.b && @.a]",
+      "$[?(@['b'] && (@['a'] && @..['x']))]", 1);
+}
+
+TEST_F(ReorderTest, Chains) {
+  expect_reordered("$[?@..a && @.*.b && @.c]",
+      "$[?(@['c'] && (@[*]['b'] && @..['a']))]", 1);
+  expect_reordered("$[?(@..a || @.b) && @.c]",
+      "$[?(@['c'] && (@['b'] || @..['a']))]", 2);
+}
+
+TEST_F(ReorderTest, MixedOperatorsAreNotInterchanged) {
+  expect_reordered("$[?@..a && @.b || @.c]",
+      "$[?(@['c'] || (@['b'] && @..['a']))]", 2);
+}
+
+TEST_F(ReorderTest, NestedFilters) {
+  expect_reordered("$[?@.a[?@..b && @.c]]",
+      "$[?@['a'][?(@['c'] && @..['b'])]]", 1);
+}
+
+TEST_F(ReorderTest, Optimize) {
+  auto path{libjsonpath::parse("$[?search(@.a, 'b') && true && @.c == 1]")};
+  auto stats{libjsonpath::optimize(path)};
+  EXPECT_EQ(stats.nodes_removed, 2);
+  EXPECT_EQ(stats.chains_reordered, 1);
+  EXPECT_EQ(libjsonpath::to_string(path),
+      "$[?(@['c'] == 1 && search(@['a'], \"b\"))]");
+}
+
+TEST_F(ReorderTest, ReorderingDisabled) {
+  auto path{libjsonpath::parse("$[?search(@.a, 'b') && true && @.c == 1]")};
+  libjsonpath::OptimizeOptions options{};
+  options.reorder = false;
+  auto stats{libjsonpath::optimize(path, options)};
+  EXPECT_EQ(stats.nodes_removed, 2);
+  EXPECT_EQ(stats.chains_reordered, 0);
+  EXPECT_EQ(libjsonpath::to_string(path),
+      "$[?(search(@['a'], \"b\") && @['c'] == 1)]");
+}
+
+class InvariantTest : public testing::Test {
+protected:
+  void expect_invariants(
+      std::string_view query, const std::vector<std::string>& want) {
+    auto path{libjsonpath::parse(query)};
+    std::vector<std::string> got{};
+    for (auto expression : libjsonpath::find_invariants(path)) {
+      got.push_back(
+          std::visit(libjsonpath::ExpressionToStringVisitor{}, *expression));
+    }
+    EXPECT_EQ(got, want) << query;
+  }
+};
+
+TEST_F(InvariantTest, NoFilters) { expect_invariants("$.a[0]", {}); }
+
+TEST_F(InvariantTest, RelativeQueriesAreNotInvariant) {
+  expect_invariants("$[?@.a == 1 && @.b]", {});
+}
+
+TEST_F(InvariantTest, RootQueryOperand) {
+  expect_invariants("$.items[?@.price > $.config.threshold]",
+      {"$['config']['threshold']"});
+}
+
+TEST_F(InvariantTest, RootQueryWithNestedFilter) {
+  expect_invariants(
+      "$[?@.a && $.b[?@.c == @.d]]", {"$['b'][?@['c'] == @['d']]"});
+}
+
+TEST_F(InvariantTest, FunctionCalls) {
+  expect_invariants("$[?length(@.a) == length($.b)]", {"length($['b'])"});
+  expect_invariants(
+      "$[?match(@.a, value($.pattern))]", {"value($['pattern'])"});
+  expect_invariants("$[?match(@.a, 'a.*')]", {});
+}
+
+TEST_F(InvariantTest, OutermostOnly) {
+  expect_invariants("$[?$.a > 1 && @.b]", {"$['a'] > 1"});
+  expect_invariants("$[?$.flag]", {"$['flag']"});
+  expect_invariants("$[?!($.a || $.b) || @.c == $.d]",
+      {"!($['a'] || $['b'])", "$['d']"});
+}
+
+TEST_F(InvariantTest, NestedRelativeQueries) {
+  expect_invariants("$[?@.a[?@.b == $.c]]", {"$['c']"});
+}
+
+TEST_F(InvariantTest, IsInvariant) {
+  auto path{libjsonpath::parse("$[?@.a == 1]")};
+  const auto& segment{std::get<libjsonpath::Segment>(path.front())};
+  const auto& filter{std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+      segment.selectors.front())};
+  EXPECT_FALSE(libjsonpath::is_invariant(filter->expression));
+  EXPECT_TRUE(libjsonpath::is_invariant(libjsonpath::IntegerLiteral{{}, 1}));
+}
+
+class CommonSubexpressionTest : public testing::Test {
+protected:
+  // Return a string representation of each merged subexpression in _query_'s
+  // first filter, along with its number of occurrences.
+  std::vector<std::pair<std::string, std::size_t>> merged(
+      std::string_view query) {
+    auto path{libjsonpath::parse(query)};
+    const auto& segment{std::get<libjsonpath::Segment>(path.front())};
+    const auto& filter{
+        std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+            segment.selectors.front())};
+
+    auto cse{libjsonpath::find_common_subexpressions(filter->expression)};
+    std::vector<std::pair<std::string, std::size_t>> got{};
+    for (std::size_t i = 0; i < cse.merged.size(); i++) {
+      const auto& occurrences{cse.merged[i].occurrences};
+      for (auto occurrence : occurrences) {
+        EXPECT_EQ(cse.slot(*occurrence), i);
+      }
+      got.emplace_back(std::visit(libjsonpath::ExpressionToStringVisitor{},
+                           *occurrences.front()),
+          occurrences.size());
+    }
+    return got;
+  }
+
+  using want_t = std::vector<std::pair<std::string, std::size_t>>;
+};
+
+TEST_F(CommonSubexpressionTest, NothingRepeated) {
+  EXPECT_EQ(merged("$[?@.a > 1 && @.b < 2]"), want_t{});
+}
+
+TEST_F(CommonSubexpressionTest, RepeatedRelativeQuery) {
+  EXPECT_EQ(merged("$[?@.stats.p99 > 100 && @.stats.p99 < 500 && "
+                   "length(@.stats.p99) == 3]"),
+      (want_t{{"@['stats']['p99']", 3}}));
+}
+
+TEST_F(CommonSubexpressionTest, ShorthandAndBracketedFormsMerge) {
+  EXPECT_EQ(merged("$[?@.a == 1 || @['a'] == 2]"), (want_t{{"@['a']", 2}}));
+}
+
+TEST_F(CommonSubexpressionTest, RootQueriesAndFunctionCalls) {
+  EXPECT_EQ(merged("$[?length(@.a) > $.min && length(@.a) < $.max && "
+                   "$.min > 0]"),
+      (want_t{{"length(@['a'])", 2}, {"@['a']", 2}, {"$['min']", 2}}));
+}
+
+TEST_F(CommonSubexpressionTest, NestedFiltersAreNotSearched) {
+  EXPECT_EQ(merged("$[?@.a[?@.b] && @.b]"), want_t{});
+  EXPECT_EQ(merged("$[?@.a[?@.b] || @.a[?@.b]]"),
+      (want_t{{"@['a'][?@['b']]", 2}}));
+}
+
+TEST_F(CommonSubexpressionTest, UnmergedSubexpressionsHaveNoSlot) {
+  auto path{libjsonpath::parse("$[?@.a]")};
+  const auto& segment{std::get<libjsonpath::Segment>(path.front())};
+  const auto& filter{std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+      segment.selectors.front())};
+  auto cse{libjsonpath::find_common_subexpressions(filter->expression)};
+  EXPECT_TRUE(cse.merged.empty());
+  EXPECT_FALSE(cse.slot(filter->expression).has_value());
+}
+
+class RequiredNamesTest : public testing::Test {
+protected:
+  // Check the names required by _query_'s first filter.
+  void expect_required(
+      std::string_view query, const std::vector<std::string_view>& want) {
+    auto path{libjsonpath::parse(query)};
+    const auto& selectors{std::visit(
+        [](const auto& s) -> const std::vector<libjsonpath::selector_t>& {
+          return s.selectors;
+        },
+        path.front())};
+    const auto& filter{
+        std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+            selectors.front())};
+    EXPECT_EQ(libjsonpath::required_names(filter->expression), want) << query;
+  }
+};
+
+TEST_F(RequiredNamesTest, ExistenceTests) {
+  expect_required("$..[?@.error_code]", {"error_code"});
+  expect_required("$[?@.a.b[0]]", {"a"});
+  expect_required("$[?@['a']]", {"a"});
+  expect_required("$[?@]", {});
+  expect_required("$[?@..a]", {});
+  expect_required("$[?@['a', 'b']]", {});
+  expect_required("$[?$.a]", {});
+}
+
+TEST_F(RequiredNamesTest, Comparisons) {
+  expect_required("$[?@.a == 1]", {"a"});
+  expect_required("$[?'x' < @.a]", {"a"});
+  expect_required("$[?@.a == null]", {"a"});
+  expect_required("$[?@.a != 1]", {});
+  expect_required("$[?@.a == $.b]", {});
+  expect_required("$[?@.a == @.b]", {});
+  expect_required("$[?length(@.a) == 1]", {});
+}
+
+TEST_F(RequiredNamesTest, LogicalOperators) {
+  expect_required("$[?@.a && @.b > 2]", {"a", "b"});
+  expect_required("$[?@.a || @.b]", {});
+  expect_required("$[?@.a && (@.b || @.c)]", {"a"});
+  expect_required("$[?!@.a]", {});
+}
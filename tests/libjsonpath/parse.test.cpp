@@ -1,6 +1,7 @@
 #include "libjsonpath/parse.hpp" // libjsonpath::Parser
 #include "libjsonpath/jsonpath.hpp" // libjsonpath::parse libjsonpath::path_to_string
 #include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string>                   // std::string
 #include <string_view>              // string_view
 
 class ParserTest : public testing::Test {
@@ -33,6 +34,12 @@ TEST_F(ParserTest, QuotedPropertyWithNonIdentChars) {
 }
 
 TEST_F(ParserTest, RootIndex) { expect_to_string("$[1]", "$[1]"); }
+TEST_F(ParserTest, LargestIndices) {
+  expect_to_string("$[9007199254740991]", "$[9007199254740991]");
+  expect_to_string("$[-9007199254740991::-9007199254740991]",
+      "$[-9007199254740991::-9007199254740991]");
+}
+
 TEST_F(ParserTest, RootSlice) { expect_to_string("$[1:-1]", "$[1:-1:1]"); }
 
 TEST_F(ParserTest, SliceWithStep) {
@@ -155,7 +162,8 @@ TEST_F(ParserTest, SingleQuotedStringLiteralWithEscape) {
 }
 
 TEST_F(ParserTest, DoubleQuotedStringLiteralWithEscape) {
-  expect_to_string("$[?@.foo == \"ba\\\"r\"]", "$[?@[\'foo\'] == \"ba\"r\"]");
+  expect_to_string(
+      "$[?@.foo == \"ba\\\"r\"]", "$[?@[\'foo\'] == \"ba\\\"r\"]");
 }
 
 TEST_F(ParserTest, NotBindsMoreTightlyThanAnd) {
@@ -203,3 +211,61 @@ TEST_F(ParserTest, IntegerLiteralWithNegativeExponent) {
 TEST_F(ParserTest, NonSingularExistenceAndExistence) {
   expect_to_string("$[?@..* && @.b]", "$[?(@..[*] && @['b'])]");
 }
+
+TEST_F(ParserTest, EscapedQuoteInNameSelector) {
+  expect_to_string("$['a\\'b']", "$['a\\'b']");
+}
+
+TEST_F(ParserTest, DoubleQuoteInNameSelector) {
+  expect_to_string("$[\"a'b\"]", "$['a\\'b']");
+}
+
+TEST_F(ParserTest, BackslashInNameSelector) {
+  expect_to_string("$['a\\\\b']", "$['a\\\\b']");
+}
+
+TEST_F(ParserTest, ControlCharactersInNameSelector) {
+  expect_to_string("$['a\\nb\\u0001']", "$['a\\nb\\u0001']");
+}
+
+TEST_F(ParserTest, FilterFloatLiteralRoundTrip) {
+  expect_to_string("$[?@.a == 0.1234567891]", "$[?@['a'] == 0.1234567891]");
+}
+
+TEST_F(ParserTest, FilterFloatLiteralWithExponent) {
+  expect_to_string("$[?@.a == 1.5e300]", "$[?@['a'] == 1.5e+300]");
+}
+
+TEST_F(ParserTest, FilterFloatLiteralWithNegativeExponent) {
+  expect_to_string("$[?@.a == 1.5e-7]", "$[?@['a'] == 1.5e-07]");
+  expect_to_string("$[?@.a == 1.5e-07]", "$[?@['a'] == 1.5e-07]");
+}
+
+TEST_F(ParserTest, FunctionCallArguments) {
+  expect_to_string("$[?match(@.a, 'b.*')]", "$[?match(@['a'], \"b.*\")]");
+}
+
+TEST_F(ParserTest, ToStringReusesBuffer) {
+  auto segments{libjsonpath::parse("$.foo[?@.bar > 1.5]")};
+  std::string buffer{};
+  libjsonpath::to_string(segments, buffer);
+  EXPECT_EQ(buffer, "$['foo'][?@['bar'] > 1.5]");
+
+  segments = libjsonpath::parse("$.a");
+  libjsonpath::to_string(segments, buffer);
+  EXPECT_EQ(buffer, "$['a']");
+}
+
+TEST_F(ParserTest, ToStringCharBuffer) {
+  auto segments{libjsonpath::parse("$.foo.bar")};
+  const std::string want{"$['foo']['bar']"};
+  EXPECT_EQ(libjsonpath::to_string_length(segments), want.size());
+
+  char buffer[32];
+  auto length{libjsonpath::to_string(segments, buffer, sizeof(buffer))};
+  EXPECT_EQ(std::string_view(buffer, length), want);
+
+  // Truncated output still reports the full length.
+  EXPECT_EQ(libjsonpath::to_string(segments, buffer, 4), want.size());
+  EXPECT_EQ(std::string_view(buffer, 4), "$['f");
+}
@@ -0,0 +1,130 @@
+#include "libjsonpath/pointer.hpp"    // libjsonpath::to_json_pointer
+#include "libjsonpath/exceptions.hpp" // libjsonpath::TypeError
+#include "libjsonpath/jsonpath.hpp"   // libjsonpath::parse
+#include <gtest/gtest.h>              // EXPEXT_* TEST_F testing::Test
+#include <map>                        // std::map
+#include <optional>                   // std::optional
+#include <string>                     // std::string
+#include <string_view>                // std::string_view
+#include <vector>                     // std::vector
+
+// A tiny JSON DOM, just enough to exercise singular path lookups.
+struct TestValue {
+  libjsonpath::ValueKind kind{libjsonpath::ValueKind::null_};
+  std::string string{};
+  std::vector<TestValue> elements{};
+  std::map<std::string, TestValue, std::less<>> members{};
+};
+
+struct TestAdapter {
+  using node_type = const TestValue*;
+
+  static libjsonpath::ValueKind kind(node_type node) { return node->kind; }
+  static std::size_t size(node_type node) { return node->elements.size(); }
+
+  static node_type element(node_type node, std::size_t index) {
+    return &node->elements[index];
+  }
+
+  static std::optional<node_type> member(
+      node_type node, std::string_view name) {
+    auto it{node->members.find(name)};
+    if (it == node->members.end()) {
+      return std::nullopt;
+    }
+    return &it->second;
+  }
+};
+
+static TestValue string_value(std::string s) {
+  return TestValue{libjsonpath::ValueKind::string, std::move(s)};
+}
+
+class PointerTest : public testing::Test {
+protected:
+  // {"a": {"b": ["x", "y", {"c/d": "z"}]}, "~": "t"}
+  TestValue m_document{libjsonpath::ValueKind::object, "", {},
+      {{"a", TestValue{libjsonpath::ValueKind::object, "", {},
+                 {{"b", TestValue{libjsonpath::ValueKind::array, "",
+                            {string_value("x"), string_value("y"),
+                                TestValue{libjsonpath::ValueKind::object, "",
+                                    {}, {{"c/d", string_value("z")}}}}}}}}},
+          {"~", string_value("t")}}};
+
+  void expect_pointer(std::string_view query, std::string_view want) {
+    EXPECT_EQ(libjsonpath::to_json_pointer(libjsonpath::parse(query)), want);
+  }
+
+  void expect_find(std::string_view query, std::optional<std::string> want) {
+    auto path{libjsonpath::compile_singular_query(libjsonpath::parse(query))};
+    ASSERT_TRUE(path.has_value()) << query;
+    auto node{path->find<TestAdapter>(&m_document)};
+    if (want) {
+      ASSERT_TRUE(node.has_value()) << query;
+      EXPECT_EQ((*node)->string, *want) << query;
+    } else {
+      EXPECT_FALSE(node.has_value()) << query;
+    }
+  }
+};
+
+TEST_F(PointerTest, Root) { expect_pointer("$", ""); }
+
+TEST_F(PointerTest, NamesAndIndices) {
+  expect_pointer("$.a.b[2]", "/a/b/2");
+  expect_pointer("$['a']['b'][0]", "/a/b/0");
+}
+
+TEST_F(PointerTest, EscapedNames) {
+  expect_pointer("$['c/d']['~']['~1']", "/c~1d/~0/~01");
+  expect_pointer("$['']", "/");
+}
+
+TEST_F(PointerTest, NonSingularQuery) {
+  EXPECT_THROW(libjsonpath::to_json_pointer(libjsonpath::parse("$.a.*")),
+      libjsonpath::TypeError);
+  EXPECT_THROW(libjsonpath::to_json_pointer(libjsonpath::parse("$..a")),
+      libjsonpath::TypeError);
+  EXPECT_THROW(libjsonpath::to_json_pointer(libjsonpath::parse("$['a','b']")),
+      libjsonpath::TypeError);
+  EXPECT_FALSE(
+      libjsonpath::compile_singular_query(libjsonpath::parse("$[?@.a]")));
+}
+
+TEST_F(PointerTest, NegativeIndex) {
+  EXPECT_THROW(libjsonpath::to_json_pointer(libjsonpath::parse("$.a[-1]")),
+      libjsonpath::IndexError);
+}
+
+TEST_F(PointerTest, CompiledSteps) {
+  auto path{libjsonpath::compile_singular_query(libjsonpath::parse("$.a[1]"))};
+  ASSERT_TRUE(path);
+  ASSERT_EQ(path->steps().size(), 2);
+  EXPECT_EQ(std::get<std::string>(path->steps()[0]), "a");
+  EXPECT_EQ(std::get<std::int64_t>(path->steps()[1]), 1);
+}
+
+TEST_F(PointerTest, FindRoot) {
+  auto path{libjsonpath::compile_singular_query(libjsonpath::parse("$"))};
+  EXPECT_EQ(path->find<TestAdapter>(&m_document), &m_document);
+}
+
+TEST_F(PointerTest, FindMembersAndElements) {
+  expect_find("$['~']", "t");
+  expect_find("$.a.b[0]", "x");
+  expect_find("$.a.b[1]", "y");
+  expect_find("$.a.b[2]['c/d']", "z");
+}
+
+TEST_F(PointerTest, FindNegativeIndex) {
+  expect_find("$.a.b[-3]", "x");
+  expect_find("$.a.b[-4]", std::nullopt);
+}
+
+TEST_F(PointerTest, FindMissing) {
+  expect_find("$.nosuchthing", std::nullopt);
+  expect_find("$.a.b[3]", std::nullopt);
+  expect_find("$.a[0]", std::nullopt);
+  expect_find("$.a.b.c", std::nullopt);
+  expect_find("$['~'].a", std::nullopt);
+}
@@ -0,0 +1,142 @@
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include "libjsonpath/range.hpp"    // libjsonpath::find_ranges
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <variant>                  // std::get std::visit
+#include <vector>                   // std::vector
+
+using libjsonpath::expression_t;
+using libjsonpath::FloatLiteral;
+using libjsonpath::IntegerLiteral;
+using libjsonpath::NullLiteral;
+using libjsonpath::StringLiteral;
+
+class RangeTest : public testing::Test {
+protected:
+  libjsonpath::segments_t m_path{};
+
+  std::vector<libjsonpath::RangePredicate> ranges(std::string_view query) {
+    m_path = libjsonpath::parse(query);
+    const auto& segment{std::get<libjsonpath::Segment>(m_path.front())};
+    const auto& filter{std::get<libjsonpath::Box<libjsonpath::FilterSelector>>(
+        segment.selectors.front())};
+    return libjsonpath::find_ranges(filter->expression);
+  }
+
+  std::string query_string(const libjsonpath::RangePredicate& range) {
+    return std::visit(libjsonpath::ExpressionToStringVisitor{}, *range.query);
+  }
+};
+
+TEST_F(RangeTest, CompareLiterals) {
+  using op = libjsonpath::BinaryOperator;
+  EXPECT_EQ(libjsonpath::compare_literals(
+                IntegerLiteral{{}, 1}, op::eq, FloatLiteral{{}, 1.0}),
+      true);
+  EXPECT_EQ(libjsonpath::compare_literals(
+                StringLiteral{{}, "a"}, op::lt, StringLiteral{{}, "b"}),
+      true);
+  EXPECT_EQ(
+      libjsonpath::compare_literals(NullLiteral{}, op::le, NullLiteral{}),
+      true);
+  EXPECT_EQ(
+      libjsonpath::compare_literals(NullLiteral{}, op::lt, NullLiteral{}),
+      false);
+  EXPECT_EQ(libjsonpath::compare_literals(
+                IntegerLiteral{{}, 1}, op::logical_and, IntegerLiteral{{}, 1}),
+      std::nullopt);
+}
+
+TEST_F(RangeTest, TimeWindow) {
+  auto got{ranges("$[?@.ts >= 1000 && @.ts < 2000 && @.ts != 1500]")};
+  ASSERT_EQ(got.size(), 1);
+  const auto& range{got.front()};
+  EXPECT_EQ(query_string(range), "@['ts']");
+  EXPECT_EQ(range.comparisons.size(), 3);
+  EXPECT_FALSE(range.empty);
+  ASSERT_TRUE(range.lower && range.upper);
+  EXPECT_TRUE(range.lower->inclusive);
+  EXPECT_FALSE(range.upper->inclusive);
+  EXPECT_EQ(range.excluded.size(), 1);
+
+  EXPECT_TRUE(range.contains(IntegerLiteral{{}, 1000}));
+  EXPECT_TRUE(range.contains(FloatLiteral{{}, 1999.5}));
+  EXPECT_FALSE(range.contains(IntegerLiteral{{}, 1500}));
+  EXPECT_FALSE(range.contains(IntegerLiteral{{}, 2000}));
+  EXPECT_FALSE(range.contains(StringLiteral{{}, "1200"}));
+  EXPECT_FALSE(range.contains_nothing());
+}
+
+TEST_F(RangeTest, LiteralOnTheLeft) {
+  auto got{ranges("$[?1 < @.a && 5 >= @.a]")};
+  ASSERT_EQ(got.size(), 1);
+  EXPECT_TRUE(got.front().contains(IntegerLiteral{{}, 5}));
+  EXPECT_FALSE(got.front().contains(IntegerLiteral{{}, 1}));
+}
+
+TEST_F(RangeTest, Contradictions) {
+  EXPECT_TRUE(ranges("$[?@.a > 5 && @.a < 3]").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a == 1 && @.a == 2]").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a == 1 && @.a != 1.0]").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a > 1 && @.a < 'z']").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a >= 1 && @.a < 1]").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a == 'x' && @.a > 1]").front().empty);
+  EXPECT_TRUE(ranges("$[?@.a < true]").front().empty);
+  EXPECT_FALSE(ranges("$[?@.a > 5 && @.a < 6]").front().empty);
+}
+
+TEST_F(RangeTest, EqualityFromBounds) {
+  auto got{ranges("$[?@.a >= 2 && @.a <= 2.0]")};
+  ASSERT_EQ(got.size(), 1);
+  ASSERT_TRUE(got.front().equal);
+  EXPECT_FALSE(got.front().lower || got.front().upper);
+  EXPECT_TRUE(got.front().contains(IntegerLiteral{{}, 2}));
+
+  // `<=` means less than or equal, so for null it means equal.
+  got = ranges("$[?@.a <= null]");
+  ASSERT_TRUE(got.front().equal);
+  EXPECT_TRUE(got.front().contains(NullLiteral{}));
+}
+
+TEST_F(RangeTest, Exclusions) {
+  auto got{ranges("$[?@.a != 1 && @.a != 'x' && @.a != 1.0]")};
+  ASSERT_EQ(got.size(), 1);
+  EXPECT_EQ(got.front().excluded.size(), 2);
+  EXPECT_TRUE(got.front().contains_nothing());
+  EXPECT_TRUE(got.front().contains(NullLiteral{}));
+  EXPECT_FALSE(got.front().contains(StringLiteral{{}, "x"}));
+
+  // Exclusions outside the bounds are redundant.
+  got = ranges("$[?@.a > 1 && @.a != 'x' && @.a != 0]");
+  EXPECT_TRUE(got.front().excluded.empty());
+}
+
+TEST_F(RangeTest, StringRanges) {
+  auto got{ranges("$[?@.name >= 'a' && @.name < 'b']")};
+  ASSERT_EQ(got.size(), 1);
+  EXPECT_TRUE(got.front().contains(StringLiteral{{}, "apple"}));
+  EXPECT_FALSE(got.front().contains(StringLiteral{{}, "banana"}));
+  EXPECT_FALSE(got.front().contains(IntegerLiteral{{}, 1}));
+}
+
+TEST_F(RangeTest, GroupsByQuery) {
+  auto got{ranges(
+      "$[?@.a > 1 && $.b == 2 && @['a'] < 3 && @.c && length(@.d) > 1]")};
+  ASSERT_EQ(got.size(), 2);
+  EXPECT_EQ(query_string(got[0]), "@['a']");
+  EXPECT_EQ(got[0].comparisons.size(), 2);
+  EXPECT_EQ(query_string(got[1]), "$['b']");
+}
+
+TEST_F(RangeTest, SeparateChains) {
+  auto got{ranges("$[?(@.a > 1 && @.a < 3) || (@.a > 5 && @.a < 4)]")};
+  ASSERT_EQ(got.size(), 2);
+  EXPECT_FALSE(got[0].empty);
+  EXPECT_TRUE(got[1].empty);
+}
+
+TEST_F(RangeTest, NonSingularQueriesAndFunctions) {
+  EXPECT_TRUE(ranges("$[?length(@.a) > 1 && length(@.a) < 0]").empty());
+  EXPECT_TRUE(ranges("$[?@.a == @.b]").empty());
+}
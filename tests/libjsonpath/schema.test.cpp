@@ -0,0 +1,191 @@
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include "libjsonpath/schema.hpp"   // libjsonpath::specialize
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <set>                      // std::set
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <utility>                  // std::move
+
+using libjsonpath::Box;
+using libjsonpath::Schema;
+using libjsonpath::ValueKind;
+
+namespace {
+
+Schema of_type(std::set<ValueKind> types) {
+  Schema schema{};
+  schema.types = std::move(types);
+  return schema;
+}
+
+Schema array_of(Schema items) {
+  auto schema{of_type({ValueKind::array})};
+  schema.items = Box<Schema>(std::move(items));
+  return schema;
+}
+
+void add_property(Schema& schema, const std::string& name, Schema property) {
+  schema.properties.emplace(name, Box<Schema>(std::move(property)));
+}
+
+// A closed object schema for orders, like
+// {"id": "x", "items": [{"name": "a", "price": 1, "tags": ["b"]}],
+//  "customer": {"name": "c", "address": {"street": "d"}}}
+Schema order_schema() {
+  const auto string{of_type({ValueKind::string})};
+
+  auto item{of_type({ValueKind::object})};
+  item.additional_properties = false;
+  item.required = {"name"};
+  add_property(item, "name", string);
+  add_property(
+      item, "price", of_type({ValueKind::integer, ValueKind::float_}));
+  add_property(item, "tags", array_of(string));
+
+  auto address{of_type({ValueKind::object})};
+  address.additional_properties = false;
+  add_property(address, "street", string);
+
+  auto customer{of_type({ValueKind::object})};
+  customer.additional_properties = false;
+  add_property(customer, "name", string);
+  add_property(customer, "address", std::move(address));
+
+  auto order{of_type({ValueKind::object})};
+  order.additional_properties = false;
+  order.required = {"id", "items"};
+  add_property(order, "id", string);
+  add_property(order, "items", array_of(std::move(item)));
+  add_property(order, "customer", std::move(customer));
+  return order;
+}
+
+} // namespace
+
+class SchemaTest : public testing::Test {
+protected:
+  void expect_specialized(std::string_view query, std::string_view want,
+      const Schema& schema = order_schema()) {
+    auto path{libjsonpath::specialize(libjsonpath::parse(query), schema)};
+    EXPECT_EQ(libjsonpath::to_string(path), want) << query;
+  }
+};
+
+TEST_F(SchemaTest, DescendantAtOneDepth) {
+  expect_specialized("$..price", "$['items'][*]['price']");
+  expect_specialized("$..tags[0]", "$['items'][*]['tags'][0]");
+  expect_specialized(
+      "$.customer..street", "$['customer']['address']['street']");
+}
+
+TEST_F(SchemaTest, DescendantAtManyDepths) {
+  expect_specialized("$..name", "$..['name']");
+}
+
+TEST_F(SchemaTest, FilterMatchingAtManyDepths) {
+  // {"p": {"k": K}, "q": {"k": Z, "m": {"n": N}}}, where K and N require `v`
+  // and Z can't have it.
+  const auto closed{[]() {
+    auto object{of_type({ValueKind::object})};
+    object.additional_properties = false;
+    return object;
+  }};
+
+  auto with_v{closed()};
+  with_v.required = {"v"};
+  add_property(with_v, "v", of_type({ValueKind::string}));
+
+  auto p{closed()};
+  add_property(p, "k", with_v);
+  auto m{closed()};
+  add_property(m, "n", with_v);
+  auto q{closed()};
+  add_property(q, "k", closed());
+  add_property(q, "m", std::move(m));
+  auto schema{closed()};
+  add_property(schema, "p", std::move(p));
+  add_property(schema, "q", std::move(q));
+
+  // `$['q']['k']` has no `v`, so the filter can't be dropped.
+  expect_specialized("$..[?@.v]", "$..[?@['v']]", schema);
+  expect_specialized("$.*.*[?@.v]", "$['q']['m']['n']", schema);
+}
+
+TEST_F(SchemaTest, DescendantBelowOpenObject) {
+  auto schema{order_schema()};
+  auto& customer{*schema.properties.at("customer")};
+  customer.properties.at("address")->additional_properties = true;
+
+  // `price` could be anywhere below the address.
+  expect_specialized("$..price", "$..['price']", schema);
+  expect_specialized(
+      "$.customer.address..x", "$['customer']['address']..['x']", schema);
+}
+
+TEST_F(SchemaTest, WildcardOnClosedObject) {
+  expect_specialized("$.*.name", "$['customer']['name']");
+  expect_specialized("$.*", "$['customer', 'id', 'items']");
+}
+
+TEST_F(SchemaTest, WildcardOnArray) {
+  expect_specialized("$.items.*.price", "$['items'][*]['price']");
+}
+
+TEST_F(SchemaTest, ImpossibleNames) {
+  expect_specialized("$.nope", "$[?false]");
+  expect_specialized("$.id.x", "$[?false]");
+  expect_specialized("$['id', 'nope']", "$['id']");
+}
+
+TEST_F(SchemaTest, ComparisonsWithImpossibleTypes) {
+  expect_specialized("$.items[?@.price == 'x']", "$[?false]");
+  expect_specialized("$.items[?@.price == 'x' || @.name == 'y']",
+      "$['items'][?@['name'] == \"y\"]");
+  expect_specialized("$.items[?@.name < 1]", "$[?false]");
+  expect_specialized("$.items[?@.name != 1]", "$['items'][*]");
+}
+
+TEST_F(SchemaTest, RequiredMembers) {
+  expect_specialized("$.items[?@.name && @.price > 1]",
+      "$['items'][?@['price'] > 1]");
+  expect_specialized("$.items[?@.price]", "$['items'][?@['price']]");
+  expect_specialized("$[?$.id]", "$['customer', 'id', 'items']");
+}
+
+TEST_F(SchemaTest, NestedFilterQueries) {
+  expect_specialized("$.items[?@.tags[?@ == 1]]", "$[?false]");
+  expect_specialized(
+      "$.items[?@..tags[?@ == 'a']]", "$['items'][?@['tags'][?@ == \"a\"]]");
+}
+
+TEST_F(SchemaTest, FunctionArguments) {
+  expect_specialized("$.items[?count(@..price) > 1]",
+      "$['items'][?count(@['price']) > 1]");
+  expect_specialized("$.items[?length(@.nope) == 1]",
+      "$['items'][?length(@['nope']) == 1]");
+}
+
+TEST_F(SchemaTest, OpenSchema) {
+  expect_specialized(
+      "$..a[*][?@.b == 1]", "$..['a'][*][?@['b'] == 1]", Schema{});
+}
+
+TEST_F(SchemaTest, LongDescendantChains) {
+  // Closed objects nested ten deep, with two members each.
+  Schema schema{of_type({ValueKind::string})};
+  for (int depth = 0; depth < 10; depth++) {
+    auto object{of_type({ValueKind::object})};
+    object.additional_properties = false;
+    add_property(object, "a", schema);
+    add_property(object, "b", std::move(schema));
+    schema = std::move(object);
+  }
+
+  // Each segment is checked against the rest of the chain once per schema
+  // node, rather than once per path through the schema.
+  expect_specialized("$..*..*..*..*..*..*..*..*",
+      "$..['a', 'b']..['a', 'b']..['a', 'b']..['a', 'b']..['a', 'b']..['a', "
+      "'b']..['a', 'b']..['a', 'b']",
+      schema);
+  expect_specialized("$..*..*..*..*..*..*..*..*..*..*..*", "$[?false]", schema);
+}
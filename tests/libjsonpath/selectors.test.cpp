@@ -0,0 +1,99 @@
+#include "libjsonpath/hash.hpp"      // libjsonpath::SegmentsHash
+#include "libjsonpath/jsonpath.hpp"  // libjsonpath::parse
+#include "libjsonpath/selectors.hpp" // libjsonpath::segments_t
+#include <gtest/gtest.h>             // EXPEXT_* TEST_F testing::Test
+#include <string_view>               // std::string_view
+#include <unordered_map>             // std::unordered_map
+#include <unordered_set>             // std::unordered_set
+#include <variant>                   // std::get
+
+class EqualityTest : public testing::Test {
+protected:
+  void expect_equal(std::string_view a, std::string_view b) {
+    auto lhs{libjsonpath::parse(a)};
+    auto rhs{libjsonpath::parse(b)};
+    EXPECT_TRUE(lhs == rhs) << a << " == " << b;
+    EXPECT_FALSE(lhs != rhs) << a << " != " << b;
+    EXPECT_EQ(libjsonpath::hash(lhs), libjsonpath::hash(rhs))
+        << a << " and " << b;
+  }
+
+  void expect_not_equal(std::string_view a, std::string_view b) {
+    auto lhs{libjsonpath::parse(a)};
+    auto rhs{libjsonpath::parse(b)};
+    EXPECT_FALSE(lhs == rhs) << a << " == " << b;
+    EXPECT_TRUE(lhs != rhs) << a << " != " << b;
+  }
+};
+
+TEST_F(EqualityTest, JustRoot) { expect_equal("$", "$"); }
+
+TEST_F(EqualityTest, ShorthandName) { expect_equal("$.a.b", "$['a'][\"b\"]"); }
+
+TEST_F(EqualityTest, ShorthandWild) { expect_equal("$.*", "$[*]"); }
+
+TEST_F(EqualityTest, Descendant) {
+  expect_equal("$..a", "$..['a']");
+  expect_not_equal("$..a", "$.a");
+}
+
+TEST_F(EqualityTest, SelectorLists) {
+  expect_equal("$['a', 1, 2:3]", "$['a',1,2:3]");
+  expect_not_equal("$['a', 'b']", "$['b', 'a']");
+  expect_not_equal("$['a', 'b']", "$['a']");
+}
+
+TEST_F(EqualityTest, Slices) {
+  expect_equal("$[1:2]", "$[1:2:1]");
+  expect_not_equal("$[1:]", "$[1:2]");
+  expect_not_equal("$[::-1]", "$[::1]");
+}
+
+TEST_F(EqualityTest, FilterExpressions) {
+  expect_equal("$[?@.a > 1 && $.b]", "$[?(@['a']>1) && $['b']]");
+  expect_not_equal("$[?@.a > 1]", "$[?@.a >= 1]");
+  expect_not_equal("$[?@.a]", "$[?$.a]");
+  expect_not_equal("$[?@.a && @.b]", "$[?@.b && @.a]");
+}
+
+TEST_F(EqualityTest, Literals) {
+  expect_equal("$[?@.a == 'x']", "$[?@.a == \"x\"]");
+  expect_equal("$[?@.a == 0.0]", "$[?@.a == -0.0]");
+  expect_not_equal("$[?@.a == 1]", "$[?@.a == 1.0]");
+  expect_not_equal("$[?@.a == null]", "$[?@.a == false]");
+}
+
+TEST_F(EqualityTest, FunctionCalls) {
+  expect_equal("$[?length(@.a) > 1]", "$[?length(@['a']) > 1]");
+  expect_not_equal("$[?length(@.a) > 1]", "$[?count(@.a) > 1]");
+  expect_not_equal("$[?match(@.a, 'x')]", "$[?match(@.a, 'y')]");
+}
+
+TEST_F(EqualityTest, Selectors) {
+  auto a{libjsonpath::parse("$.a")};
+  auto b{libjsonpath::parse("$['a']")};
+  const auto& sa{std::get<libjsonpath::Segment>(a.front())};
+  const auto& sb{std::get<libjsonpath::Segment>(b.front())};
+  EXPECT_EQ(sa, sb);
+  EXPECT_EQ(sa.selectors.front(), sb.selectors.front());
+  EXPECT_EQ(std::get<libjsonpath::NameSelector>(sa.selectors.front()),
+      std::get<libjsonpath::NameSelector>(sb.selectors.front()));
+}
+
+TEST_F(EqualityTest, HashedContainers) {
+  std::unordered_set<libjsonpath::segments_t, libjsonpath::SegmentsHash>
+      queries{};
+  queries.insert(libjsonpath::parse("$.a"));
+  queries.insert(libjsonpath::parse("$['a']"));
+  queries.insert(libjsonpath::parse("$[?@.b > 1]"));
+  queries.insert(libjsonpath::parse("$[?(@['b'] > 1)]"));
+  EXPECT_EQ(queries.size(), 2);
+  EXPECT_EQ(queries.count(libjsonpath::parse("$[\"a\"]")), 1);
+
+  std::unordered_map<libjsonpath::segments_t, int, libjsonpath::SegmentsHash>
+      counts{};
+  counts[libjsonpath::parse("$.x.*")]++;
+  counts[libjsonpath::parse("$['x'][*]")]++;
+  EXPECT_EQ(counts.size(), 1);
+  EXPECT_EQ(counts.begin()->second, 2);
+}
@@ -0,0 +1,102 @@
+#include "libjsonpath/summary.hpp"  // libjsonpath::SubtreeSummary
+#include "libjsonpath/find.hpp"     // libjsonpath::Evaluator
+#include "libjsonpath/jsonpath.hpp" // libjsonpath::parse
+#include "libjsonpath/value.hpp"    // libjsonpath::ValueAdapter
+#include "helpers.hpp"              // CountingAdapter node_paths
+#include <gtest/gtest.h>            // EXPEXT_* TEST_F testing::Test
+#include <cstddef>                  // std::size_t
+#include <string>                   // std::string
+#include <string_view>              // std::string_view
+#include <vector>                   // std::vector
+
+using libjsonpath::Value;
+using libjsonpath::ValueAdapter;
+
+using Summary = libjsonpath::SubtreeSummary<CountingAdapter>;
+
+// {"sections": [{"items": [{"id": 0, "tags": ["a"]}, ...]}, ...]}, where
+// item 7 of section 3 has an error code.
+static Value make_document() {
+  Value::array_t sections{};
+  for (int i = 0; i < 10; i++) {
+    Value::array_t items{};
+    for (int j = 0; j < 50; j++) {
+      Value::object_t item{{"id", j}, {"tags", Value::array_t{"a"}}};
+      if (i == 3 && j == 7) {
+        item.emplace_back("error_code", 42);
+      }
+      items.push_back(item);
+    }
+    sections.push_back(Value::object_t{{"items", items}});
+  }
+  return Value::object_t{{"sections", sections}};
+}
+
+class SubtreeSummaryTest : public testing::Test {
+protected:
+  // Check that _query_ selects the same nodes, with the same locations,
+  // with a summary of _root_ as it does without, eagerly and lazily.
+  void expect_same(std::string_view query, const Value& root,
+      std::size_t threshold = 16) {
+    const auto path{libjsonpath::parse(query)};
+    libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+    const auto want{node_paths(evaluator.find(&root))};
+
+    Summary summary{&root, threshold};
+    EXPECT_EQ(node_paths(evaluator.find(summary)), want) << query;
+    EXPECT_EQ(node_paths(evaluator.lazy_find(summary)), want)
+        << query << " lazily";
+  }
+};
+
+TEST_F(SubtreeSummaryTest, SameResults) {
+  const auto root{make_document()};
+  expect_same("$..error_code", root);
+  expect_same("$..[?@.error_code]", root);
+  expect_same("$..[?@.error_code == 42].id", root);
+  expect_same("$..[?@.error_code && @.id > 1]", root);
+  expect_same("$..['error_code', 'nope']", root);
+  expect_same("$..[?@.nope]", root);
+  expect_same("$..id", root);
+  expect_same("$..[?@.id == 49]", root);
+  expect_same("$.sections..[?@.error_code]", root);
+
+  // Queries that can't use the summary.
+  expect_same("$..[?@.error_code || @.nope]", root);
+  expect_same("$..[?@.id != 3].error_code", root);
+  expect_same("$..*", root, 1);
+}
+
+TEST_F(SubtreeSummaryTest, SkipSubtrees) {
+  const auto root{make_document()};
+  const auto path{libjsonpath::parse("$..[?@.error_code]")};
+  libjsonpath::Evaluator<CountingAdapter> evaluator{path};
+
+  CountingAdapter::visits = 0;
+  const auto walked{evaluator.find(&root)};
+  const auto walk_visits{CountingAdapter::visits};
+
+  // The first query builds summaries, with a walk of the document.
+  Summary summary{&root, 16};
+  evaluator.find(summary);
+  EXPECT_GT(summary.size(), 0);
+
+  CountingAdapter::visits = 0;
+  const auto nodes{evaluator.find(summary)};
+  ASSERT_EQ(nodes.size(), 1);
+  EXPECT_EQ(nodes[0].path(), "$['sections'][3]['items'][7]");
+  EXPECT_EQ(nodes[0].path(), walked[0].path());
+  EXPECT_LT(CountingAdapter::visits * 5, walk_visits);
+}
+
+TEST_F(SubtreeSummaryTest, Threshold) {
+  const auto root{make_document()};
+  Summary everything{&root, 1};
+  Summary nothing{&root, 1000000};
+  EXPECT_TRUE(everything.may_contain(&root, {"error_code"}));
+  EXPECT_FALSE(everything.may_contain(&root, {"nope"}));
+  EXPECT_TRUE(nothing.may_contain(&root, {"nope"}));
+  EXPECT_GT(everything.size(), 0);
+  EXPECT_EQ(nothing.size(), 0);
+}
@@ -0,0 +1,71 @@
+#include "libjsonpath/value.hpp"      // libjsonpath::parse_json
+#include "libjsonpath/exceptions.hpp" // libjsonpath::JSONError
+#include <gtest/gtest.h>              // EXPEXT_* TEST_F testing::Test
+#include <string>                     // std::string
+
+using libjsonpath::parse_json;
+using libjsonpath::Value;
+using libjsonpath::ValueKind;
+
+class ValueTest : public testing::Test {};
+
+TEST_F(ValueTest, Scalars) {
+  EXPECT_EQ(parse_json("null").kind(), ValueKind::null_);
+  EXPECT_EQ(parse_json("true"), Value{true});
+  EXPECT_EQ(parse_json(" false "), Value{false});
+  EXPECT_EQ(parse_json("-42").as_integer(), -42);
+  EXPECT_EQ(parse_json("1.5e2").as_float(), 150.0);
+  EXPECT_EQ(parse_json("\"abc\"").as_string(), "abc");
+}
+
+TEST_F(ValueTest, LargeIntegersBecomeFloats) {
+  auto value{parse_json("18446744073709551616")};
+  EXPECT_EQ(value.kind(), ValueKind::float_);
+  EXPECT_EQ(value.as_float(), 18446744073709551616.0);
+}
+
+TEST_F(ValueTest, Escapes) {
+  EXPECT_EQ(parse_json(R"("a\"b\\c\/d\n")").as_string(), "a\"b\\c/d\n");
+  EXPECT_EQ(parse_json(R"("\u00e9")").as_string(), "\xC3\xA9");
+  EXPECT_EQ(parse_json(R"("\ud83d\ude00")").as_string(), "\xF0\x9F\x98\x80");
+}
+
+TEST_F(ValueTest, Containers) {
+  auto value{parse_json(R"({"a": [1, {"b": null}], "c": {}})")};
+  ASSERT_EQ(value.kind(), ValueKind::object);
+  ASSERT_NE(value.find("a"), nullptr);
+  EXPECT_EQ(value.find("a")->as_array().size(), 2);
+  EXPECT_EQ(value.find("c")->as_object().size(), 0);
+  EXPECT_EQ(value.find("x"), nullptr);
+}
+
+TEST_F(ValueTest, MemberOrder) {
+  auto value{parse_json(R"({"z": 1, "a": 2})")};
+  EXPECT_EQ(value.as_object().front().first, "z");
+  EXPECT_EQ(libjsonpath::to_json(value), R"({"z":1,"a":2})");
+}
+
+TEST_F(ValueTest, Equality) {
+  EXPECT_EQ(parse_json("1"), parse_json("1.0"));
+  EXPECT_EQ(
+      parse_json(R"({"a": 1, "b": 2})"), parse_json(R"({"b": 2, "a": 1})"));
+  EXPECT_NE(parse_json("[1, 2]"), parse_json("[2, 1]"));
+  EXPECT_NE(parse_json("1"), parse_json("\"1\""));
+}
+
+TEST_F(ValueTest, ToJSON) {
+  const std::string text{R"([null,true,-1,1.5,"a\"b",{"k":[]}])"};
+  EXPECT_EQ(libjsonpath::to_json(parse_json(text)), text);
+}
+
+TEST_F(ValueTest, MalformedJSON) {
+  EXPECT_THROW(parse_json(""), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("[1, 2"), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("[1, ]"), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("{'a': 1}"), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("01"), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("\"a\nb\""), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("\"\\x\""), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("tru"), libjsonpath::JSONError);
+  EXPECT_THROW(parse_json("1 2"), libjsonpath::JSONError);
+}